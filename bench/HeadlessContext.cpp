@@ -0,0 +1,88 @@
+#include "HeadlessContext.h"
+#include <glad/glad.h>
+#include <iostream>
+
+HeadlessContext::HeadlessContext()
+    : display(EGL_NO_DISPLAY), surface(EGL_NO_SURFACE), context(EGL_NO_CONTEXT) {
+}
+
+HeadlessContext::~HeadlessContext() {
+    Destroy();
+}
+
+bool HeadlessContext::Create(int width, int height) {
+    display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    EGLint major = 0, minor = 0;
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor)) {
+        std::cerr << "Failed to initialize EGL display (error 0x" << std::hex << eglGetError() << std::dec << ")" << std::endl;
+        return false;
+    }
+    std::cout << "EGL " << major << "." << minor << " (" << eglQueryString(display, EGL_VENDOR) << ")" << std::endl;
+    
+    const EGLint configAttribs[] = {
+        EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8,
+        EGL_GREEN_SIZE, 8,
+        EGL_BLUE_SIZE, 8,
+        EGL_ALPHA_SIZE, 8,
+        EGL_DEPTH_SIZE, 24,
+        EGL_NONE
+    };
+    EGLConfig config;
+    EGLint configCount = 0;
+    if (!eglChooseConfig(display, configAttribs, &config, 1, &configCount) || configCount == 0) {
+        std::cerr << "No EGL config supports OpenGL pbuffers" << std::endl;
+        return false;
+    }
+    
+    const EGLint surfaceAttribs[] = { EGL_WIDTH, width, EGL_HEIGHT, height, EGL_NONE };
+    surface = eglCreatePbufferSurface(display, config, surfaceAttribs);
+    if (surface == EGL_NO_SURFACE) {
+        std::cerr << "Failed to create EGL pbuffer surface" << std::endl;
+        return false;
+    }
+    
+    if (!eglBindAPI(EGL_OPENGL_API)) {
+        std::cerr << "EGL does not support the desktop OpenGL API" << std::endl;
+        return false;
+    }
+    // 优先创建4.3核心上下文（计算shader光线步进路径），不支持时退回3.3
+    const EGLint versions[][2] = { { 4, 3 }, { 3, 3 } };
+    for (const auto& version : versions) {
+        const EGLint contextAttribs[] = {
+            EGL_CONTEXT_MAJOR_VERSION, version[0],
+            EGL_CONTEXT_MINOR_VERSION, version[1],
+            EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+            EGL_NONE
+        };
+        context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttribs);
+        if (context != EGL_NO_CONTEXT) break;
+    }
+    if (context == EGL_NO_CONTEXT || !eglMakeCurrent(display, surface, surface, context)) {
+        std::cerr << "Failed to create OpenGL 3.3 core context" << std::endl;
+        return false;
+    }
+    
+    if (!gladLoadGLLoader((GLADloadproc)eglGetProcAddress)) {
+        std::cerr << "Failed to initialize GLAD" << std::endl;
+        return false;
+    }
+    std::cout << "OpenGL " << glGetString(GL_VERSION) << " (" << glGetString(GL_RENDERER) << ")" << std::endl;
+    return true;
+}
+
+void HeadlessContext::Destroy() {
+    if (display == EGL_NO_DISPLAY) return;
+    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (context != EGL_NO_CONTEXT) {
+        eglDestroyContext(display, context);
+        context = EGL_NO_CONTEXT;
+    }
+    if (surface != EGL_NO_SURFACE) {
+        eglDestroySurface(display, surface);
+        surface = EGL_NO_SURFACE;
+    }
+    eglTerminate(display);
+    display = EGL_NO_DISPLAY;
+}
@@ -0,0 +1,27 @@
+#ifndef HEADLESSCONTEXT_H
+#define HEADLESSCONTEXT_H
+
+#include <EGL/egl.h>
+
+// 无窗口的OpenGL上下文：EGL pbuffer表面 + OpenGL 4.3/3.3 Core上下文（与交互程序一致）
+// 默认帧缓冲即pbuffer，渲染器无需修改；在没有显示服务器的CI节点上可配合Mesa的surfaceless平台
+// （EGL_PLATFORM=surfaceless）和llvmpipe（LIBGL_ALWAYS_SOFTWARE=1）使用
+class HeadlessContext {
+public:
+    HeadlessContext();
+    ~HeadlessContext();
+    
+    HeadlessContext(const HeadlessContext&) = delete;
+    HeadlessContext& operator=(const HeadlessContext&) = delete;
+    
+    // 创建上下文、设为当前并加载GL函数
+    bool Create(int width, int height);
+    void Destroy();
+    
+private:
+    EGLDisplay display;
+    EGLSurface surface;
+    EGLContext context;
+};
+
+#endif // HEADLESSCONTEXT_H
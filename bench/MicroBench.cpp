@@ -0,0 +1,332 @@
+// CPU端微基准：体数据读取、程序化生成、梯度打包、shader文件读取，以及（构建时找到EGL时）纹理上传和shader编译
+// 每个用例在若干体积尺寸下重复多次取中位数，报告MB/s和体素/s；可保存为基线并与基线比较
+// 读取用例测量的是页缓存中的文件（刚写出的临时文件），反映的是拷贝/映射开销而非磁盘速度
+//
+// 用法:
+//   VolumeMicroBench [选项]
+// 选项:
+//   --sizes A,B,...        体积边长（默认64,128,256）
+//   --repeat N             每个用例的重复次数（默认5，取中位数）
+//   --filter TEXT          只运行名称包含TEXT的用例
+//   --output FILE          把结果写为CSV（可作为之后的基线）
+//   --baseline FILE        与基线CSV比较，任一用例变慢超过阈值时返回2
+//   --threshold F          回归阈值（默认0.10，即慢10%）
+//   --shaders DIR          shader目录（默认shaders）
+
+#include "ProceduralVolume.h"
+#include "VolumeGradient.h"
+#include "MappedFile.h"
+#ifdef MICROBENCH_WITH_GL
+#include "HeadlessContext.h"
+#include "VolumeData.h"
+#include "Shader.h"
+#endif
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+static void PrintUsage() {
+    std::cout << "Usage:\n"
+              << "  VolumeMicroBench [options]\n"
+              << "Options:\n"
+              << "  --sizes A,B,...        volume edge lengths (default 64,128,256)\n"
+              << "  --repeat N             repetitions per case, median is reported (default 5)\n"
+              << "  --filter TEXT          only run cases whose name contains TEXT\n"
+              << "  --output FILE          write results as CSV (usable as a baseline)\n"
+              << "  --baseline FILE        compare with a baseline CSV, exit 2 on regression\n"
+              << "  --threshold F          regression threshold (default 0.10)\n"
+              << "  --shaders DIR          shader directory (default shaders)" << std::endl;
+}
+
+static double ElapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// 一个用例在一个尺寸下的结果（中位数）
+struct BenchResult {
+    std::string name;
+    int size;
+    double ms;
+    double mbPerSec;
+    double voxelsPerSec;
+};
+
+// 重复运行body取中位数；bytes/voxels为一次运行处理的数据量
+static BenchResult Measure(const std::string& name, int size, int repeat, uint64_t bytes, uint64_t voxels,
+                           const std::function<void()>& body) {
+    std::vector<double> times;
+    for (int i = 0; i < repeat; i++) {
+        auto start = std::chrono::steady_clock::now();
+        body();
+        times.push_back(ElapsedMs(start));
+    }
+    std::sort(times.begin(), times.end());
+    double ms = times[times.size() / 2];
+    
+    BenchResult result;
+    result.name = name;
+    result.size = size;
+    result.ms = ms;
+    result.mbPerSec = ms > 0.0 ? bytes / (1024.0 * 1024.0) / (ms / 1000.0) : 0.0;
+    result.voxelsPerSec = ms > 0.0 ? voxels / (ms / 1000.0) : 0.0;
+    return result;
+}
+
+// 耗时低于此值的用例计时噪声较大，与基线比较时只报告不判定回归
+static const double MIN_COMPARABLE_MS = 1.0;
+
+// 防止编译器删除只读不用的循环
+static volatile uint64_t g_sink = 0;
+
+static uint64_t TouchPages(const unsigned char* data, uint64_t size) {
+    uint64_t sum = 0;
+    for (uint64_t i = 0; i < size; i += 4096) {
+        sum += data[i];
+    }
+    return sum;
+}
+
+static bool ReadWholeFile(const std::string& path, std::string& content) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return false;
+    std::stringstream stream;
+    stream << file.rdbuf();
+    content = stream.str();
+    return true;
+}
+
+static bool WriteRawFile(const std::string& path, const std::vector<unsigned char>& data) {
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) return false;
+    file.write(reinterpret_cast<const char*>(data.data()), (std::streamsize)data.size());
+    return (bool)file;
+}
+
+static bool ParseIntList(const std::string& text, std::vector<int>& values) {
+    values.clear();
+    std::istringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        int value = std::atoi(item.c_str());
+        if (value <= 0) return false;
+        values.push_back(value);
+    }
+    return !values.empty();
+}
+
+static bool WriteCsv(const std::string& filename, const std::vector<BenchResult>& results) {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open file: " << filename << std::endl;
+        return false;
+    }
+    file << "name,size,ms,mb_per_s,voxels_per_s\n";
+    for (const BenchResult& result : results) {
+        file << result.name << "," << result.size << "," << result.ms << ","
+             << result.mbPerSec << "," << result.voxelsPerSec << "\n";
+    }
+    return true;
+}
+
+// 读取基线CSV：(名称, 尺寸) -> 耗时(ms)
+static bool ReadBaseline(const std::string& filename, std::map<std::pair<std::string, int>, double>& baseline) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open baseline: " << filename << std::endl;
+        return false;
+    }
+    std::string line;
+    std::getline(file, line);
+    while (std::getline(file, line)) {
+        std::istringstream stream(line);
+        std::string name, size, ms;
+        if (!std::getline(stream, name, ',') || !std::getline(stream, size, ',') || !std::getline(stream, ms, ',')) {
+            continue;
+        }
+        baseline[{ name, std::atoi(size.c_str()) }] = std::atof(ms.c_str());
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    std::vector<int> sizes = { 64, 128, 256 };
+    int repeat = 5;
+    std::string filter;
+    std::string outputFile;
+    std::string baselineFile;
+    double threshold = 0.10;
+    std::string shaderDir = "shaders";
+    
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--sizes" && i + 1 < argc) {
+            if (!ParseIntList(argv[++i], sizes)) {
+                std::cerr << "Invalid size list: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (arg == "--repeat" && i + 1 < argc) {
+            repeat = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--filter" && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (arg == "--output" && i + 1 < argc) {
+            outputFile = argv[++i];
+        } else if (arg == "--baseline" && i + 1 < argc) {
+            baselineFile = argv[++i];
+        } else if (arg == "--threshold" && i + 1 < argc) {
+            threshold = std::atof(argv[++i]);
+        } else if (arg == "--shaders" && i + 1 < argc) {
+            shaderDir = argv[++i];
+        } else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            PrintUsage();
+            return 1;
+        }
+    }
+    
+#ifdef MICROBENCH_WITH_GL
+    // 上传和编译用例需要GL上下文；创建失败时只运行CPU用例
+    HeadlessContext context;
+    bool hasGl = context.Create(64, 64);
+    if (!hasGl) {
+        std::cerr << "No OpenGL context, skipping upload and shader cases" << std::endl;
+    }
+#endif
+    
+    std::vector<BenchResult> results;
+    auto run = [&](const std::string& name, int size, uint64_t bytes, uint64_t voxels, const std::function<void()>& body) {
+        if (!filter.empty() && name.find(filter) == std::string::npos) return;
+        results.push_back(Measure(name, size, repeat, bytes, voxels, body));
+        const BenchResult& result = results.back();
+        std::cout << std::left << std::setw(24) << name << std::right << std::setw(6) << size
+                  << std::fixed << std::setprecision(2) << std::setw(12) << result.ms << " ms"
+                  << std::setw(12) << result.mbPerSec << " MB/s"
+                  << std::setprecision(1) << std::setw(10) << result.voxelsPerSec / 1.0e6 << " Mvox/s" << std::endl;
+    };
+    
+    for (int size : sizes) {
+        uint64_t voxels = (uint64_t)size * size * size;
+        ProceduralParams params;
+        
+        // 程序化生成（各形状）
+        for (ProceduralShape shape : { ProceduralShape::Clouds, ProceduralShape::Spheres, ProceduralShape::Turbulence }) {
+            params.shape = shape;
+            std::string name = std::string("generate_") + ProceduralVolume::GetShapeName(shape);
+            std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+            run(name, size, voxels, voxels, [&]() {
+                g_sink += ProceduralVolume::Generate(params, size, size, size)[0];
+            });
+        }
+        params.shape = ProceduralShape::Clouds;
+        std::vector<unsigned char> data = ProceduralVolume::Generate(params, size, size, size);
+        
+        // 文件读取：整体ifstream读入（旧的加载方式）与内存映射后顺序访问
+        std::string rawFile = "microbench_" + std::to_string(size) + ".raw";
+        if (!WriteRawFile(rawFile, data)) {
+            std::cerr << "Failed to write temporary file: " << rawFile << std::endl;
+            return 1;
+        }
+        run("read_ifstream", size, voxels, voxels, [&]() {
+            std::vector<unsigned char> buffer((size_t)voxels);
+            std::ifstream file(rawFile, std::ios::binary);
+            file.read(reinterpret_cast<char*>(buffer.data()), (std::streamsize)voxels);
+            g_sink += buffer[0];
+        });
+        run("read_mmap", size, voxels, voxels, [&]() {
+            MappedFile file;
+            if (file.Open(rawFile)) {
+                file.AdviseSequential();
+                g_sink += TouchPages(file.GetData(), file.GetSize());
+            }
+        });
+        
+        // 梯度计算与打包（CreateTexture3D中上传前的CPU部分）
+        std::vector<unsigned char> packed(data.size() * 4);
+        for (GradientFilter filter : { GradientFilter::CentralDifference, GradientFilter::Sobel }) {
+            std::string name = filter == GradientFilter::Sobel ? "gradient_sobel" : "gradient_central";
+            run(name, size, voxels * 4, voxels, [&]() {
+                VolumeGradient::ComputePacked(data.data(), size, size, size, 0, size, filter, packed.data());
+            });
+        }
+        
+#ifdef MICROBENCH_WITH_GL
+        // 完整加载路径：映射、梯度打包、glTexImage3D分块上传、宏单元与LOD
+        if (hasGl) {
+            run("load_raw_upload", size, voxels, voxels, [&]() {
+                VolumeData volume;
+                volume.LoadFromFile(rawFile, size, size, size);
+                glFinish();
+            });
+        }
+#endif
+        std::remove(rawFile.c_str());
+    }
+    
+    // shader文件读取（与Shader::LoadFromFile读取源码的方式相同）和编译链接，与体积尺寸无关
+    std::string vertexPath = shaderDir + "/raymarching.vert";
+    std::string fragmentPath = shaderDir + "/raymarching.frag";
+    std::string source;
+    if (ReadWholeFile(fragmentPath, source)) {
+        uint64_t bytes = source.size();
+        run("shader_read", 0, bytes, 0, [&]() {
+            std::string vertex, fragment;
+            ReadWholeFile(vertexPath, vertex);
+            ReadWholeFile(fragmentPath, fragment);
+            g_sink += vertex.size() + fragment.size();
+        });
+#ifdef MICROBENCH_WITH_GL
+        if (hasGl) {
+            run("shader_compile", 0, bytes, 0, [&]() {
+                Shader shader;
+                shader.LoadFromFile(vertexPath, fragmentPath);
+            });
+        }
+#endif
+    } else {
+        std::cerr << "Shader sources not found in " << shaderDir << ", skipping shader cases" << std::endl;
+    }
+    
+    if (!outputFile.empty() && WriteCsv(outputFile, results)) {
+        std::cout << "Wrote " << results.size() << " results to " << outputFile << std::endl;
+    }
+    
+    // 与基线比较：按中位耗时计算变化比例
+    if (!baselineFile.empty()) {
+        std::map<std::pair<std::string, int>, double> baseline;
+        if (!ReadBaseline(baselineFile, baseline)) {
+            return 1;
+        }
+        int regressions = 0;
+        std::cout << "\nComparison with " << baselineFile << " (threshold " << threshold * 100.0 << "%):" << std::endl;
+        for (const BenchResult& result : results) {
+            auto it = baseline.find({ result.name, result.size });
+            if (it == baseline.end() || it->second <= 0.0) {
+                std::cout << std::left << std::setw(24) << result.name << std::right << std::setw(6) << result.size
+                          << "  (not in baseline)" << std::endl;
+                continue;
+            }
+            double change = result.ms / it->second - 1.0;
+            bool regressed = change > threshold && it->second >= MIN_COMPARABLE_MS;
+            regressions += regressed ? 1 : 0;
+            std::cout << std::left << std::setw(24) << result.name << std::right << std::setw(6) << result.size
+                      << std::fixed << std::setprecision(2) << std::setw(12) << it->second << " -> " << result.ms << " ms"
+                      << std::showpos << std::setprecision(1) << std::setw(10) << change * 100.0 << "%" << std::noshowpos
+                      << (regressed ? "  REGRESSION" : "") << std::endl;
+        }
+        if (regressions > 0) {
+            std::cout << regressions << " case(s) regressed" << std::endl;
+            return 2;
+        }
+    }
+    return 0;
+}
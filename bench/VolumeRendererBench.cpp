@@ -0,0 +1,355 @@
+// 无窗口渲染基准：在EGL pbuffer上下文中回放摄像机路径，遍历渲染参数组合，输出每组的帧时间分布（JSON）
+//
+// 用法:
+//   VolumeRendererBench [选项]
+// 选项:
+//   --volume FILE          从NRRD/MetaImage文件加载体数据（默认生成程序化体数据）
+//   --procedural N         程序化体数据边长（默认128）
+//   --path FILE            摄像机路径（CameraPath文本格式，默认绕体积一周的环绕路径）
+//   --frames N             每组参数计时的帧数（默认120）
+//   --warmup N             每组参数计时前的预热帧数（默认20，用于特化shader编译、LOD收敛等）
+//   --width W --height H   渲染尺寸（默认1280x720）
+//   --step-sizes A,B,...   遍历的步长（默认0.01,0.005）
+//   --dynres               启用动态分辨率（默认关闭，使各组以相同分辨率比较）
+//   --temporal             启用时间累积（默认关闭）
+//   --compute              每组参数另外用计算shader光线步进路径测一遍（需要OpenGL 4.3，不支持时忽略）
+//   --thumbnails N         另外比较N个缩略图（环绕视角）逐帧渲染与批量多视图渲染的耗时（默认0，不比较）
+//   --thumbnail-size S     缩略图边长（默认128）
+//   --output FILE          JSON输出文件（默认bench_results.json）
+
+#include "HeadlessContext.h"
+#include "Renderer.h"
+#include "CameraPath.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+static void PrintUsage() {
+    std::cout << "Usage:\n"
+              << "  VolumeRendererBench [options]\n"
+              << "Options:\n"
+              << "  --volume FILE          load an NRRD/MetaImage volume (default procedural)\n"
+              << "  --procedural N         procedural volume size (default 128)\n"
+              << "  --path FILE            camera path file (default orbit)\n"
+              << "  --frames N             timed frames per configuration (default 120)\n"
+              << "  --warmup N             warm-up frames per configuration (default 20)\n"
+              << "  --width W --height H   render size (default 1280x720)\n"
+              << "  --step-sizes A,B,...   step sizes to sweep (default 0.01,0.005)\n"
+              << "  --dynres               enable dynamic resolution (default off)\n"
+              << "  --temporal             enable temporal accumulation (default off)\n"
+              << "  --compute              also measure every configuration on the compute ray marching path\n"
+              << "  --thumbnails N         also compare N sequential frames with one batched multi-view pass\n"
+              << "  --thumbnail-size S     thumbnail edge length (default 128)\n"
+              << "  --output FILE          JSON output file (default bench_results.json)" << std::endl;
+}
+
+static bool ParseFloatList(const std::string& text, std::vector<float>& values) {
+    values.clear();
+    std::istringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        float value = (float)std::atof(item.c_str());
+        if (value <= 0.0f) return false;
+        values.push_back(value);
+    }
+    return !values.empty();
+}
+
+static std::string JsonString(const std::string& text) {
+    std::string escaped = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') escaped += '\\';
+        escaped += c;
+    }
+    return escaped + "\"";
+}
+
+// 一组参数的测量结果
+struct BenchResult {
+    float stepSize;
+    bool lighting;
+    bool jittering;
+    bool compute;
+    std::vector<double> frameMs;    // 每帧RenderFrame + glFinish的墙钟时间
+    TimingPercentiles passMs[FrameProfiler::PASS_COUNT];
+    float samplesPerRay;
+};
+
+// 缩略图比较：同一组视图逐个SetCamera + RenderFrame与一次RenderViews的墙钟时间
+struct ThumbnailResult {
+    int views = 0;
+    int tileSize = 0;
+    std::vector<double> sequentialMs;
+    std::vector<double> batchedMs;
+};
+
+static void WriteDistribution(std::ostream& out, std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    double sum = 0.0;
+    for (double value : values) sum += value;
+    auto percentile = [&values](double p) {
+        size_t rank = (size_t)std::ceil(p * values.size());
+        return values[std::min(std::max(rank, (size_t)1), values.size()) - 1];
+    };
+    out << "{ \"min\": " << values.front() << ", \"mean\": " << sum / values.size()
+        << ", \"p50\": " << percentile(0.50) << ", \"p90\": " << percentile(0.90)
+        << ", \"p95\": " << percentile(0.95) << ", \"p99\": " << percentile(0.99)
+        << ", \"max\": " << values.back() << " }";
+}
+
+static void WriteJson(std::ostream& out, const std::vector<BenchResult>& results, const ThumbnailResult& thumbnails,
+                      const std::string& volume, int width, int height, int frames, int warmup) {
+    out << "{\n";
+    out << "  \"renderer\": " << JsonString((const char*)glGetString(GL_RENDERER)) << ",\n";
+    out << "  \"glVersion\": " << JsonString((const char*)glGetString(GL_VERSION)) << ",\n";
+    out << "  \"volume\": " << JsonString(volume) << ",\n";
+    out << "  \"width\": " << width << ",\n";
+    out << "  \"height\": " << height << ",\n";
+    out << "  \"frames\": " << frames << ",\n";
+    out << "  \"warmup\": " << warmup << ",\n";
+    out << "  \"configurations\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult& result = results[i];
+        out << "    {\n";
+        out << "      \"stepSize\": " << result.stepSize << ",\n";
+        out << "      \"lighting\": " << (result.lighting ? "true" : "false") << ",\n";
+        out << "      \"jittering\": " << (result.jittering ? "true" : "false") << ",\n";
+        out << "      \"backend\": " << (result.compute ? "\"compute\"" : "\"fragment\"") << ",\n";
+        out << "      \"frameTimeMs\": ";
+        WriteDistribution(out, result.frameMs);
+        out << ",\n";
+        out << "      \"gpuPassMs\": {";
+        for (int pass = 0; pass < FrameProfiler::PASS_COUNT; pass++) {
+            const TimingPercentiles& timing = result.passMs[pass];
+            out << (pass ? ", " : " ") << JsonString(FrameProfiler::GetPassName((GpuPass)pass))
+                << ": { \"p50\": " << timing.p50 << ", \"p95\": " << timing.p95 << ", \"p99\": " << timing.p99 << " }";
+        }
+        out << " },\n";
+        out << "      \"samplesPerRay\": " << result.samplesPerRay << "\n";
+        out << "    }" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]";
+    if (thumbnails.views > 0) {
+        out << ",\n  \"thumbnails\": {\n";
+        out << "    \"views\": " << thumbnails.views << ",\n";
+        out << "    \"tileSize\": " << thumbnails.tileSize << ",\n";
+        out << "    \"sequentialMs\": ";
+        WriteDistribution(out, thumbnails.sequentialMs);
+        out << ",\n    \"batchedMs\": ";
+        WriteDistribution(out, thumbnails.batchedMs);
+        out << "\n  }";
+    }
+    out << "\n}\n";
+}
+
+int main(int argc, char** argv) {
+    std::string volumeFile;
+    std::string pathFile;
+    std::string outputFile = "bench_results.json";
+    int proceduralSize = 128;
+    int frames = 120;
+    int warmup = 20;
+    int width = 1280;
+    int height = 720;
+    std::vector<float> stepSizes = { 0.01f, 0.005f };
+    bool dynamicResolution = false;
+    bool temporal = false;
+    bool compareCompute = false;
+    int thumbnailCount = 0;
+    int thumbnailSize = 128;
+    
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--volume" && i + 1 < argc) {
+            volumeFile = argv[++i];
+        } else if (arg == "--procedural" && i + 1 < argc) {
+            proceduralSize = std::atoi(argv[++i]);
+        } else if (arg == "--path" && i + 1 < argc) {
+            pathFile = argv[++i];
+        } else if (arg == "--frames" && i + 1 < argc) {
+            frames = std::atoi(argv[++i]);
+        } else if (arg == "--warmup" && i + 1 < argc) {
+            warmup = std::atoi(argv[++i]);
+        } else if (arg == "--width" && i + 1 < argc) {
+            width = std::atoi(argv[++i]);
+        } else if (arg == "--height" && i + 1 < argc) {
+            height = std::atoi(argv[++i]);
+        } else if (arg == "--step-sizes" && i + 1 < argc) {
+            if (!ParseFloatList(argv[++i], stepSizes)) {
+                std::cerr << "Invalid step size list: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (arg == "--dynres") {
+            dynamicResolution = true;
+        } else if (arg == "--temporal") {
+            temporal = true;
+        } else if (arg == "--compute") {
+            compareCompute = true;
+        } else if (arg == "--thumbnails" && i + 1 < argc) {
+            thumbnailCount = std::atoi(argv[++i]);
+        } else if (arg == "--thumbnail-size" && i + 1 < argc) {
+            thumbnailSize = std::atoi(argv[++i]);
+        } else if (arg == "--output" && i + 1 < argc) {
+            outputFile = argv[++i];
+        } else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            PrintUsage();
+            return 1;
+        }
+    }
+    if (frames <= 0 || width <= 0 || height <= 0 || proceduralSize <= 0 || thumbnailCount < 0 || thumbnailSize <= 0) {
+        std::cerr << "Frames, size and procedural size must be positive" << std::endl;
+        return 1;
+    }
+    
+    HeadlessContext context;
+    if (!context.Create(width, height)) {
+        return 1;
+    }
+    
+    CameraPath path = CameraPath::CreateOrbit(frames);
+    if (!pathFile.empty() && !path.Load(pathFile)) {
+        return 1;
+    }
+    
+    std::vector<BenchResult> results;
+    ThumbnailResult thumbnails;
+    {
+        // 渲染器持有GL资源，需在上下文销毁前析构
+        Renderer renderer;
+        if (!renderer.InitRenderer(width, height)) {
+            std::cerr << "Failed to initialize renderer" << std::endl;
+            return 1;
+        }
+        bool loaded = volumeFile.empty() ? renderer.GenerateTestVolume(proceduralSize)
+                                         : renderer.LoadVolumeData(volumeFile);
+        if (!loaded) {
+            std::cerr << "Failed to load volume" << std::endl;
+            return 1;
+        }
+        
+        Camera camera = renderer.GetCameraController().GetCamera();
+        camera.aspectRatio = (float)width / (float)height;
+        
+        // 计算路径不可用时只测片段shader路径
+        int backends = compareCompute && renderer.SupportsComputeRayMarching() ? 2 : 1;
+        if (compareCompute && backends == 1) {
+            std::cerr << "Compute ray marching is not supported, measuring the fragment path only" << std::endl;
+        }
+        for (int compute = 0; compute < backends; compute++) {
+            for (float stepSize : stepSizes) {
+                for (int lighting = 0; lighting < 2; lighting++) {
+                    for (int jittering = 0; jittering < 2; jittering++) {
+                        RenderParams params;
+                        params.stepSize = stepSize;
+                        params.enableLighting = lighting != 0;
+                        params.enableJittering = jittering != 0;
+                        params.enableDynamicResolution = dynamicResolution;
+                        params.enableTemporalAccumulation = temporal;
+                        params.enableComputeRayMarching = compute != 0;
+                        renderer.SetRenderParams(params);
+                        
+                        BenchResult result;
+                        result.stepSize = stepSize;
+                        result.lighting = params.enableLighting;
+                        result.jittering = params.enableJittering;
+                        result.compute = params.enableComputeRayMarching;
+                        result.frameMs.reserve(frames);
+                        
+                        // 每组参数从路径起点开始回放，各组看到相同的画面序列
+                        for (int frame = 0; frame < warmup + frames; frame++) {
+                            if (frame == warmup) {
+                                renderer.GetFrameProfiler().Reset();
+                            }
+                            path.Apply(frame, camera);
+                            
+                            auto start = std::chrono::steady_clock::now();
+                            renderer.SetCamera(camera);
+                            renderer.RenderFrame();
+                            glFinish();
+                            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+                            if (frame >= warmup) {
+                                result.frameMs.push_back(ms);
+                            }
+                        }
+                        
+                        for (int pass = 0; pass < FrameProfiler::PASS_COUNT; pass++) {
+                            result.passMs[pass] = renderer.GetFrameProfiler().GetPassPercentiles((GpuPass)pass);
+                        }
+                        result.samplesPerRay = renderer.GetRenderStats().samplesPerRay;
+                        results.push_back(std::move(result));
+                        
+                        std::cerr << (compute ? "compute" : "fragment") << " step " << stepSize << " lighting " << lighting
+                                  << " jittering " << jittering << ": " << frames << " frames done" << std::endl;
+                    }
+                }
+            }
+        }
+        
+        if (thumbnailCount > 0) {
+            // 默认参数（不含动态分辨率和时间累积，两种方式渲染相同的画面）
+            RenderParams params;
+            params.enableDynamicResolution = false;
+            params.enableTemporalAccumulation = false;
+            renderer.SetRenderParams(params);
+            
+            std::vector<BatchView> views(thumbnailCount);
+            std::vector<glm::ivec4> viewports = MultiViewRenderer::GridLayout(thumbnailCount, thumbnailSize, thumbnailSize);
+            CameraPath orbit = CameraPath::CreateOrbit(thumbnailCount);
+            int atlasWidth = 0, atlasHeight = 0;
+            for (int i = 0; i < thumbnailCount; i++) {
+                views[i].camera = camera;
+                orbit.Apply(i, views[i].camera);
+                views[i].camera.aspectRatio = 1.0f;
+                views[i].viewport = viewports[i];
+                atlasWidth = std::max(atlasWidth, viewports[i].x + viewports[i].z);
+                atlasHeight = std::max(atlasHeight, viewports[i].y + viewports[i].w);
+            }
+            
+            thumbnails.views = thumbnailCount;
+            thumbnails.tileSize = thumbnailSize;
+            const int repeats = std::max(1, frames / 10);
+            renderer.Resize(thumbnailSize, thumbnailSize);
+            for (int repeat = 0; repeat < repeats + 1; repeat++) {
+                // 第一轮为预热（多视图程序和特化变体的首次使用）
+                auto start = std::chrono::steady_clock::now();
+                for (const BatchView& view : views) {
+                    renderer.SetCamera(view.camera);
+                    renderer.RenderFrame();
+                }
+                glFinish();
+                double sequential = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+                
+                start = std::chrono::steady_clock::now();
+                renderer.RenderViews(views, atlasWidth, atlasHeight);
+                glFinish();
+                double batched = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+                
+                if (repeat > 0) {
+                    thumbnails.sequentialMs.push_back(sequential);
+                    thumbnails.batchedMs.push_back(batched);
+                }
+            }
+            renderer.Resize(width, height);
+            std::cerr << thumbnailCount << " thumbnails: " << repeats << " repeats done" << std::endl;
+        }
+    }
+    
+    // 渲染器和加载过程会向标准输出打印日志，结果单独写入文件
+    std::string volumeName = volumeFile.empty() ? "procedural " + std::to_string(proceduralSize) : volumeFile;
+    std::ofstream file(outputFile);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open file: " << outputFile << std::endl;
+        return 1;
+    }
+    WriteJson(file, results, thumbnails, volumeName, width, height, frames, warmup);
+    std::cout << "Wrote " << results.size() << " configurations to " << outputFile << std::endl;
+    return 0;
+}
@@ -0,0 +1,93 @@
+#ifndef ASYNCVOLUMELOADER_H
+#define ASYNCVOLUMELOADER_H
+
+#include "VolumeData.h"
+#include <glad/glad.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 异步体数据加载器：
+// 工作线程读取（内存映射）并预计算梯度，随后由累积的第1层密度递推各LOD层级并打包，
+// GL线程每帧通过PBO环形缓冲上传少量切片（含各LOD层级），
+// 全部上传完成后由调用方取走新的VolumeData替换当前体数据
+class AsyncVolumeLoader {
+public:
+    enum class State {
+        Idle,
+        Loading,
+        Completed,
+        Failed
+    };
+    
+    // PBO数量
+    static const int PBO_COUNT = 3;
+    // 每个上传块的目标大小（字节），实际为整数个切片
+    static const uint64_t CHUNK_BYTES = 4ull * 1024 * 1024;
+    // 工作线程最多领先的块数（限制内存占用）
+    static const int MAX_QUEUED_CHUNKS = 4;
+    
+    AsyncVolumeLoader();
+    ~AsyncVolumeLoader();
+    
+    // 开始加载（需在GL线程调用），正在进行的加载会被取消
+    bool Start(const std::string& filename, int width, int height, int depth, GradientFilter filter);
+    
+    // 每帧在GL线程调用：最多上传chunksPerFrame个块，返回当前状态
+    State Update(int chunksPerFrame = 2);
+    
+    // 取消当前加载
+    void Cancel();
+    
+    // 取走加载完成的体数据（状态回到Idle）
+    std::unique_ptr<VolumeData> TakeResult();
+    
+    State GetState() const { return state; }
+    
+    // 加载进度 [0, 1]
+    float GetProgress() const;
+    
+private:
+    // 工作线程产出的打包切片块（第level层LOD中的[zBegin, zEnd)切片）
+    struct Chunk {
+        int level;
+        int zBegin, zEnd;
+        std::vector<unsigned char> packed;
+    };
+    
+    State state;
+    std::string filename;
+    std::unique_ptr<VolumeData> pendingVolume;
+    int width, height, depth;
+    GradientFilter gradientFilter;
+    int slicesPerChunk;
+    
+    // 工作线程与就绪队列
+    std::thread worker;
+    std::mutex queueMutex;
+    std::condition_variable queueCondition;
+    std::deque<Chunk> readyChunks;
+    std::atomic<bool> cancelRequested;
+    std::atomic<bool> workerFailed;
+    bool workerFinished;
+    
+    // PBO环形缓冲，每个PBO上传后插入fence，复用前非阻塞地检查是否完成
+    GLuint pbos[PBO_COUNT];
+    GLsync fences[PBO_COUNT];
+    int nextPbo;
+    // 已上传/总切片数（各LOD层级合计）
+    int uploadedSlices;
+    int totalSlices;
+    
+    void WorkerMain();
+    // 就绪队列满时等待GL线程消费后放入，取消时返回false
+    bool PushChunk(Chunk&& chunk);
+    void ReleaseGLResources();
+};
+
+#endif // ASYNCVOLUMELOADER_H
@@ -0,0 +1,124 @@
+#ifndef BRICKCACHE_H
+#define BRICKCACHE_H
+
+#include "MappedFile.h"
+#include "VolumeGradient.h"
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// 分块（brick）的核外体渲染缓存：
+// 体数据按固定大小分块（带1体素边缘），按需载入GPU上的块图集（atlas），
+// 页表纹理记录每个块在图集中的槽位；由低分辨率反馈pass报告光线实际访问的块，LRU淘汰
+class BrickCache {
+public:
+    // 块的有效边长、边缘宽度和图集中的存储边长（需与raymarching.frag一致）
+    static const int BRICK_SIZE = 32;
+    static const int BRICK_APRON = 1;
+    static const int BRICK_STORAGE = BRICK_SIZE + 2 * BRICK_APRON;
+    
+    // 反馈pass相对屏幕的缩小倍数
+    static const int FEEDBACK_DIVISOR = 8;
+    // 每帧最多上传的块数、同时在后台准备的块数
+    static const int MAX_UPLOADS_PER_FRAME = 32;
+    static const int MAX_PENDING_LOADS = 64;
+    
+    // 页表项的标志（alpha通道）
+    static const unsigned char PAGE_NOT_RESIDENT = 0;
+    static const unsigned char PAGE_EMPTY = 128;
+    static const unsigned char PAGE_RESIDENT = 255;
+    
+    BrickCache();
+    ~BrickCache();
+    
+    // 打开原始体数据文件并分配图集（atlasBudgetBytes为图集显存预算）
+    bool Open(const std::string& filename, int width, int height, int depth,
+              GradientFilter filter, uint64_t atlasBudgetBytes = 512ull * 1024 * 1024);
+    
+    // 反馈pass：绑定低分辨率反馈缓冲，之后以feedbackPass=true绘制一次光线步进
+    void BeginFeedback(int screenWidth, int screenHeight);
+    // 结束反馈pass并发起异步回读，恢复默认帧缓冲和视口
+    void EndFeedback(int screenWidth, int screenHeight);
+    
+    // 每帧调用：处理上一次的反馈、调度后台加载、把就绪的块上传到图集
+    void Update();
+    
+    // 绑定图集和页表纹理
+    void Bind(GLuint atlasUnit, GLuint pageTableUnit) const;
+    
+    int GetWidth() const { return width; }
+    int GetHeight() const { return height; }
+    int GetDepth() const { return depth; }
+    glm::ivec3 GetBrickGridSize() const { return brickGridSize; }
+    glm::vec3 GetAtlasSize() const { return glm::vec3(atlasSlots * BRICK_STORAGE); }
+    int GetResidentBrickCount() const { return (int)residentBricks.size(); }
+    
+    // 是否仍有块在载入（最近处理的反馈报告了缺失块，或有块在后台准备/等待上传），此时画面仍会变化
+    bool IsStreaming() const { return lastFeedbackMissing || !pendingBricks.empty(); }
+    
+private:
+    // 后台线程准备好的块
+    struct LoadedBrick {
+        uint32_t brickIndex;
+        bool empty;
+        std::vector<unsigned char> packed;
+    };
+    
+    // 驻留块：图集槽位和最近使用帧
+    struct ResidentBrick {
+        int slot;
+        uint64_t lastUsedFrame;
+        std::list<uint32_t>::iterator lruPosition;
+    };
+    
+    MappedFile file;
+    int width, height, depth;
+    GradientFilter gradientFilter;
+    glm::ivec3 brickGridSize;
+    glm::ivec3 atlasSlots;
+    uint64_t frameIndex;
+    
+    // GPU资源
+    GLuint atlasTexture;
+    GLuint pageTableTexture;
+    GLuint feedbackTexture;
+    GLuint feedbackFBO;
+    GLuint feedbackPBOs[2];
+    GLsync feedbackFences[2];
+    int feedbackWidth, feedbackHeight;
+    int feedbackPboSize[2];
+    int nextFeedbackPbo;
+    bool lastFeedbackMissing;
+    
+    // 页表的CPU副本（RGBA8：槽位xyz + 标志）
+    std::vector<unsigned char> pageTable;
+    
+    // 驻留状态与LRU（表头为最近使用）
+    std::unordered_map<uint32_t, ResidentBrick> residentBricks;
+    std::list<uint32_t> lruList;
+    std::vector<int> freeSlots;
+    
+    // 后台加载
+    std::unordered_set<uint32_t> pendingBricks;
+    std::mutex loadedMutex;
+    std::vector<LoadedBrick> loadedBricks;
+    std::atomic<int> inFlightLoads;
+    
+    void ProcessFeedback();
+    void RequestBrick(uint32_t brickIndex);
+    void UploadLoadedBricks();
+    void TouchBrick(uint32_t brickIndex);
+    int AllocateSlot();
+    void SetPageEntry(uint32_t brickIndex, int slot, unsigned char flag);
+    void CreateFeedbackTarget(int w, int h);
+    void Release();
+};
+
+#endif // BRICKCACHE_H
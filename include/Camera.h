@@ -20,6 +20,14 @@ public:
     // 获取投影矩阵
     glm::mat4 GetProjectionMatrix() const;
     
+    // 视图/投影矩阵的逆（解析求得，不做一般4x4求逆）
+    glm::mat4 GetInverseViewMatrix() const;
+    glm::mat4 GetInverseProjectionMatrix() const;
+    
+    // 任意摄像机的视图/投影逆矩阵（批量多视图等不经过控制器的摄像机使用）
+    static glm::mat4 ComputeInverseViewMatrix(const Camera& camera);
+    static glm::mat4 ComputeInverseProjectionMatrix(const Camera& camera);
+    
     // 处理键盘输入
     void ProcessKeyboard(int direction, float deltaTime);
     
@@ -35,6 +43,9 @@ public:
     // 设置宽高比
     void SetAspectRatio(float ratio) { camera.aspectRatio = ratio; }
     
+    // 自上次调用以来摄像机是否移动过（位置、朝向或视场角变化）
+    bool ConsumeMovement();
+    
     enum Movement {
         FORWARD,
         BACKWARD,
@@ -46,6 +57,11 @@ public:
     
 private:
     Camera camera;
+    
+    // 上次ConsumeMovement时的摄像机状态
+    glm::vec3 lastPosition;
+    glm::vec3 lastFront;
+    float lastFov;
 };
 
 #endif // CAMERA_H
@@ -0,0 +1,39 @@
+#ifndef CAMERAPATH_H
+#define CAMERAPATH_H
+
+#include "Types.h"
+#include <string>
+#include <vector>
+
+// 摄像机路径：按帧记录的摄像机关键帧，用于录制交互过程并在基准测试中回放
+// 文本格式每行一帧："px py pz yaw pitch fov"，#开头的行为注释
+class CameraPath {
+public:
+    struct Keyframe {
+        glm::vec3 position;
+        float yaw;
+        float pitch;
+        float fov;
+    };
+    
+    // 记录一帧
+    void AddKeyframe(const Camera& camera);
+    
+    bool Load(const std::string& filename);
+    bool Save(const std::string& filename) const;
+    
+    void Clear() { keyframes.clear(); }
+    int GetKeyframeCount() const { return (int)keyframes.size(); }
+    bool IsEmpty() const { return keyframes.empty(); }
+    
+    // 把第index帧（超出范围时循环）写入摄像机，并按欧拉角更新front/right/up
+    void Apply(int index, Camera& camera) const;
+    
+    // 绕原点一周的环绕路径：半径radius，高度height，始终朝向原点
+    static CameraPath CreateOrbit(int frames, float radius = 2.0f, float height = 0.5f);
+    
+private:
+    std::vector<Keyframe> keyframes;
+};
+
+#endif // CAMERAPATH_H
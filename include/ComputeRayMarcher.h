@@ -0,0 +1,54 @@
+#ifndef COMPUTERAYMARCHER_H
+#define COMPUTERAYMARCHER_H
+
+#include "ShaderCache.h"
+#include <glad/glad.h>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+// 计算shader光线步进路径（需GL 4.3）：与片段路径共用raymarching.frag（COMPUTE_PATH入口）、纹理、uniform块和特化变体键
+// 常驻工作组（每组TILE_SIZE²个线程）从原子计数器实现的队列中领取屏幕块，每轮把各槽位的光线推进SEGMENT_STEPS次迭代，
+// 结束的光线立即写出，其余压缩到槽位前部并由新像素补满，避免片段路径中一个warp等待其中最长光线的问题
+// 结果写入RGBA16F纹理（动态分辨率的离屏目标）的左下角子区域，之后的时间累积和上采样与片段路径相同
+class ComputeRayMarcher {
+public:
+    // 屏幕块边长（像素），工作组大小为其平方
+    static const int TILE_SIZE = 8;
+    // 每轮每条光线最多推进的迭代数（压缩与补充的间隔）
+    static const int SEGMENT_STEPS = 32;
+    // 常驻工作组数上限（足以占满大型GPU；块数更少时按块数派发）
+    static const int MAX_PERSISTENT_GROUPS = 1024;
+    
+    ComputeRayMarcher();
+    ~ComputeRayMarcher();
+    
+    ComputeRayMarcher(const ComputeRayMarcher&) = delete;
+    ComputeRayMarcher& operator=(const ComputeRayMarcher&) = delete;
+    
+    // 当前上下文是否支持计算shader路径（GL 4.3）
+    static bool IsSupported();
+    
+    // 编译通用计算程序，setup设置纹理单元和uniform块（与光线步进程序相同）
+    bool Initialize(const std::function<void(Shader&)>& setup);
+    
+    // 特化变体（键和定义与片段路径相同）
+    void Request(uint64_t key, const std::string& defines) { shaders->Request(key, defines); }
+    bool IsReady(uint64_t key) const { return shaders->IsReady(key); }
+    
+    // 每帧调用一次：检查正在后台编译的变体
+    void Update() { shaders->Update(); }
+    
+    // 以key对应的程序（未就绪时为通用程序）把width x height的画面写入targetTexture（RGBA16F）左下角
+    // 调用前需绑定体数据纹理和uniform块；返回时写入对之后的纹理采样和帧缓冲操作可见
+    void Dispatch(uint64_t key, GLuint targetTexture, int width, int height);
+    
+private:
+    std::unique_ptr<ShaderCache> shaders;
+    GLuint queueBuffer;                 // 块队列的原子计数器（std430 SSBO）
+    
+    void Release();
+};
+
+#endif // COMPUTERAYMARCHER_H
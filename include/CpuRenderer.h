@@ -0,0 +1,82 @@
+#ifndef CPURENDERER_H
+#define CPURENDERER_H
+
+#include "Types.h"
+#include "ThreadPool.h"
+#include "VolumeGradient.h"
+#include <glm/glm.hpp>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// CPU参考渲染器 - 与raymarching.frag实现相同的算法，用于无GPU节点和GPU路径的正确性校验
+class CpuRenderer {
+public:
+    // 屏幕分块大小（像素）
+    static const int TILE_SIZE = 32;
+    // 体素分块边长，三线性插值的8个邻居大多位于同一块内
+    static const int BRICK_SIZE = 8;
+    
+    // pool为空时使用共享线程池
+    explicit CpuRenderer(ThreadPool* pool = nullptr);
+    ~CpuRenderer() = default;
+    
+    // 从原始数据文件加载体数据（不依赖OpenGL）
+    bool LoadFromFile(const std::string& filename, int width, int height, int depth);
+    
+    // 设置梯度算子（需在SetVolumeData之前设置，与VolumeData保持一致）
+    void SetGradientFilter(GradientFilter filter) { gradientFilter = filter; }
+    
+    // 设置体数据（x最快、z最慢的线性存储），内部预计算梯度并转为分块布局
+    // spacing为体素间距，与GPU路径相同地决定包围盒比例和梯度缩放
+    bool SetVolumeData(const unsigned char* data, int width, int height, int depth,
+                       const glm::vec3& spacing = glm::vec3(1.0f));
+    
+    // 更新传输函数
+    void SetTransferFunction(const std::vector<glm::vec4>& colors);
+    
+    // 渲染一帧到调用方提供的RGBA8缓冲区（width*height*4字节，行序与glReadPixels一致：自下而上）
+    // time与GPU路径的time uniform含义相同，用于抖动采样
+    void Render(const RenderParams& params, const Camera& camera, float time,
+                unsigned char* rgba, int width, int height) const;
+    
+private:
+    ThreadPool* threadPool;
+    
+    // 分块布局的打包体素（RGBA8：梯度 + 密度，与GPU纹理相同）
+    int volumeWidth, volumeHeight, volumeDepth;
+    glm::vec3 volumeSpacing;
+    int bricksX, bricksY, bricksZ;
+    std::vector<unsigned char> brickedVoxels;
+    GradientFilter gradientFilter;
+    
+    std::vector<glm::vec4> transferFunction;
+    
+    // 预积分表缓存：与Renderer一样只在传输函数或阈值变化时重建（O(n²)）；
+    // Render为const且可能并发调用，因此按阈值惰性重建，各次渲染持有自己取到的表
+    mutable std::mutex preIntegrationMutex;
+    mutable std::shared_ptr<const std::vector<glm::vec4>> preIntegrationTable;
+    mutable float preIntegrationThreshold;
+    
+    // 取得当前传输函数和阈值对应的预积分表（必要时重建）
+    std::shared_ptr<const std::vector<glm::vec4>> GetPreIntegrationTable(float threshold) const;
+    
+    // 读取单个打包体素（坐标已钳制在体积内）
+    const unsigned char* FetchVoxel(int x, int y, int z) const;
+    
+    // 与GL_LINEAR + GL_CLAMP_TO_EDGE一致的采样，返回归一化的RGBA
+    glm::vec4 SampleVolume(const glm::vec3& texCoord) const;
+    glm::vec4 SampleTransferFunction(float value) const;
+    
+    // 预积分表的双线性采样（与GL_LINEAR的2D纹理一致）
+    glm::vec4 SamplePreIntegration(const std::vector<glm::vec4>& table, float front, float back) const;
+    
+    // 渲染单个屏幕分块
+    void RenderTile(int tileX, int tileY, const RenderParams& params, const glm::mat4& invView,
+                    const glm::mat4& invProjection, const glm::vec3& cameraPos, float time,
+                    const std::vector<glm::vec4>& preIntegrationTable,
+                    unsigned char* rgba, int width, int height) const;
+};
+
+#endif // CPURENDERER_H
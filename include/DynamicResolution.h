@@ -0,0 +1,61 @@
+#ifndef DYNAMICRESOLUTION_H
+#define DYNAMICRESOLUTION_H
+
+#include "Shader.h"
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <memory>
+
+// 动态分辨率：光线步进pass渲染到离屏目标，缩放比例由GPU时间反馈控制，再边缘保持地上采样到窗口
+// 离屏纹理按窗口尺寸分配一次，缩放变化时只使用其左下角子区域，不需要重新分配
+// 离屏纹理为RGBA16F：a通道保存光线步进输出的代表深度，供时间累积重投影使用
+class DynamicResolution {
+public:
+    // 误差在目标的±DEADBAND以内时不调整，避免分辨率来回抖动
+    static constexpr float DEADBAND = 0.05f;
+    // 超出预算时快速降低、低于预算时缓慢恢复
+    static constexpr float DECREASE_RATE = 0.5f;
+    static constexpr float INCREASE_RATE = 0.1f;
+    // 缩放比例的量化步长，避免每帧微小变化引起画面闪烁
+    static constexpr float SCALE_STEP = 1.0f / 64.0f;
+    
+    DynamicResolution();
+    ~DynamicResolution();
+    
+    // 加载上采样shader（需在GL线程调用）
+    bool Initialize();
+    
+    // 由最近测得的GPU时间调整缩放比例：像素数与GPU时间近似成正比，目标比例为 scale * sqrt(target / measured)
+    void Update(float gpuTimeMs, float targetTimeMs, float minScale);
+    
+    // 恢复为全分辨率
+    void Reset() { scale = 1.0f; }
+    
+    float GetScale() const { return scale; }
+    
+    // 当前比例下的渲染尺寸
+    glm::ivec2 GetRenderSize(int screenWidth, int screenHeight) const;
+    
+    // 绑定离屏目标、设置视口并清屏
+    void BeginScene(int screenWidth, int screenHeight);
+    
+    // 离屏颜色纹理（本帧光线步进结果位于左下角渲染尺寸子区域）
+    GLuint GetColorTexture() const { return colorTexture; }
+    
+    // 把sourceTexture左下角的渲染尺寸子区域上采样到targetFramebuffer的整个窗口区域（调用方需已绑定全屏四边形VAO）
+    // sourceTexture通常为GetColorTexture()，启用时间累积时为混合后的历史纹理
+    void Upsample(int screenWidth, int screenHeight, GLuint sourceTexture, GLuint targetFramebuffer);
+    
+private:
+    std::unique_ptr<Shader> upsampleShader;
+    GLuint colorTexture;
+    GLuint framebuffer;
+    int targetWidth, targetHeight;      // 离屏纹理尺寸
+    glm::ivec2 renderSize;              // 本帧使用的子区域尺寸
+    float scale;
+    
+    void CreateTarget(int width, int height);
+    void Release();
+};
+
+#endif // DYNAMICRESOLUTION_H
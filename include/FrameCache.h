@@ -0,0 +1,37 @@
+#ifndef FRAMECACHE_H
+#define FRAMECACHE_H
+
+#include <glad/glad.h>
+
+// 最近一次渲染结果的缓存：每帧的最终画面先写入离屏帧缓冲再复制到窗口，
+// 场景未变化时直接复制缓存，不再重新光线步进
+class FrameCache {
+public:
+    FrameCache();
+    ~FrameCache();
+    
+    FrameCache(const FrameCache&) = delete;
+    FrameCache& operator=(const FrameCache&) = delete;
+    
+    // 绑定缓存帧缓冲作为渲染目标并设置视口（尺寸变化时重新分配）
+    void Begin(int width, int height);
+    
+    // 缓存帧缓冲（供上采样等pass直接写入）
+    GLuint GetFramebuffer() const { return framebuffer; }
+    
+    // 把缓存内容复制到默认帧缓冲，之后默认帧缓冲保持绑定
+    void Present(int width, int height);
+    
+    // 缓存中是否有与给定尺寸一致的完整画面
+    bool IsValid(int width, int height) const { return valid && width == cacheWidth && height == cacheHeight; }
+    
+private:
+    GLuint colorRenderbuffer;
+    GLuint framebuffer;
+    int cacheWidth, cacheHeight;
+    bool valid;
+    
+    void Release();
+};
+
+#endif // FRAMECACHE_H
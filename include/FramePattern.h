@@ -0,0 +1,12 @@
+#ifndef FRAMEPATTERN_H
+#define FRAMEPATTERN_H
+
+#include <string>
+
+// 带帧序号的文件名模式（如 "frame_%05d.png"、"sim_%04d.raw"），供图像序列输出和时变体数据读取共用
+namespace FramePattern {
+    // 把帧序号代入模式（只接受一个%d或%0Nd），模式无效时返回false
+    bool Format(const std::string& pattern, int frame, std::string& name);
+}
+
+#endif // FRAMEPATTERN_H
@@ -0,0 +1,62 @@
+#ifndef FRAMEPROFILER_H
+#define FRAMEPROFILER_H
+
+#include "Types.h"
+#include "GpuTimer.h"
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 帧性能分析：每个GPU阶段一个GpuTimer（各自的查询环形缓冲，取回结果不阻塞），
+// 每帧记录CPU帧间隔和本帧取回的各阶段GPU时间，保留最近HISTORY_SIZE帧用于计算百分位数和导出CSV
+// 阶段按提交顺序依次计时，不能嵌套（同一时刻只能有一个GL_TIME_ELAPSED查询）
+class FrameProfiler {
+public:
+    // 保留的帧数（60 FPS时约10秒）
+    static const int HISTORY_SIZE = 600;
+    static const int PASS_COUNT = (int)GpuPass::Count;
+    
+    FrameProfiler();
+    
+    // 每帧开始时调用：取回已完成的查询，与上一帧的CPU帧间隔一起记为一帧
+    void BeginFrame(float cpuFrameMs);
+    
+    // 清空已记录的帧（进行中的查询不受影响）
+    void Reset();
+    
+    // 开始/结束某一阶段的计时（需在GL线程调用）
+    void BeginPass(GpuPass pass) { timers[(int)pass].Begin(); }
+    void EndPass(GpuPass pass) { timers[(int)pass].End(); }
+    
+    // 本帧BeginFrame是否取回了该阶段的新结果，以及结果（毫秒，没有时为0）
+    bool HasFrameResult(GpuPass pass) const { return frameMs[(int)pass] >= 0.0f; }
+    float GetFrameMs(GpuPass pass) const { return std::max(frameMs[(int)pass], 0.0f); }
+    
+    // 窗口内的百分位数（没有数据时为0）
+    TimingPercentiles GetFramePercentiles() const;
+    TimingPercentiles GetPassPercentiles(GpuPass pass) const;
+    
+    // 按帧导出窗口内的记录（frame, cpu_frame_ms, 各阶段ms；该帧没有结果的阶段留空）
+    bool WriteCsv(const std::string& filename) const;
+    
+    static const char* GetPassName(GpuPass pass);
+    
+private:
+    struct FrameRecord {
+        uint64_t frame;
+        float cpuMs;
+        float passMs[PASS_COUNT];   // 小于0表示该帧没有取回结果
+    };
+    
+    GpuTimer timers[PASS_COUNT];
+    float frameMs[PASS_COUNT];
+    std::vector<FrameRecord> history;   // 环形缓冲
+    int historyHead;                    // 下一条记录的位置
+    uint64_t frameIndex;
+    
+    // column < 0 为CPU帧间隔，否则为阶段序号
+    TimingPercentiles ComputePercentiles(int column) const;
+};
+
+#endif // FRAMEPROFILER_H
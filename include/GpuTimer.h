@@ -0,0 +1,39 @@
+#ifndef GPUTIMER_H
+#define GPUTIMER_H
+
+#include <glad/glad.h>
+
+// GPU计时器：用GL_TIME_ELAPSED查询测量一段命令在GPU上的执行时间
+// 查询按环形缓冲轮换，结果在若干帧之后非阻塞地取回，不会让CPU等待GPU
+// 同一时刻只能有一个GL_TIME_ELAPSED查询处于活动状态，不能嵌套
+class GpuTimer {
+public:
+    // 环形缓冲中的查询数（允许GPU落后CPU的最大帧数）
+    static const int QUERY_COUNT = 4;
+    
+    GpuTimer();
+    ~GpuTimer();
+    
+    GpuTimer(const GpuTimer&) = delete;
+    GpuTimer& operator=(const GpuTimer&) = delete;
+    
+    // 开始/结束计时（需在GL线程调用）；环形缓冲已满时本次不计时
+    void Begin();
+    void End();
+    
+    // 取回所有已完成的查询，有新结果时返回true，milliseconds为最近一次的结果
+    bool Poll(float& milliseconds);
+    
+    // 最近一次取回的结果（毫秒），尚无结果时为0
+    float GetLastMs() const { return lastMs; }
+    
+private:
+    GLuint queries[QUERY_COUNT];
+    int writeIndex;     // 下一次Begin使用的查询
+    int readIndex;      // 最早一个未取回的查询
+    int pending;        // 已提交但未取回的查询数
+    bool active;        // Begin之后、End之前
+    float lastMs;
+};
+
+#endif // GPUTIMER_H
@@ -0,0 +1,28 @@
+#ifndef IMAGEWRITER_H
+#define IMAGEWRITER_H
+
+#include <string>
+#include <vector>
+
+// 图像文件编码（无外部依赖）：PPM（P6）和PNG（8位RGB，Up滤波 + 固定哈夫曼deflate）
+// 输入为RGB8像素，rows按从上到下的顺序存储；函数可在任意线程并发调用
+namespace ImageWriter {
+    enum class Format {
+        PPM,
+        PNG
+    };
+    
+    // 按扩展名（.ppm / .png，不区分大小写）判断格式，无法识别时返回false
+    bool FormatFromFilename(const std::string& filename, Format& format);
+    
+    bool WritePPM(const std::string& filename, int width, int height, const unsigned char* rgb);
+    bool WritePNG(const std::string& filename, int width, int height, const unsigned char* rgb);
+    
+    // 按format写出
+    bool Write(const std::string& filename, Format format, int width, int height, const unsigned char* rgb);
+    
+    // zlib流（deflate固定哈夫曼块 + 哈希链匹配），供PNG的IDAT使用
+    std::vector<unsigned char> ZlibCompress(const unsigned char* data, size_t size);
+}
+
+#endif // IMAGEWRITER_H
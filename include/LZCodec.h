@@ -0,0 +1,20 @@
+#ifndef LZCODEC_H
+#define LZCODEC_H
+
+#include <cstddef>
+
+// 轻量LZ77字节压缩（LZ4风格的序列格式），面向解压速度，无外部依赖
+// 每个序列：token（高4位字面量长度，低4位匹配长度-4，取15时后续字节继续累加）、
+// 字面量、2字节小端匹配偏移；最后一个序列只有字面量
+namespace LZCodec {
+    // 最坏情况下压缩输出的大小上界
+    size_t CompressBound(size_t size);
+    
+    // 压缩src，返回写入dst的字节数；dst容量不足时返回0
+    size_t Compress(const unsigned char* src, size_t size, unsigned char* dst, size_t capacity);
+    
+    // 解压到dst，必须恰好得到rawSize字节；数据损坏时返回false（所有读写都做边界检查）
+    bool Decompress(const unsigned char* src, size_t size, unsigned char* dst, size_t rawSize);
+}
+
+#endif // LZCODEC_H
@@ -0,0 +1,46 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// 只读内存映射文件，大体数据无需整体读入内存
+class MappedFile {
+public:
+    MappedFile();
+    ~MappedFile();
+    
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    
+    // 映射整个文件
+    bool Open(const std::string& filename);
+    void Close();
+    
+    bool IsOpen() const { return data != nullptr; }
+    const unsigned char* GetData() const { return data; }
+    uint64_t GetSize() const { return size; }
+    
+    // 提示操作系统将按顺序访问
+    void AdviseSequential() const;
+    
+    // 提示操作系统预读[offset, offset+length)范围（异步，立即返回）
+    void Prefetch(uint64_t offset, uint64_t length) const;
+    
+    // 释放[offset, offset+length)范围内已驻留的页（仍可再次访问，会重新从文件读取）
+    void Release(uint64_t offset, uint64_t length) const;
+    
+private:
+    const unsigned char* data;
+    uint64_t size;
+    
+#ifdef _WIN32
+    void* fileHandle;
+    void* mappingHandle;
+#else
+    int fileDescriptor;
+#endif
+};
+
+#endif // MAPPEDFILE_H
@@ -0,0 +1,56 @@
+#ifndef MULTIVIEWRENDERER_H
+#define MULTIVIEWRENDERER_H
+
+#include "Shader.h"
+#include "Types.h"
+#include "UniformBuffer.h"
+#include "UniformBlocks.h"
+#include <glad/glad.h>
+#include <functional>
+#include <memory>
+#include <vector>
+
+// 批量多视图渲染（缩略图、正交预览、对比网格）：光线步进程序的多视图变体（MULTI_VIEW）以实例化绘制
+// 一次画出最多MAX_VIEWS_PER_DRAW个视图，每个实例从ViewBlock读取自己的摄像机并把四边形缩放到图集中的视口；
+// 体数据、传输函数和RenderBlock由调用方绑定/上传一次，所有视图共用
+// 多视图变体读取与通用程序相同的运行时开关（不做编译期特化），不做时间累积和动态分辨率
+class MultiViewRenderer {
+public:
+    // 每次绘制的视图数（ViewBlock数组长度，与shader中的MAX_VIEWS一致；64 * 160字节不超过16KB的uniform块下限）
+    static const int MAX_VIEWS_PER_DRAW = 64;
+    
+    MultiViewRenderer();
+    ~MultiViewRenderer();
+    
+    MultiViewRenderer(const MultiViewRenderer&) = delete;
+    MultiViewRenderer& operator=(const MultiViewRenderer&) = delete;
+    
+    // 编译多视图变体，setup设置纹理单元和uniform块（与光线步进程序相同）
+    bool Initialize(const std::function<void(Shader&)>& setup);
+    
+    // 把views画入atlasWidth x atlasHeight的RGBA8图集（尺寸变化时重新分配，未被视图覆盖的区域清为黑色）
+    // 调用前需绑定全屏四边形VAO、体数据纹理和RenderBlock/ChannelBlock；返回后图集帧缓冲保持绑定
+    void Render(const std::vector<BatchView>& views, int atlasWidth, int atlasHeight);
+    
+    // 图集（左下角为原点，与视口坐标一致）
+    GLuint GetFramebuffer() const { return framebuffer; }
+    GLuint GetTexture() const { return texture; }
+    int GetWidth() const { return width; }
+    int GetHeight() const { return height; }
+    
+    // 按网格排列count个tileWidth x tileHeight的视口（从左上角开始逐行），columns <= 0时取接近正方形的列数
+    static std::vector<glm::ivec4> GridLayout(int count, int tileWidth, int tileHeight, int columns = 0);
+
+private:
+    std::unique_ptr<Shader> shader;
+    UniformBuffer viewUniformBuffer;
+    std::vector<ViewUniforms> viewUniforms;
+    GLuint texture;
+    GLuint framebuffer;
+    int width, height;
+    
+    void CreateTarget(int w, int h);
+    void Release();
+};
+
+#endif // MULTIVIEWRENDERER_H
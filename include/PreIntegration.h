@@ -0,0 +1,29 @@
+#ifndef PREINTEGRATION_H
+#define PREINTEGRATION_H
+
+#include <glm/glm.hpp>
+#include <cmath>
+#include <vector>
+
+// 预积分传输函数
+// 光线每一步视为一个片段，密度在前端值sf与后端值sb之间线性变化。查找表给出该片段上传输函数的积分：
+//   a   = 片段内平均消光 avg(tf.a)
+//   rgb = 按消光加权的平均颜色 ∫tf.a·tf.rgb / ∫tf.a（非预乘）
+// 片段的不透明度再按实际长度L计算：alpha = 1 - exp(-a * L * absorption * OPACITY_SCALE)
+// 因此步长、LOD和吸收系数变化都不需要重建查找表
+namespace PreIntegration {
+    // 消光系数缩放：与逐点采样时 alpha = tf.a * 步长 * absorption * 100 的小步长极限一致
+    const float OPACITY_SCALE = 100.0f;
+    
+    // 由传输函数构建 n×n 查找表（n = tf.size()），table[back * n + front]
+    // 第i个条目对应的值为 (i + 0.5) / n，与1D纹理的纹素中心一致；不超过threshold的值按透明处理
+    // 先求一次积分的前缀和，每个表项只需两次查表相减，总开销O(n²)
+    void BuildTable(const std::vector<glm::vec4>& transferFunction, float threshold, std::vector<glm::vec4>& table);
+    
+    // 片段长度为length时的不透明度
+    inline float SegmentOpacity(float averageExtinction, float length, float absorption) {
+        return 1.0f - std::exp(-averageExtinction * length * absorption * OPACITY_SCALE);
+    }
+}
+
+#endif // PREINTEGRATION_H
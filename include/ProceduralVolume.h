@@ -0,0 +1,41 @@
+#ifndef PROCEDURALVOLUME_H
+#define PROCEDURALVOLUME_H
+
+#include "ThreadPool.h"
+#include <cstdint>
+#include <vector>
+
+// 程序化体数据形状
+enum class ProceduralShape {
+    Clouds,     // 梯度噪声fBm云团（带球形衰减）
+    Spheres,    // 随机分布的软边球体
+    Turbulence  // 湍流场（各倍频|噪声|之和）
+};
+
+// 程序化生成参数；相同参数和种子在任意分辨率、线程数下结果确定
+// 坐标按最长轴归一化到[0, 1]，不同分辨率生成的是同一形状的不同采样
+struct ProceduralParams {
+    ProceduralShape shape = ProceduralShape::Clouds;
+    uint32_t seed = 1;
+    float frequency = 4.0f;     // 基频（沿最长轴的噪声周期数）
+    int octaves = 5;            // fBm倍频数
+    float lacunarity = 2.0f;    // 每个倍频的频率倍数
+    float gain = 0.5f;          // 每个倍频的振幅倍数
+    int sphereCount = 16;       // Spheres形状的球体个数
+};
+
+// 程序化体数据生成：按Z切片分配到线程池，每行在x方向上做无分支的定长循环（便于编译器向量化）
+namespace ProceduralVolume {
+    // 生成[zBegin, zEnd)范围的切片，out需至少容纳 width*height*(zEnd-zBegin) 字节（x最快）
+    void GenerateSlices(const ProceduralParams& params, int width, int height, int depth,
+                        int zBegin, int zEnd, unsigned char* out, ThreadPool& pool = ThreadPool::Shared());
+    
+    // 生成整个体积
+    std::vector<unsigned char> Generate(const ProceduralParams& params, int width, int height, int depth,
+                                        ThreadPool& pool = ThreadPool::Shared());
+    
+    // 形状名称（用于界面和日志）
+    const char* GetShapeName(ProceduralShape shape);
+}
+
+#endif // PROCEDURALVOLUME_H
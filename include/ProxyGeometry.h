@@ -0,0 +1,58 @@
+#ifndef PROXYGEOMETRY_H
+#define PROXYGEOMETRY_H
+
+#include "Shader.h"
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <memory>
+#include <vector>
+
+// 光线区间的代理几何：由宏单元占用（见VolumeData::ClassifyMacrocells）生成包住所有非空单元的闭合网格，
+// 只保留非空单元与空单元/网格外之间的面（沿一个轴合并成长条），每帧以MIN混合把所有面到摄像机的距离画入边界纹理：
+// r = 最近正面，g = 最近背面，b = -最远背面（未覆盖的像素为MISS_DISTANCE）；
+// 光线步进从第一个正面（摄像机在非空区域内时为0）开始、在最后一个背面结束，未覆盖的像素直接输出背景
+class ProxyGeometry {
+public:
+    // 边界纹理的清除值（未被任何面覆盖）
+    static constexpr float MISS_DISTANCE = 1e30f;
+    
+    ProxyGeometry();
+    ~ProxyGeometry();
+    
+    ProxyGeometry(const ProxyGeometry&) = delete;
+    ProxyGeometry& operator=(const ProxyGeometry&) = delete;
+    
+    // 加载代理几何shader（需在GL线程调用）
+    bool Initialize();
+    
+    // 由宏单元占用重建网格（阈值、传输函数或体数据变化后调用），顶点为体数据纹理坐标[0,1]
+    // gridScale为纹理坐标 -> 宏单元坐标的缩放（体素数不是单元边长整数倍时最后一层单元只覆盖到1）
+    void Build(const std::vector<unsigned char>& occupancy, const glm::ivec3& gridSize, const glm::vec3& gridScale);
+    
+    // 把代理几何的入口/出口距离画入边界纹理左下角的width x height子区域（纹理只在需要更大尺寸时重新分配）
+    // 纹理坐标按[boxMin, boxMax]映射到世界空间；返回后边界帧缓冲保持绑定
+    void Render(int width, int height, const glm::mat4& viewProjection, const glm::vec3& cameraPos,
+                const glm::vec3& boxMin, const glm::vec3& boxMax);
+    
+    void Bind(GLuint textureUnit) const;
+    
+    // 视图内纹理坐标 -> 边界纹理坐标的缩放（上次Render的子区域尺寸 / 纹理尺寸）
+    glm::vec2 GetBoundsScale() const;
+    
+    int GetTriangleCount() const { return vertexCount / 3; }
+
+private:
+    std::unique_ptr<Shader> shader;
+    GLuint vao;
+    GLuint vbo;
+    int vertexCount;
+    GLuint boundsTexture;
+    GLuint framebuffer;
+    int textureWidth, textureHeight;
+    glm::ivec2 renderSize;
+    
+    void CreateTarget(int width, int height);
+    void Release();
+};
+
+#endif // PROXYGEOMETRY_H
@@ -0,0 +1,48 @@
+#ifndef RAYSTATISTICS_H
+#define RAYSTATISTICS_H
+
+#include "Shader.h"
+#include <glad/glad.h>
+#include <functional>
+#include <memory>
+
+// 光线采样数统计：每隔INTERVAL_FRAMES帧以1/DIVISOR分辨率绘制一次计数变体（COUNT_SAMPLES），
+// 每个像素输出(采样数, 步数, 是否命中包围盒)，经PBO异步回读后求平均，不阻塞渲染
+// 计数变体读取与通用程序相同的运行时开关，统计结果反映当前参数
+class RayStatistics {
+public:
+    static const int DIVISOR = 8;
+    static const int INTERVAL_FRAMES = 30;
+    
+    RayStatistics();
+    ~RayStatistics();
+    
+    RayStatistics(const RayStatistics&) = delete;
+    RayStatistics& operator=(const RayStatistics&) = delete;
+    
+    // 编译计数变体，setup设置纹理单元和uniform块（与光线步进程序相同）
+    bool Initialize(const std::function<void(Shader&)>& setup);
+    
+    // 每帧调用一次：到了统计的帧且上一次的回读已取回时返回true，此时已绑定统计目标和计数程序，
+    // 调用方绘制全屏四边形后调用End（之后需重新绑定自己的程序）
+    bool Begin(int screenWidth, int screenHeight);
+    void End(int screenWidth, int screenHeight);
+    
+    // 取回已完成的统计，有新结果时返回true
+    bool Poll(float& samplesPerRay, float& stepsPerRay, int& maxSamplesPerRay);
+    
+private:
+    std::unique_ptr<Shader> countShader;
+    GLuint texture;
+    GLuint fbo;
+    GLuint pbo;
+    GLsync fence;
+    int width, height;
+    int readSize;           // PBO中的像素数
+    int frameCounter;
+    
+    void CreateTarget(int w, int h);
+    void Release();
+};
+
+#endif // RAYSTATISTICS_H
@@ -2,9 +2,23 @@
 #define RENDERER_H
 
 #include "Types.h"
-#include "Shader.h"
+#include "ShaderCache.h"
 #include "VolumeData.h"
 #include "Camera.h"
+#include "AsyncVolumeLoader.h"
+#include "BrickCache.h"
+#include "FrameProfiler.h"
+#include "RayStatistics.h"
+#include "DynamicResolution.h"
+#include "TemporalAccumulation.h"
+#include "FrameCache.h"
+#include "VolumeChannels.h"
+#include "MultiViewRenderer.h"
+#include "ComputeRayMarcher.h"
+#include "ProxyGeometry.h"
+#include "TimeSeriesVolume.h"
+#include "UniformBuffer.h"
+#include "UniformBlocks.h"
 #include <glad/glad.h>
 #include <memory>
 #include <vector>
@@ -29,15 +43,51 @@ public:
     // 更新摄像机
     void SetCamera(const Camera& camera);
     
+    // 丢弃缓存帧和时间累积历史，下一帧从头渲染（如离线渲染切换关键帧时，不混入上一关键帧的重投影历史）
+    void InvalidateFrame();
+    
     // 更新传输函数
     void SetTransferFunction(const std::vector<glm::vec4>& colors);
     
     // 窗口大小变化
     void Resize(int width, int height);
+    int GetWidth() const { return screenWidth; }
+    int GetHeight() const { return screenHeight; }
+    
+    // 批量多视图（缩略图、正交预览、对比网格，见MultiViewRenderer.h）：一次提交把所有视图画入同一张图集，
+    // 体数据、传输函数和渲染参数只绑定/上传一次；使用当前体数据和渲染参数，不做时间累积和动态分辨率，
+    // 不影响窗口画面和缓存帧。图集尺寸不超过GL_MAX_TEXTURE_SIZE，失败返回false
+    bool RenderViews(const std::vector<BatchView>& views, int atlasWidth, int atlasHeight);
+    
+    // 最近一次RenderViews的图集（RGBA8，左下角为原点）
+    GLuint GetMultiViewFramebuffer() const { return multiViewRenderer->GetFramebuffer(); }
+    GLuint GetMultiViewTexture() const { return multiViewRenderer->GetTexture(); }
+    
+    // 为假时画面只写入离屏缓存帧（GetOutputFramebuffer），不复制到窗口（离线渲染）
+    void SetPresentToScreen(bool present) { presentToScreen = present; }
+    
+    // 最终画面所在的帧缓冲（RGBA8，尺寸为当前渲染尺寸）
+    GLuint GetOutputFramebuffer() const { return frameCache->GetFramebuffer(); }
+    
+    // 计算shader光线步进路径是否可用（GL 4.3，RenderParams::enableComputeRayMarching选择）
+    bool SupportsComputeRayMarching() const { return computeRayMarcher != nullptr; }
     
     // 获取渲染统计信息
     RenderStats GetRenderStats() const;
     
+    // 界面等外部绘制的GPU计时（记为GpuPass::Overlay）
+    void BeginOverlayTiming() { frameProfiler->BeginPass(GpuPass::Overlay); }
+    void EndOverlayTiming() { frameProfiler->EndPass(GpuPass::Overlay); }
+    
+    // 把最近若干帧的CPU帧间隔和各阶段GPU时间导出为CSV
+    bool WriteTimingCsv(const std::string& filename) const;
+    
+    // 帧时间和各阶段GPU时间的记录（基准测试按配置清空并读取百分位数）
+    FrameProfiler& GetFrameProfiler() { return *frameProfiler; }
+    
+    // 上一次RenderFrame只呈现了缓存帧且没有进行中的异步加载：画面不会自行变化，主循环可以等待输入事件
+    bool IsIdle() const { return renderStats.cachedFrame && !IsLoadingVolume() && !(timeSeries && timeSeries->IsBusy()); }
+    
     // ========== 辅助接口 ==========
     
     // 获取摄像机控制器（方便外部进行交互）
@@ -46,34 +96,134 @@ public:
     // 加载体数据
     bool LoadVolumeData(const std::string& filename, int width, int height, int depth);
     
+    // 从NRRD/MetaImage文件加载体数据（尺寸、间距、类型由文件头给出）
+    bool LoadVolumeData(const std::string& filename);
+    
+    // 异步加载体数据：后台读取，每帧上传少量切片，完成后替换当前体数据
+    bool LoadVolumeDataAsync(const std::string& filename, int width, int height, int depth);
+    
+    // 是否正在异步加载
+    bool IsLoadingVolume() const { return volumeLoader.GetState() == AsyncVolumeLoader::State::Loading; }
+    
+    // 异步加载进度 [0, 1]
+    float GetLoadProgress() const { return volumeLoader.GetProgress(); }
+    
+    // 以分块核外方式打开体数据：块按需载入显存图集，适用于超过显存容量的数据
+    bool LoadVolumeDataBricked(const std::string& filename, int width, int height, int depth,
+                               uint64_t atlasBudgetBytes = 512ull * 1024 * 1024);
+    
     // 生成测试用程序化体数据
-    bool GenerateTestVolume(int size = 128);
+    bool GenerateTestVolume(int size = 128, const ProceduralParams& params = ProceduralParams());
+    
+    // 打开时变体数据序列（8位原始数据，每步一个文件，见TimeSeriesVolume.h），替换当前体数据
+    // pattern如 "sim_%04d.raw"，ramBudgetBytes限制预取缓冲的内存占用
+    bool LoadTimeSeries(const std::string& pattern, int firstIndex, int stepCount, int width, int height, int depth,
+                        uint64_t ramBudgetBytes = 1024ull * 1024 * 1024);
+    
+    // 当前打开的时间序列（播放控制），未打开时为空
+    TimeSeriesVolume* GetTimeSeries() { return timeSeries.get(); }
+    
+    // 当前体数据（时间序列为当前显示的步，未加载时为空）
+    const VolumeData* GetVolumeData() const { return GetActiveVolume(); }
+    
+    // 设置预计算梯度使用的算子（对之后加载的体数据生效）
+    void SetGradientFilter(GradientFilter filter) { gradientFilter = filter; }
+    
+    // ========== 附加通道（多模态/多通道，见VolumeChannels.h） ==========
+    // 与主体数据在同一次光线步进中采样合成，最多VolumeChannels::MAX_CHANNELS个；
+    // 有启用的通道时关闭宏单元空区域跳跃（宏单元只描述主体数据），分块核外模式下不渲染附加通道
+    
+    // 从NRRD/MetaImage文件加载通道，返回通道索引，失败返回-1
+    int AddChannel(const std::string& filename, const std::vector<glm::vec4>& transferFunction,
+                   const ChannelParams& params = ChannelParams());
+    
+    // 生成程序化通道（用于测试），返回通道索引，失败返回-1
+    int AddProceduralChannel(int size, const ProceduralParams& procedural, const std::vector<glm::vec4>& transferFunction,
+                             const ChannelParams& params = ChannelParams());
+    
+    void RemoveChannel(int index);
+    int GetChannelCount() const { return volumeChannels->GetCount(); }
+    const ChannelParams& GetChannelParams(int index) const { return volumeChannels->GetParams(index); }
+    void SetChannelParams(int index, const ChannelParams& params);
+    void SetChannelTransferFunction(int index, const std::vector<glm::vec4>& colors);
     
 private:
     // 内部渲染状态
     int screenWidth, screenHeight;
     RenderParams renderParams;
     RenderStats renderStats;
+    GradientFilter gradientFilter;
     
     // OpenGL资源
-    std::unique_ptr<Shader> rayMarchingShader;
+    std::unique_ptr<ShaderCache> rayMarchingShaders;
     std::unique_ptr<VolumeData> volumeData;
     std::unique_ptr<CameraController> cameraController;
+    AsyncVolumeLoader volumeLoader;
+    std::unique_ptr<BrickCache> brickCache;
+    std::unique_ptr<TimeSeriesVolume> timeSeries;
+    std::unique_ptr<FrameProfiler> frameProfiler;
+    std::unique_ptr<RayStatistics> rayStatistics;
+    std::unique_ptr<DynamicResolution> dynamicResolution;
+    std::unique_ptr<TemporalAccumulation> temporalAccumulation;
+    std::unique_ptr<FrameCache> frameCache;
+    std::unique_ptr<VolumeChannels> volumeChannels;
+    std::unique_ptr<MultiViewRenderer> multiViewRenderer;
+    std::unique_ptr<ComputeRayMarcher> computeRayMarcher;     // 上下文不支持时为空
+    std::unique_ptr<ProxyGeometry> proxyGeometry;
+    
+    // 每帧状态的std140 uniform缓冲（CameraBlock / RenderBlock / ChannelBlock）
+    UniformBuffer cameraUniformBuffer;
+    UniformBuffer renderUniformBuffer;
+    UniformBuffer channelUniformBuffer;
     
     GLuint transferFunctionTexture;
+    GLuint preIntegrationTexture;
     GLuint quadVAO, quadVBO;
     
+    // 传输函数的CPU副本（用于宏单元分类和预积分）
+    std::vector<glm::vec4> transferFunctionColors;
+    std::vector<glm::vec4> preIntegrationData;
+    
+    // 摄像机运动产生的LOD偏移，静止后逐渐衰减到0
+    float motionLod;
+    static constexpr float MOTION_LOD_RECOVERY_RATE = 2.0f;  // 每秒恢复的层级数
+    
     // 性能计时
     float lastFrameTime;
     float deltaTime;
     int frameCount;
     float fpsTimer;
     
+    // 自上次渲染以来画面内容是否变化（为假且没有仍在收敛的效果时直接呈现缓存帧）
+    bool frameDirty;
+    
+    // 当前特性组合对应的光线投射变体键（计算路径单独记录已请求的键，只在启用时编译）
+    uint64_t rayMarchingVariant;
+    uint64_t computeVariant;
+    
+    // 是否把最终画面复制到窗口
+    bool presentToScreen;
+    
     // 内部方法
     void CreateFullScreenQuad();
     void CreateTransferFunctionTexture();
     void UpdateTransferFunctionTexture(const std::vector<glm::vec4>& colors);
-    void UpdateUniforms();
+    void UpdatePreIntegrationTable();
+    void UpdateMacrocellClassification();
+    void UpdateAsyncLoad();
+    void PresentFrame();
+    int AddChannelVolume(std::unique_ptr<VolumeData> volume, const std::vector<glm::vec4>& transferFunction,
+                         const ChannelParams& params);
+    int GetActiveChannelCount() const;
+    VolumeData* GetActiveVolume() const;
+    void BindVolumeTextures();
+    // 包围盒的边长（按物理尺寸确定比例，最长轴为1，中心在原点）
+    glm::vec3 GetBoxExtent() const;
+    // 本帧是否由代理几何确定光线区间（与宏单元跳跃相同的条件：非分块模式且没有附加通道）
+    bool UseProxyBounds() const;
+    void SelectRayMarchingVariant();
+    // batched为真时为批量多视图写入（不含时间累积和运动LOD，lodScale不含像素张角）
+    void UpdateUniforms(bool batched = false);
 };
 
 #endif // RENDERER_H
@@ -0,0 +1,70 @@
+#ifndef SEQUENCERENDERER_H
+#define SEQUENCERENDERER_H
+
+#include "Renderer.h"
+#include "CameraPath.h"
+#include "ImageWriter.h"
+#include "ThreadPool.h"
+#include <glad/glad.h>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+
+// 离线图像序列设置
+struct SequenceSettings {
+    int width = 1920;
+    int height = 1080;
+    std::string outputPattern = "frame_%05d.png";  // 帧序号用%d或%0Nd表示，扩展名决定格式（.png / .ppm）
+    int samplesPerFrame = 1;                       // 每个关键帧渲染的次数（启用时间累积时在关键帧内收敛）
+};
+
+// 离线渲染摄像机路径上的所有关键帧并写出图像序列
+// 渲染器以任意分辨率渲染到离屏缓存帧（不复制到窗口），读回经PBO_COUNT个PBO组成的环形缓冲异步进行：
+// 第N帧的glReadPixels只提交命令，直到其PBO再次被使用（即N + PBO_COUNT帧）时才等待栅栏并映射，
+// 映射的数据复制后交给线程池并行编码写盘，GPU在此期间继续渲染后续帧，不等待磁盘
+class SequenceRenderer {
+public:
+    static const int PBO_COUNT = 3;
+    
+    explicit SequenceRenderer(Renderer& renderer, ThreadPool& pool = ThreadPool::Shared());
+    ~SequenceRenderer();
+    
+    SequenceRenderer(const SequenceRenderer&) = delete;
+    SequenceRenderer& operator=(const SequenceRenderer&) = delete;
+    
+    // 渲染并写出全部帧，返回前等待所有编码完成；结束后恢复渲染器的尺寸和摄像机
+    // params中的动态分辨率和运动LOD偏移会被关闭（离线渲染没有帧时间预算）；
+    // 时间累积历史在每个关键帧开始时清空，输出帧只由该关键帧的samplesPerFrame次渲染累积而成
+    // progress(已提交的帧数, 总帧数) 在每帧提交后调用
+    bool Render(const CameraPath& path, RenderParams params, const SequenceSettings& settings,
+                const std::function<void(int, int)>& progress = nullptr);
+    
+private:
+    Renderer& renderer;
+    ThreadPool& pool;
+    
+    GLuint pbos[PBO_COUNT];
+    GLsync fences[PBO_COUNT];
+    int slotFrames[PBO_COUNT];      // 各PBO中正在读回的帧序号
+    int width, height;
+    
+    // 线程池中尚未完成的编码任务
+    std::mutex encodeMutex;
+    std::condition_variable encodeCondition;
+    int encodesInFlight;
+    std::atomic<bool> encodeFailed;
+    
+    void CreateBuffers(int w, int h);
+    void ReleaseBuffers();
+    
+    // 把输出帧缓冲异步读回到PBO
+    void BeginReadback(int slot, int frame);
+    // 等待PBO读回完成，复制数据并提交编码任务
+    void FinishReadback(int slot, const std::string& pattern, ImageWriter::Format format);
+    // 等待直到进行中的编码任务不超过maxInFlight个
+    void WaitForEncodes(int maxInFlight);
+};
+
+#endif // SEQUENCERENDERER_H
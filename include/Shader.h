@@ -2,6 +2,7 @@
 #define SHADER_H
 
 #include <string>
+#include <unordered_map>
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
@@ -12,25 +13,60 @@ public:
     Shader();
     ~Shader();
     
-    // 从文件加载并编译shader
-    bool LoadFromFile(const std::string& vertexPath, const std::string& fragmentPath);
+    // 从文件加载并编译shader（同步）
+    // defines为预处理定义（如"#define FEATURE_LIGHTING 1"，多行以换行分隔），插入到#version之后
+    bool LoadFromFile(const std::string& vertexPath, const std::string& fragmentPath, const std::string& defines = "");
+    
+    // 异步构建：只提交编译和链接命令，不查询结果，驱动可以在后台线程编译
+    bool BeginLoadFromFile(const std::string& vertexPath, const std::string& fragmentPath,
+                           const std::string& defines = "");
+    
+    // 计算shader程序（同步/异步）：源文件的#version行替换为430，片段shader的源文件可由defines选择计算入口后共用
+    bool LoadComputeFromFile(const std::string& computePath, const std::string& defines = "");
+    bool BeginLoadComputeFromFile(const std::string& computePath, const std::string& defines = "");
+    
+    // 异步构建是否已完成：支持并行编译扩展时不阻塞地查询，否则总是返回true（此时FinishLoad可能等待编译）
+    bool IsLinkComplete() const;
+    
+    // 查询编译/链接结果并缓存uniform位置，失败时返回false
+    bool FinishLoad();
+    
+    // 驱动是否支持GL_KHR/ARB_parallel_shader_compile（可不阻塞地查询编译是否完成）
+    static bool SupportsParallelCompile();
     
     // 使用shader程序
     void Use() const;
     
-    // Uniform工具函数
+    // 链接时缓存的uniform位置（不存在或未被使用的uniform返回-1，对其赋值不产生效果）
+    GLint GetUniformLocation(const std::string& name) const;
+    
+    // 把uniform块绑定到指定绑定点（块未被使用时忽略）
+    void BindUniformBlock(const std::string& blockName, GLuint binding) const;
+    
+    // Uniform工具函数（按名称查缓存，不再调用glGetUniformLocation）
     void SetBool(const std::string& name, bool value) const;
     void SetInt(const std::string& name, int value) const;
     void SetFloat(const std::string& name, float value) const;
+    void SetVec2(const std::string& name, const glm::vec2& value) const;
     void SetVec3(const std::string& name, const glm::vec3& value) const;
     void SetVec4(const std::string& name, const glm::vec4& value) const;
     void SetMat4(const std::string& name, const glm::mat4& mat) const;
     
 private:
-    // 编译shader
-    bool CompileShader(const std::string& source, GLenum type, GLuint& shader);
-    // 链接程序
-    bool LinkProgram(GLuint vertexShader, GLuint fragmentShader);
+    // 名称 -> 位置（数组uniform同时以"name"和"name[0]"登记）
+    std::unordered_map<std::string, GLint> uniformLocations;
+    
+    // 异步构建中尚未删除的着色器对象
+    GLuint pendingVertexShader;
+    GLuint pendingFragmentShader;
+    GLuint pendingComputeShader;
+    
+    // 提交编译（不检查结果）
+    GLuint CompileShader(const std::string& source, GLenum type);
+    // 提交链接（不检查结果），为0的着色器对象不附加
+    void LinkProgram(GLuint vertexShader, GLuint fragmentShader, GLuint computeShader = 0);
+    // 链接成功后查询所有活动uniform的位置
+    void CacheUniformLocations();
     // 检查编译/链接错误
     void CheckCompileErrors(GLuint shader, const std::string& type);
 };
@@ -0,0 +1,78 @@
+#ifndef SHADERCACHE_H
+#define SHADERCACHE_H
+
+#include "Shader.h"
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+// 同一对shader文件的编译期特化变体缓存：
+// 变体以64位键标识，由调用方给出对应的预处理定义；首次请求时在后台编译（只提交命令，不阻塞渲染线程），
+// 完成之前返回通用程序（不带定义编译，运行时读取uniform），完成后切换到变体
+// 同一时刻只编译一个变体，编译期间的新请求只保留最新一个（如拖动滑块时不会堆积）；变体数超过上限时淘汰最久未用的
+// 限制：只有驱动支持GL_KHR/ARB_parallel_shader_compile时才编译变体。没有该扩展时无法不阻塞地得知编译是否完成，
+// 查询GL_COMPILE_STATUS/GL_LINK_STATUS会让渲染线程等待编译（可达数百毫秒），因此始终使用通用程序；
+// 要在这类驱动上使用变体需在共享上下文的工作线程中编译，目前未实现
+class ShaderCache {
+public:
+    // 缓存的变体数上限
+    static const int MAX_VARIANTS = 16;
+    
+    // 每个程序链接后调用一次（设置纹理单元、绑定uniform块等）
+    using SetupFunction = std::function<void(Shader&)>;
+    
+    ShaderCache(const std::string& vertexPath, const std::string& fragmentPath, SetupFunction setup);
+    
+    // 计算shader程序的变体缓存：baseDefines加在每个程序（含通用程序）的定义之前
+    static std::unique_ptr<ShaderCache> CreateCompute(const std::string& computePath, const std::string& baseDefines,
+                                                      SetupFunction setup);
+    
+    // 同步编译通用程序（需在GL线程调用）
+    bool Initialize();
+    
+    // 请求变体：未缓存且未在编译时排队后台编译（驱动不支持并行编译扩展时忽略）
+    void Request(uint64_t key, const std::string& defines);
+    
+    // 键对应的变体已就绪时返回变体，否则返回通用程序
+    Shader& Get(uint64_t key);
+    
+    // 每帧调用：检查正在编译的变体，完成后开始编译排队的变体
+    void Update();
+    
+    bool IsReady(uint64_t key) const { return variants.count(key) != 0; }
+    int GetVariantCount() const { return (int)variants.size(); }
+    
+private:
+    struct Variant {
+        std::unique_ptr<Shader> shader;
+        uint64_t lastUsedFrame;
+    };
+    
+    std::string vertexPath;
+    std::string fragmentPath;           // 计算shader缓存中为计算shader源文件
+    bool compute;
+    std::string baseDefines;
+    SetupFunction setup;
+    std::unique_ptr<Shader> generic;
+    std::unordered_map<uint64_t, Variant> variants;
+    std::unordered_set<uint64_t> failedKeys;    // 编译失败的变体不再重试
+    uint64_t frameIndex;
+    
+    // 正在后台编译的变体
+    std::unique_ptr<Shader> building;
+    uint64_t buildingKey;
+    
+    // 排队的变体（只保留最新一个）
+    bool hasQueued;
+    uint64_t queuedKey;
+    std::string queuedDefines;
+    
+    bool BeginLoad(Shader& shader, const std::string& defines) const;
+    void StartBuild(uint64_t key, const std::string& defines);
+    void EvictLeastRecentlyUsed();
+};
+
+#endif // SHADERCACHE_H
@@ -0,0 +1,56 @@
+#ifndef TEMPORALACCUMULATION_H
+#define TEMPORALACCUMULATION_H
+
+#include "Shader.h"
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <memory>
+
+// 时间累积：把每帧抖动采样的结果与重投影的历史帧混合
+// 摄像机静止时逐帧求平均，画面逐步收敛；运动时用上一帧的视图/投影矩阵重投影历史，
+// 并把历史颜色限制在当前帧3x3邻域的颜色范围内，拒绝遮挡变化造成的拖影
+// 历史纹理（RGBA16F，rgb = 累积颜色，a = 已累积帧数）按窗口尺寸分配两张交替读写，
+// 与动态分辨率一样只使用左下角的渲染尺寸子区域，缩放变化时历史按uv重采样，不需要清空
+class TemporalAccumulation {
+public:
+    // 运动时当前帧的最小权重（约等于保留最近10帧）
+    static constexpr float MOVING_BLEND = 0.1f;
+    
+    TemporalAccumulation();
+    ~TemporalAccumulation();
+    
+    // 加载混合shader并绑定CameraBlock（需在GL线程调用）
+    bool Initialize();
+    
+    // 丢弃历史（参数、传输函数或体数据变化后调用）
+    void Invalidate() { historyValid = false; }
+    
+    // 本帧的抖动序列偏移 [0, 1)：按黄金分割数列递增，每个像素的步进起点在连续帧间分层分布
+    float GetJitterOffset() const;
+    
+    // 混合本帧结果（currentTexture左下角renderSize子区域，rgb = 颜色，a = 代表深度）与历史，
+    // 返回写入的历史纹理（同样使用左下角renderSize子区域）；调用方需已绑定全屏四边形VAO和本帧的CameraBlock
+    // sceneStable为假时（如LOD仍在收敛）即使摄像机静止也按运动处理
+    GLuint Resolve(GLuint currentTexture, glm::ivec2 renderSize, int screenWidth, int screenHeight,
+                   const glm::mat4& view, const glm::mat4& projection, bool sceneStable, int maxSamples);
+    
+    // 最近一次混合后历史中的帧数（运动时约为 1 / MOVING_BLEND）
+    int GetSampleCount() const { return sampleCount; }
+
+private:
+    std::unique_ptr<Shader> resolveShader;
+    GLuint historyTextures[2];
+    GLuint framebuffers[2];
+    int historyIndex;                   // 最近写入的历史纹理
+    int targetWidth, targetHeight;      // 历史纹理尺寸
+    glm::ivec2 historySize;             // 最近写入的历史子区域尺寸
+    glm::mat4 previousViewProjection;
+    bool historyValid;
+    int sampleCount;
+    unsigned int frameIndex;
+    
+    void CreateTargets(int width, int height);
+    void Release();
+};
+
+#endif // TEMPORALACCUMULATION_H
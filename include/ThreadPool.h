@@ -0,0 +1,55 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// 工作窃取线程池：每个工作线程有自己的任务队列，空闲时从其他队列尾部窃取任务
+class ThreadPool {
+public:
+    // threadCount <= 0 时使用硬件并发数
+    explicit ThreadPool(int threadCount = 0);
+    ~ThreadPool();
+    
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    
+    // 提交一个任务
+    void Submit(std::function<void()> task);
+    
+    // 并行执行 body(i)，i ∈ [begin, end)，调用线程也参与执行，全部完成后返回
+    void ParallelFor(int begin, int end, const std::function<void(int)>& body);
+    
+    // 获取工作线程数
+    int GetThreadCount() const { return (int)threads.size(); }
+    
+    // 进程内共享的线程池
+    static ThreadPool& Shared();
+    
+private:
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+    
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::vector<std::thread> threads;
+    
+    std::mutex wakeMutex;
+    std::condition_variable wakeCondition;
+    std::atomic<int> pendingTasks;
+    std::atomic<unsigned> nextQueue;
+    std::atomic<bool> stopping;
+    
+    // 先从自己的队列头部取任务，失败则从其他队列尾部窃取
+    bool PopTask(int queueIndex, std::function<void()>& task);
+    void WorkerLoop(int index);
+};
+
+#endif // THREADPOOL_H
@@ -0,0 +1,153 @@
+#ifndef TIMESERIESVOLUME_H
+#define TIMESERIESVOLUME_H
+
+#include "VolumeData.h"
+#include <glad/glad.h>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 时变（4D）体数据播放：每个时间步为一个同尺寸的8位原始数据文件
+// I/O线程按播放位置向前预取，读取并预计算梯度后放入内存环形缓冲（槽位数由内存预算决定，与序列长度无关）；
+// GL线程每帧通过PBO把就绪的步分块上传到预先分配的纹理池（尺寸不变，不重新分配），上传完成后再切换显示
+// 播放时钟按目标速率推进：允许丢帧时I/O跟不上的步被跳过，否则时钟等待下一步就绪
+// 时间步只有原始分辨率层（无LOD金字塔），宏单元网格由I/O线程计算，空区域跳跃照常工作
+class TimeSeriesVolume {
+public:
+    // 纹理池大小（显示中、待显示、上传中）
+    static const int TEXTURE_POOL_SIZE = 3;
+    // PBO数量与每个上传块的目标大小（字节），实际为整数个切片
+    static const int PBO_COUNT = 3;
+    static const uint64_t CHUNK_BYTES = 4ull * 1024 * 1024;
+    // 内存环形缓冲的槽位数上下限
+    static const int MIN_RING_SLOTS = 2;
+    static const int MAX_RING_SLOTS = 64;
+    // 预取线程数
+    static const int IO_THREADS = 2;
+    
+    TimeSeriesVolume();
+    ~TimeSeriesVolume();
+    
+    TimeSeriesVolume(const TimeSeriesVolume&) = delete;
+    TimeSeriesVolume& operator=(const TimeSeriesVolume&) = delete;
+    
+    // 打开序列（需在GL线程调用）：pattern为含一个%d或%0Nd的文件名模式（如 "sim_%04d.raw"），
+    // 第i步的文件序号为firstIndex + i；ramBudgetBytes限制环形缓冲占用的内存
+    bool Open(const std::string& pattern, int firstIndex, int stepCount, int width, int height, int depth,
+              GradientFilter filter, uint64_t ramBudgetBytes = 1024ull * 1024 * 1024);
+    
+    // 停止预取并释放纹理池和缓冲
+    void Close();
+    
+    // 每帧在GL线程调用：推进播放时钟，最多上传chunksPerFrame个块，必要时切换显示的步
+    // 返回显示的体数据是否变化
+    bool Update(float deltaTime, int chunksPerFrame = 4);
+    
+    // 当前显示的时间步（第一步上传完成前为空）
+    VolumeData* GetCurrentFrame() const;
+    
+    // ========== 播放控制 ==========
+    void SetPlaying(bool play) { playing = play; }
+    bool IsPlaying() const { return playing; }
+    void SetRate(float stepsPerSecond) { rate = stepsPerSecond; }
+    float GetRate() const { return rate; }
+    void SetLoop(bool enable) { loop = enable; }
+    bool GetLoop() const { return loop; }
+    // 允许丢帧：时钟按墙钟推进，跟不上的步被跳过；否则时钟最多领先显示一步
+    void SetDropFrames(bool enable) { dropFrames = enable; }
+    bool GetDropFrames() const { return dropFrames; }
+    // 跳转到第step步（当前帧保持显示直到该步就绪）
+    void Seek(int step);
+    
+    // ========== 状态 ==========
+    bool IsOpen() const { return stepCount > 0; }
+    int GetStepCount() const { return stepCount; }
+    int GetCurrentStep() const;
+    // 播放时钟指向的步
+    int GetTargetStep() const;
+    // 因I/O或上传跟不上而跳过的步数
+    int GetDroppedSteps() const { return droppedSteps; }
+    // 环形缓冲中播放位置之后已就绪的连续步数与槽位数
+    int GetBufferedSteps() const;
+    int GetRingSlotCount() const { return (int)slots.size(); }
+    // 仍有需要处理的工作（播放中、当前目标尚未显示），主循环不应进入空闲等待
+    bool IsBusy() const;
+
+private:
+    enum class SlotState {
+        Empty,
+        Loading,        // I/O线程正在填充
+        Ready,
+        Uploading,      // GL线程正在从该槽位上传
+        Failed
+    };
+    
+    // 环形缓冲槽位：播放序列位置p（不回绕，循环播放时持续增加）存放在槽位 p % 槽位数
+    struct Slot {
+        SlotState state = SlotState::Empty;
+        int64_t position = -1;
+        std::vector<unsigned char> packed;          // RGBA8打包体素（预先分配）
+        std::vector<float> macrocellMinMax;
+    };
+    
+    // 纹理池项
+    struct PoolEntry {
+        std::unique_ptr<VolumeData> volume;
+        int64_t position = -1;          // 已上传的序列位置（-1 = 空）
+    };
+    
+    std::string pattern;
+    int firstIndex;
+    int stepCount;
+    int width, height, depth;
+    GradientFilter gradientFilter;
+    
+    // 播放时钟（单位为步，不回绕）与显示状态
+    double clock;
+    bool playing;
+    float rate;
+    bool loop;
+    bool dropFrames;
+    int64_t displayedPosition;          // 当前显示的序列位置（-1 = 尚无）
+    int64_t skippedPosition;            // 读取失败而越过的最后一个位置
+    int displayedEntry;
+    int droppedSteps;
+    
+    // 环形缓冲与预取线程（slots的内容和target由mutex保护）
+    std::vector<Slot> slots;
+    std::vector<std::thread> workers;
+    mutable std::mutex mutex;
+    std::condition_variable condition;
+    int64_t target;                     // 预取窗口 [target, targetEnd)
+    int64_t targetEnd;
+    bool stopRequested;
+    
+    // 纹理池与分块上传
+    PoolEntry pool[TEXTURE_POOL_SIZE];
+    GLuint pbos[PBO_COUNT];
+    GLsync fences[PBO_COUNT];
+    int nextPbo;
+    int uploadEntry;                    // 上传中的纹理池项（-1 = 无）
+    int uploadSlot;
+    int64_t uploadPosition;
+    int uploadedSlices;
+    int slicesPerChunk;
+    
+    int64_t GetTargetPosition() const { return (int64_t)clock; }
+    int64_t GetWindowEnd(int64_t start) const;
+    int PositionToStep(int64_t position) const { return (int)(position % stepCount); }
+    
+    void WorkerMain();
+    bool LoadStep(int step, Slot& slot) const;
+    void StartUpload(int64_t windowEnd);
+    bool ContinueUpload(int chunksPerFrame);
+    void CancelUpload();
+    bool SelectDisplayed();
+    void ReleaseGLResources();
+};
+
+#endif // TIMESERIESVOLUME_H
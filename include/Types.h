@@ -15,6 +15,31 @@ struct RenderParams {
     glm::vec3 lightDir = glm::vec3(0.0f, 1.0f, 0.0f);  // 光照方向
     int maxSteps = 256;               // 最大步进次数
     bool enableJittering = true;      // 抖动采样优化
+    bool enableEmptySpaceSkipping = true;  // 宏单元空区域跳跃
+    bool enablePreIntegration = true; // 预积分传输函数（按片段而非逐点合成，可用更大步长）
+    bool enableLod = true;            // 按距离/像素覆盖选择LOD层级
+    float lodBias = 0.0f;             // LOD层级偏移（正值更粗）
+    float motionLodBias = 1.0f;       // 摄像机运动时额外的LOD偏移
+    float windowWidth = 1.0f;         // 窗宽（归一化到数据值域）
+    float windowCenter = 0.5f;        // 窗位（归一化到数据值域）
+    bool enableDynamicResolution = true;  // 按GPU时间调整光线步进的渲染分辨率
+    float targetFrameTimeMs = 16.0f;  // 动态分辨率的目标GPU帧时间
+    float minResolutionScale = 0.25f; // 动态分辨率的最小缩放比例
+    bool enableTemporalAccumulation = true;  // 抖动帧的时间累积（静止时逐步收敛，运动时重投影历史）
+    int temporalMaxSamples = 64;      // 静止时最多累积的帧数
+    bool enableComputeRayMarching = false;  // 计算shader光线步进（需GL 4.3，不支持时使用片段路径）
+    bool enableProxyGeometry = true;  // 由非空宏单元的代理几何确定光线起止（分块模式和有附加通道时不使用）
+};
+
+// 附加通道参数（见VolumeChannels.h）
+// 通道的包围盒按自身物理尺寸确定比例（最长轴为1，中心在原点），先缩放、再按XYZ欧拉角旋转、最后平移到世界空间
+struct ChannelParams {
+    bool enabled = true;
+    glm::vec3 translation = glm::vec3(0.0f);
+    glm::vec3 rotation = glm::vec3(0.0f);   // 欧拉角（度）
+    float scale = 1.0f;
+    float density = 1.0f;             // 密度系数
+    float threshold = 0.1f;           // 阈值
 };
 
 // 摄像机结构体
@@ -37,11 +62,50 @@ struct Camera {
     float mouseSensitivity = 0.1f;
 };
 
+// 批量多视图中的一个视图（见MultiViewRenderer.h）：摄像机的宽高比由视口决定，aspectRatio不使用
+struct BatchView {
+    Camera camera;
+    glm::ivec4 viewport = glm::ivec4(0, 0, 128, 128);   // 图集中的像素矩形 (x, y, 宽, 高)，原点在左下角
+};
+
+// 分别计时的GPU阶段（顺序即提交顺序）
+enum class GpuPass {
+    Upload,         // 异步加载与分块缓存的纹理上传
+    Proxy,          // 代理几何的入口/出口距离
+    Feedback,       // 分块缓存反馈pass
+    RayMarch,       // 光线步进
+    Temporal,       // 时间累积
+    Present,        // 上采样、写入缓存帧并复制到窗口
+    Overlay,        // 界面绘制
+    Count
+};
+
+// 滚动窗口内的百分位数（毫秒）
+struct TimingPercentiles {
+    float p50 = 0.0f;
+    float p95 = 0.0f;
+    float p99 = 0.0f;
+};
+
 // 渲染统计信息
 struct RenderStats {
     float fps = 0.0f;
     float frameTimeMs = 0.0f;
     int triangleCount = 0;
+    int residentBricks = 0;           // 分块缓存中驻留的块数
+    float gpuTimeMs = 0.0f;           // 光线步进与上采样的GPU时间（若干帧之前的测量值）
+    float resolutionScale = 1.0f;     // 当前渲染分辨率缩放比例
+    int accumulatedFrames = 0;        // 时间累积历史中的帧数（未启用时为0）
+    bool cachedFrame = false;         // 本帧画面未变化，直接呈现了缓存的上一帧
+    bool specializedShader = false;   // 使用的是当前特性组合的特化变体（否则为通用程序）
+    int shaderVariants = 0;           // 已缓存的特化变体数
+    bool computeRayMarching = false;  // 本帧光线步进使用了计算shader路径
+    int proxyTriangles = 0;           // 本帧代理几何的三角形数（未使用代理几何时为0）
+    TimingPercentiles frameTime;      // CPU帧间隔的滚动百分位数
+    TimingPercentiles passTime[(int)GpuPass::Count];  // 各阶段GPU时间的滚动百分位数
+    float samplesPerRay = 0.0f;       // 命中包围盒的光线平均采样数（低分辨率统计pass，定期更新）
+    float stepsPerRay = 0.0f;         // 命中包围盒的光线平均步数（含空区域跳跃跨过的步数）
+    int maxSamplesPerRay = 0;         // 单条光线的最大采样数
 };
 
 // 传输函数颜色点
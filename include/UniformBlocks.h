@@ -0,0 +1,82 @@
+#ifndef UNIFORMBLOCKS_H
+#define UNIFORMBLOCKS_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+// 与shader中std140 uniform块逐字节对应的CPU端结构（字段顺序、类型需与GLSL声明一致）
+// std140中vec3按16字节对齐，因此每个vec3后紧跟一个标量占满16字节；bool占4字节，CPU端用GLint
+
+// uniform块绑定点
+const GLuint CAMERA_BLOCK_BINDING = 0;
+const GLuint RENDER_BLOCK_BINDING = 1;
+const GLuint CHANNEL_BLOCK_BINDING = 2;
+const GLuint VIEW_BLOCK_BINDING = 3;
+
+// CameraBlock：摄像机（光线步进与时间累积共用）
+struct CameraUniforms {
+    glm::mat4 invView;
+    glm::mat4 invProjection;
+    glm::vec3 cameraPos;
+    float time;                       // 秒（用于逐帧随机抖动）
+};
+
+// RenderBlock：渲染参数以及由体数据推导出的每帧状态（含义见raymarching.frag）
+struct RenderUniforms {
+    glm::vec3 lightDir;
+    float stepSize;
+    glm::vec3 macrocellGridScale;
+    float density;
+    glm::vec3 gradientScale;
+    float threshold;
+    glm::vec3 volumeSize;
+    float absorptionCoeff;
+    glm::vec3 brickGridSize;
+    float scatteringCoeff;
+    glm::vec3 atlasSize;
+    float windowScale;
+    glm::vec3 boxMin;
+    float windowOffset;
+    glm::vec3 boxMax;
+    float nativeDensityScale;
+    float nativeDensityOffset;
+    float lodScale;
+    float lodBias;
+    float maxLod;
+    float jitterSequence;
+    GLint maxSteps;
+    GLint enableLighting;
+    GLint enableJittering;
+    GLint enableEmptySpaceSkipping;
+    GLint usePreIntegration;
+    GLint useNativeDensity;
+    GLint useBrickCache;
+    GLint outputDepth;
+    GLint useProxyBounds;
+    glm::vec2 proxyBoundsScale;       // std140中vec2按8字节对齐，正好位于偏移184
+};
+
+// ChannelBlock：附加通道（见VolumeChannels.h），只有前channelCount项有效
+struct ChannelUniforms {
+    glm::mat4 worldToTexture[3];      // 世界坐标 -> 通道纹理坐标 [0,1]
+    glm::vec4 params[3];              // x = 密度系数，y = 阈值
+    glm::vec4 volumeSize[3];          // xyz = 体素数
+    GLint channelCount;
+    GLint padding[3];
+};
+
+// ViewBlock中的一项：批量多视图（见MultiViewRenderer.h）中一个视图的摄像机和图集矩形，按实例索引读取
+struct ViewUniforms {
+    glm::mat4 invView;
+    glm::mat4 invProjection;
+    glm::vec3 cameraPos;
+    float pixelAngle;                 // 单位距离处一个像素的张角（与RenderBlock中的lodScale相乘得到该视图的LOD比例）
+    glm::vec4 viewport;               // 图集中的NDC矩形 (x0, y0, x1, y1)
+};
+
+static_assert(sizeof(CameraUniforms) == 144, "CameraUniforms must match the std140 layout of CameraBlock");
+static_assert(sizeof(RenderUniforms) == 192, "RenderUniforms must match the std140 layout of RenderBlock");
+static_assert(sizeof(ChannelUniforms) == 304, "ChannelUniforms must match the std140 layout of ChannelBlock");
+static_assert(sizeof(ViewUniforms) == 160, "ViewUniforms must match the std140 layout of ViewData");
+
+#endif // UNIFORMBLOCKS_H
@@ -0,0 +1,42 @@
+#ifndef UNIFORMBUFFER_H
+#define UNIFORMBUFFER_H
+
+#include <glad/glad.h>
+
+// std140 uniform缓冲：每帧写入一份块数据，存储区按帧环形轮换（多重缓冲），
+// 写入的区域在GPU读取完之前不会被覆盖，CPU不需要等待驱动同步
+// GL 4.4可用时使用持久映射（glBufferStorage + MAP_PERSISTENT | MAP_COHERENT），只映射一次并直接memcpy；
+// 否则退化为对已确认空闲的区域做非同步映射写入
+class UniformBuffer {
+public:
+    // 环形区域数（允许GPU落后CPU的最大帧数）
+    static const int REGION_COUNT = 3;
+    
+    UniformBuffer();
+    ~UniformBuffer();
+    
+    UniformBuffer(const UniformBuffer&) = delete;
+    UniformBuffer& operator=(const UniformBuffer&) = delete;
+    
+    // 分配缓冲（需在GL线程调用），blockSize为一份块数据的字节数
+    bool Create(GLsizeiptr blockSize);
+    
+    // 切换到下一个区域、写入data（blockSize字节）并绑定到binding点
+    // 上一个区域此时已提交的绘制命令之后插入栅栏，区域被再次使用前才检查（通常早已完成，不会等待）
+    void Update(const void* data, GLuint binding);
+    
+    // 是否使用持久映射
+    bool IsPersistent() const { return mapped != nullptr; }
+    
+private:
+    GLuint buffer;
+    GLsizeiptr blockSize;
+    GLsizeiptr regionStride;            // 按GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT对齐的区域间距
+    unsigned char* mapped;              // 持久映射的起始地址（未使用持久映射时为空）
+    GLsync fences[REGION_COUNT];
+    int region;                         // 最近写入的区域（-1 = 尚未写入）
+    
+    void Release();
+};
+
+#endif // UNIFORMBUFFER_H
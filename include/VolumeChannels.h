@@ -0,0 +1,67 @@
+#ifndef VOLUMECHANNELS_H
+#define VOLUMECHANNELS_H
+
+#include "Types.h"
+#include "VolumeData.h"
+#include "UniformBlocks.h"
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <memory>
+#include <vector>
+
+// 附加通道：与主体数据一起在同一个光线步进循环中采样和合成的体数据（多模态如CT + PET，或多个荧光通道）
+// 每个通道有自己的3D纹理、1D传输函数和变换；各通道的包围盒区间与主体数据的区间合并为一次遍历，
+// 每个采样点上各通道的消光按光学厚度相加，共用一次前向合成和提前终止
+// 通道纹理只使用原始分辨率层（无LOD、宏单元跳跃和预积分）
+class VolumeChannels {
+public:
+    // 最多附加的通道数（shader中的纹理单元和ChannelBlock数组长度与之对应）
+    static const int MAX_CHANNELS = 3;
+    
+    // 第i个启用通道的体数据/传输函数纹理单元为 FIRST_VOLUME_UNIT + i / FIRST_TRANSFER_FUNCTION_UNIT + i
+    static const GLuint FIRST_VOLUME_UNIT = 7;
+    static const GLuint FIRST_TRANSFER_FUNCTION_UNIT = 10;
+    
+    VolumeChannels();
+    ~VolumeChannels();
+    
+    VolumeChannels(const VolumeChannels&) = delete;
+    VolumeChannels& operator=(const VolumeChannels&) = delete;
+    
+    // 添加已加载的体数据为新通道（需在GL线程调用），返回通道索引，已满时返回-1
+    int Add(std::unique_ptr<VolumeData> volume, const std::vector<glm::vec4>& transferFunction,
+            const ChannelParams& params = ChannelParams());
+    
+    // 移除通道，之后的通道索引前移
+    void Remove(int index);
+    void Clear();
+    
+    int GetCount() const { return (int)channels.size(); }
+    
+    // 参与渲染（已启用）的通道数
+    int GetActiveCount() const;
+    
+    // 通道参数与传输函数（设置时索引越界则忽略）
+    const ChannelParams& GetParams(int index) const { return channels[index].params; }
+    void SetParams(int index, const ChannelParams& params);
+    void SetTransferFunction(int index, const std::vector<glm::vec4>& colors);
+    const VolumeData& GetVolume(int index) const { return *channels[index].volume; }
+    
+    // 把启用的通道依次绑定到各自的纹理单元
+    void Bind() const;
+    
+    // 填写ChannelBlock：启用通道的世界 -> 纹理坐标变换、密度/阈值和体素数
+    void FillUniforms(ChannelUniforms& uniforms) const;
+
+private:
+    struct Channel {
+        std::unique_ptr<VolumeData> volume;
+        GLuint transferFunctionTexture;
+        ChannelParams params;
+    };
+    std::vector<Channel> channels;
+    
+    static void ReleaseChannel(Channel& channel);
+};
+
+#endif // VOLUMECHANNELS_H
@@ -0,0 +1,76 @@
+#ifndef VOLUMECONTAINER_H
+#define VOLUMECONTAINER_H
+
+#include "VolumeHeader.h"
+#include "MappedFile.h"
+#include "ThreadPool.h"
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 分块压缩体数据容器（.vcz）
+// 布局：文件头 | 块索引（每块偏移 + 压缩大小 + 编码） | 各块压缩数据
+// 每块（默认64³，边缘块截断）独立用LZCodec压缩、块内x最快存储，
+// 因此可以按块并行解压，也可以只读取与子区域相交的块；文件头同时记录整个体积的值域
+class VolumeContainer {
+public:
+    static const int DEFAULT_CHUNK_SIZE = 64;
+    
+    // 块编码
+    enum ChunkCodec : uint32_t {
+        CODEC_STORED = 0,   // 未压缩（压缩后不变小时使用）
+        CODEC_LZ = 1,
+        CODEC_DELTA_SHUFFLE_LZ = 2  // 行内沿x差分并按字节拆成平面后再LZ压缩（平滑的多字节数据压缩率更高）
+    };
+    
+    VolumeContainer() = default;
+    ~VolumeContainer() = default;
+    
+    // 映射文件并读取文件头和块索引（不读取块数据）
+    bool Open(const std::string& filename);
+    void Close();
+    
+    int GetWidth() const { return info.width; }
+    int GetHeight() const { return info.height; }
+    int GetDepth() const { return info.depth; }
+    int GetChunkSize() const { return chunkSize; }
+    VoxelType GetVoxelType() const { return info.type; }
+    glm::vec3 GetSpacing() const { return info.spacing; }
+    bool IsBigEndian() const { return info.bigEndian; }
+    
+    // 整个体积有限值的范围（版本1的文件没有记录，此时HasValueRange为假）
+    bool HasValueRange() const { return hasValueRange; }
+    glm::vec2 GetValueRange() const { return valueRange; }
+    
+    // 并行解压[origin, origin+size)区域到dst（x最快的紧凑布局，每体素GetVoxelSize字节）
+    // 只访问与区域相交的块
+    bool ReadRegion(const glm::ivec3& origin, const glm::ivec3& size, unsigned char* dst,
+                    ThreadPool& pool = ThreadPool::Shared()) const;
+    
+    // 将完整体数据（x最快）按块并行压缩后写出，每块取直接LZ与差分+拆分字节后LZ中较小的一种；
+    // bigEndian记录源数据的字节序，读取时据此转换
+    static bool Write(const std::string& filename, const unsigned char* data, int width, int height, int depth,
+                      VoxelType type, const glm::vec3& spacing, bool bigEndian,
+                      int chunkSize = DEFAULT_CHUNK_SIZE, ThreadPool& pool = ThreadPool::Shared());
+    
+    // 是否为容器文件扩展名
+    static bool IsContainerFile(const std::string& filename);
+
+private:
+    struct ChunkEntry {
+        uint64_t offset;
+        uint32_t compressedSize;
+        uint32_t codec;
+    };
+    
+    MappedFile file;
+    VolumeFileInfo info;
+    int chunkSize = DEFAULT_CHUNK_SIZE;
+    glm::ivec3 chunkGrid = glm::ivec3(0);
+    std::vector<ChunkEntry> chunks;
+    bool hasValueRange = false;
+    glm::vec2 valueRange = glm::vec2(0.0f);
+};
+
+#endif // VOLUMECONTAINER_H
@@ -1,25 +1,101 @@
 #ifndef VOLUMEDATA_H
 #define VOLUMEDATA_H
 
+#include "VolumeGradient.h"
+#include "VolumeHeader.h"
+#include "MappedFile.h"
+#include "ProceduralVolume.h"
 #include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <functional>
 #include <string>
 #include <vector>
 
 // 体数据类，负责加载和管理3D纹理
+// 纹理为RGBA8打包格式：rgb为预计算梯度，a为密度（见VolumeGradient.h）
+// 16位/浮点数据的梯度由原生值计算，a通道为按数据值域归一化的8位值，另有原生精度的单通道密度纹理
 class VolumeData {
 public:
+    // 宏单元（macrocell）边长，单位为体素
+    static const int MACROCELL_SIZE = 16;
+    
+    // LOD金字塔最大层数（含原始分辨率层）
+    static const int MAX_LOD_LEVELS = 6;
+    
     VolumeData();
     ~VolumeData();
     
     // 从原始数据文件加载体数据
     bool LoadFromFile(const std::string& filename, int width, int height, int depth);
     
-    // 生成程序化体数据（用于测试）
-    bool GenerateProceduralData(int width, int height, int depth);
+    // 从NRRD/MetaImage文件或分块压缩容器（.vcz）加载，尺寸、间距、字节序和体素类型由文件头给出
+    bool LoadFromFile(const std::string& filename);
+    
+    // 从分块压缩容器加载，regionSize非零时只加载[regionOrigin, regionOrigin+regionSize)子区域
+    bool LoadFromContainer(const std::string& filename, const glm::ivec3& regionOrigin = glm::ivec3(0),
+                           const glm::ivec3& regionSize = glm::ivec3(0));
+    
+    // 生成程序化体数据（用于测试和基准），默认参数为fBm云团
+    bool GenerateProceduralData(int width, int height, int depth, const ProceduralParams& params = ProceduralParams());
+    
+    // 设置梯度算子（需在加载/生成之前设置）
+    void SetGradientFilter(GradientFilter filter) { gradientFilter = filter; }
+    
+    // ========== 分块上传接口（供异步加载使用） ==========
+    // 分配纹理存储并重置宏单元网格（需在GL线程调用），maxLodLevels限制LOD层数
+    bool BeginUpload(int width, int height, int depth, int maxLodLevels = MAX_LOD_LEVELS);
+    
+    // 上传第level层LOD中[zBegin, zEnd)范围的打包切片；绑定了GL_PIXEL_UNPACK_BUFFER时packed为缓冲区偏移
+    void UploadSlices(int zBegin, int zEnd, const void* packed, int level = 0);
+    
+    // 按切片范围累积宏单元最小/最大值（不涉及GL，可在工作线程调用）；data为当前体素类型（主机字节序），指向第dataZ个切片
+    void AccumulateMacrocells(const unsigned char* data, int zBegin, int zEnd, int dataZ = 0);
+    
+    // 按切片范围累积第1层LOD密度（不涉及GL，可在工作线程调用）；data指向第dataZ个切片
+    // data需包含zEnd处的切片（如有）：奇数边界的输出切片会读取它
+    void AccumulateLod(const unsigned char* data, int zBegin, int zEnd, int dataZ = 0);
+    
+    // 取走累积完成的第1层LOD密度（之后由调用方生成并上传第1层及以上的层级）
+    std::vector<unsigned char> TakeLodDensity();
+    
+    // 由第level-1层密度盒式下采样得到第level层密度（不涉及GL，可在工作线程调用）
+    void DownsampleLodLevel(int level, const std::vector<unsigned char>& src, std::vector<unsigned char>& dst) const;
+    
+    // 全部切片上传后创建宏单元占用纹理（需在GL线程调用）；
+    // createLodLevels为真时先在当前线程生成并上传其余LOD层级，调用方已自行上传时传false
+    bool FinishUpload(bool createLodLevels = true);
+    
+    // ========== 时间序列帧接口（供TimeSeriesVolume使用） ==========
+    // 分配只有原始分辨率层的纹理和宏单元占用纹理；尺寸不变时保留已有存储，不重新分配
+    // 之后用UploadSlices写入各切片、SetMacrocellMinMax替换宏单元网格
+    bool AllocateFrame(int width, int height, int depth);
+    
+    // 计算8位体积的宏单元最小/最大值（归一化到[0, 1]、交错存储，不涉及GL，可在工作线程调用）
+    static void ComputeMacrocellMinMax(const unsigned char* data, int width, int height, int depth,
+                                       std::vector<float>& minMax);
+    
+    // 替换宏单元最小/最大值（尺寸需与当前网格一致），之后需重新ClassifyMacrocells
+    void SetMacrocellMinMax(const std::vector<float>& minMax);
+    
+    GradientFilter GetGradientFilter() const { return gradientFilter; }
+    
+    // 根据窗宽/窗位、阈值、密度系数和传输函数重新分类宏单元（空/非空）
+    void ClassifyMacrocells(float threshold, float density, float windowWidth, float windowCenter,
+                            const std::vector<glm::vec4>& transferFunction);
     
     // 绑定3D纹理
     void Bind(GLuint textureUnit = 0) const;
     
+    // 绑定宏单元占用纹理
+    void BindMacrocells(GLuint textureUnit) const;
+    
+    // 绑定原生精度密度纹理（仅16位/浮点数据）
+    void BindDensity(GLuint textureUnit) const;
+    bool HasNativeDensity() const { return densityTextureID != 0; }
+    
+    // 原生密度纹理采样值 -> 归一化原始值 [0, 1] 的缩放(x)与偏移(y)
+    glm::vec2 GetNativeDensityMapping() const;
+    
     // 获取纹理ID
     GLuint GetTextureID() const { return textureID; }
     
@@ -28,12 +104,82 @@ public:
     int GetHeight() const { return height; }
     int GetDepth() const { return depth; }
     
+    // 体素间距、体素类型和原始值范围（归一化时映射到[0, 1]）
+    glm::vec3 GetSpacing() const { return spacing; }
+    VoxelType GetVoxelType() const { return voxelType; }
+    float GetValueMin() const { return valueMin; }
+    float GetValueMax() const { return valueMax; }
+    
+    // 获取LOD层级数（1 = 仅原始分辨率）
+    int GetLodLevelCount() const { return lodLevelCount; }
+    
+    // 第level层LOD的尺寸（与OpenGL mipmap尺寸规则一致）
+    glm::ivec3 GetLodLevelSize(int level) const;
+    
+    // 获取宏单元网格尺寸
+    glm::ivec3 GetMacrocellGridSize() const { return macrocellGridSize; }
+    // 最近一次分类的宏单元占用（x最快，非0 = 非空），与占用纹理内容一致
+    const std::vector<unsigned char>& GetMacrocellOccupancy() const { return macrocellOccupancy; }
+    
 private:
     GLuint textureID;
     int width, height, depth;
+    GradientFilter gradientFilter;
+    glm::vec3 spacing;
+    VoxelType voxelType;
+    float valueMin, valueMax;
+    
+    // 原生精度密度纹理（R16 / R16_SNORM / R32F），mip层级与打包纹理相同
+    GLuint densityTextureID;
+    std::vector<unsigned char> lodNativeDensity;
+    
+    // 宏单元网格：每个单元按值域归一化的最小/最大体素值（交错存储，由原生值统计）及占用纹理
+    GLuint macrocellTextureID;
+    glm::ivec3 macrocellGridSize;
+    std::vector<float> macrocellMinMax;
+    std::vector<unsigned char> macrocellOccupancy;
+    
+    // LOD金字塔（8位数据）：第1层密度在上传过程中逐块累积，其余层级由其递推
+    int lodLevelCount;
+    std::vector<unsigned char> lodDensity;
+    
+    // 每次上传的切片块大小（字节，按打包后的RGBA8计）
+    static const uint64_t UPLOAD_SLAB_BYTES = 64ull * 1024 * 1024;
+    
+    // 按Z切片块计算梯度并创建打包的3D纹理，mapping非空时上传后释放已处理的映射页
+    // （data位于映射内的mappingOffset处）
+    bool CreateTexture3D(const unsigned char* data, const MappedFile* mapping = nullptr, uint64_t mappingOffset = 0);
+    
+    // 按Z切片块读取原始体素：返回[zBegin, zEnd)切片（x最快），数据在下一次调用前有效，失败时返回nullptr
+    // 每一遍内请求的范围递增且首尾相接
+    using SlabReader = std::function<const unsigned char*(int zBegin, int zEnd)>;
+    
+    // 由已设置尺寸/类型的原始体素按切片块创建纹理，峰值内存约为两块：
+    // 先逐块统计值域，再逐块由原生值计算梯度、宏单元和LOD，16位/浮点另上传原生精度纹理
+    // valueRangeKnown为真时直接使用已设置的valueMin/valueMax，只读取一遍
+    bool CreateFromSlabs(const SlabReader& readSlab, bool swapBytes, bool valueRangeKnown = false);
+    
+    // 分配原生精度的密度纹理及其mip层级（8位数据不创建）
+    bool CreateDensityTexture();
+    
+    // 上传原生精度密度切片（主机字节序）并累积其第1层LOD
+    void UploadDensitySlices(const unsigned char* raw, int zBegin, int zEnd);
+    
+    // 由原生密度的第1层递推其余层级并上传（盒式平均），同时由各层原生值生成打包纹理的对应LOD层级
+    bool CreateDensityLodLevels();
+    
+    // 宏单元最小/最大值网格：重置、创建占用纹理
+    void ResetMacrocellGrid();
+    bool CreateMacrocellTexture();
+    
+    // 把[zBegin, zEnd)切片累积到宏单元最小/最大值网格（grid为网格尺寸，data指向第dataZ个切片），
+    // 原始值v按 (v - valueMin) * scale 归一化
+    template <typename T>
+    static void AccumulateMacrocellRange(const T* data, const glm::ivec3& size, const glm::ivec3& grid,
+                                         float* minMax, int zBegin, int zEnd, int dataZ, float valueMin, float scale);
     
-    // 创建3D纹理
-    bool CreateTexture3D(const std::vector<unsigned char>& data);
+    // 由第1层密度递推生成各层，按切片块计算梯度打包后上传到对应mip层级（8位数据）
+    bool CreateLodLevels();
 };
 
 #endif // VOLUMEDATA_H
@@ -0,0 +1,28 @@
+#ifndef VOLUMEGEOMETRY_H
+#define VOLUMEGEOMETRY_H
+
+#include <glm/glm.hpp>
+#include <algorithm>
+
+// 体数据包围盒与密度映射的公共计算，GPU（Renderer的uniform）和CPU参考渲染器共用
+namespace VolumeGeometry {
+    // 包围盒尺寸：按物理尺寸（体素数 * 间距）确定比例，最长轴为1，包围盒以原点为中心
+    inline glm::vec3 GetBoxExtent(const glm::vec3& voxelCount, const glm::vec3& spacing) {
+        glm::vec3 physicalSize = voxelCount * spacing;
+        return physicalSize / std::max(std::max(physicalSize.x, physicalSize.y), physicalSize.z);
+    }
+    
+    // 体素空间梯度 -> 包围盒空间梯度：各轴乘以单位包围盒长度内的体素数，再整体归一化
+    inline glm::vec3 GetGradientScale(const glm::vec3& voxelCount, const glm::vec3& boxExtent) {
+        glm::vec3 voxelsPerUnit = voxelCount / boxExtent;
+        return voxelsPerUnit / std::max(std::max(voxelsPerUnit.x, voxelsPerUnit.y), voxelsPerUnit.z);
+    }
+    
+    // 窗宽/窗位：归一化原始值 v -> clamp(v * x + y) = clamp((v - center) / width + 0.5)
+    inline glm::vec2 GetWindowMapping(float windowWidth, float windowCenter) {
+        float windowScale = 1.0f / std::max(windowWidth, 1e-6f);
+        return glm::vec2(windowScale, 0.5f - windowCenter * windowScale);
+    }
+}
+
+#endif // VOLUMEGEOMETRY_H
@@ -0,0 +1,65 @@
+#ifndef VOLUMEGRADIENT_H
+#define VOLUMEGRADIENT_H
+
+#include "ThreadPool.h"
+#include "VolumeHeader.h"
+#include <cmath>
+#include <vector>
+
+// 梯度算子
+enum class GradientFilter {
+    CentralDifference,  // 中心差分（6邻域）
+    Sobel               // 3D Sobel（26邻域，抗噪更好）
+};
+
+// 打包体素格式（RGBA8）：
+//   rgb = 体素空间梯度的单位方向，每分量 n ∈ [-1, 1] 编码为 128 + round(n * 127)，零梯度为(128, 128, 128)
+//   a   = 原始密度
+// 只存方向（精度不随梯度大小变化）；解码后长度低于MIN_DIRECTION_LENGTH视为零梯度，不计算光照，
+// 否则乘以各轴缩放后归一化即为法线
+namespace VolumeGradient {
+    // 计算[zBegin, zEnd)范围内切片的打包体素，按z切片并行
+    // data为完整体数据（x最快），packed需至少容纳 width*height*(zEnd-zBegin)*4 字节
+    void ComputePacked(const unsigned char* data, int width, int height, int depth,
+                       int zBegin, int zEnd, GradientFilter filter, unsigned char* packed,
+                       ThreadPool& pool = ThreadPool::Shared());
+    
+    // 原生类型数据（主机字节序）的打包体素：梯度方向由原生值计算（不先量化到8位），
+    // a = 按[valueMin, valueMax]归一化到8位的密度；浮点数据的非有限值按valueMin处理
+    void ComputePackedNative(const unsigned char* data, VoxelType type, int width, int height, int depth,
+                             int zBegin, int zEnd, GradientFilter filter, float valueMin, float valueMax,
+                             unsigned char* packed, ThreadPool& pool = ThreadPool::Shared());
+    
+    // 计算任意区域（可超出体积边界，越界坐标钳制到边缘）的打包体素，单线程
+    // 区域原点为(x0, y0, z0)，尺寸为sizeX*sizeY*sizeZ，packed按x最快的顺序存储
+    void ComputePackedRegion(const unsigned char* data, int width, int height, int depth,
+                             int x0, int y0, int z0, int sizeX, int sizeY, int sizeZ,
+                             GradientFilter filter, unsigned char* packed);
+    
+    // 计算整个体积的打包体素
+    std::vector<unsigned char> ComputePacked(const unsigned char* data, int width, int height, int depth,
+                                             GradientFilter filter, ThreadPool& pool = ThreadPool::Shared());
+    
+    // 解码后的方向短于半个量化步长时视为零梯度（与shader中的判断一致）
+    const float MIN_DIRECTION_LENGTH = 0.5f / 127.0f;
+    
+    // 方向分量的编码/解码
+    inline unsigned char Encode(float n) {
+        n = n < -1.0f ? -1.0f : (n > 1.0f ? 1.0f : n);
+        return (unsigned char)(128.0f + n * 127.0f + (n >= 0.0f ? 0.5f : -0.5f));
+    }
+    inline float Decode(float encodedUnorm) {
+        return (encodedUnorm * 255.0f - 128.0f) / 127.0f;
+    }
+    
+    // 把一个梯度归一化后编码到rgb[0..2]，零梯度编码为(128, 128, 128)
+    inline void EncodeDirection(float gx, float gy, float gz, unsigned char* rgb) {
+        float length = std::sqrt(gx * gx + gy * gy + gz * gz);
+        float inverse = length > 0.0f ? 1.0f / length : 0.0f;
+        rgb[0] = Encode(gx * inverse);
+        rgb[1] = Encode(gy * inverse);
+        rgb[2] = Encode(gz * inverse);
+    }
+}
+
+#endif // VOLUMEGRADIENT_H
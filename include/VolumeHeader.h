@@ -0,0 +1,50 @@
+#ifndef VOLUMEHEADER_H
+#define VOLUMEHEADER_H
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// 体素数据类型
+enum class VoxelType {
+    UInt8,
+    Int16,
+    UInt16,
+    Float32
+};
+
+// 从文件头解析出的体数据描述
+struct VolumeFileInfo {
+    int width = 0;
+    int height = 0;
+    int depth = 0;
+    VoxelType type = VoxelType::UInt8;
+    glm::vec3 spacing = glm::vec3(1.0f);  // 各轴体素间距
+    bool bigEndian = false;               // 多字节体素的字节序
+    std::string dataFile;                 // 数据所在文件（附带数据时即头文件本身）
+    uint64_t dataOffset = 0;              // 数据在dataFile中的字节偏移
+    bool offsetFromEnd = false;           // 数据紧贴文件末尾（NRRD byte skip: -1 / MHD HeaderSize = -1）
+    
+    uint64_t GetVoxelCount() const { return (uint64_t)width * (uint64_t)height * (uint64_t)depth; }
+};
+
+// NRRD（.nrrd/.nhdr）与MetaImage（.mhd/.mha）文件头解析，只支持未压缩（raw）编码
+namespace VolumeHeader {
+    // 按扩展名选择解析器；失败时输出原因并返回false
+    bool Parse(const std::string& filename, VolumeFileInfo& info);
+    
+    bool ParseNrrd(const std::string& filename, VolumeFileInfo& info);
+    bool ParseMetaImage(const std::string& filename, VolumeFileInfo& info);
+    
+    // 是否为可解析的头文件扩展名
+    bool IsHeaderFile(const std::string& filename);
+    
+    // 单个体素的字节数
+    size_t GetVoxelSize(VoxelType type);
+    
+    // 当前平台是否为大端序
+    bool IsHostBigEndian();
+}
+
+#endif // VOLUMEHEADER_H
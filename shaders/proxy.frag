@@ -0,0 +1,16 @@
+#version 330 core
+
+in vec3 WorldPos;
+out vec4 FragBounds;
+
+// 代理几何的入口/出口距离，以MIN混合写入边界纹理（清除值为MISS_DISTANCE，与ProxyGeometry.h一致）：
+// r = 最近正面，g = 最近背面，b = -最远面（网格闭合，最远面总是背面）
+uniform vec3 cameraPos;
+
+const float MISS_DISTANCE = 1e30;
+
+void main() {
+    // 与raymarching.frag中光线参数t的度量一致（归一化方向上到摄像机的距离）
+    float t = distance(WorldPos, cameraPos);
+    FragBounds = gl_FrontFacing ? vec4(t, MISS_DISTANCE, -t, 0.0) : vec4(MISS_DISTANCE, t, -t, 0.0);
+}
@@ -0,0 +1,15 @@
+#version 330 core
+
+// 代理几何（见ProxyGeometry.h）：顶点为体数据纹理坐标，按包围盒映射到世界空间
+layout (location = 0) in vec3 aPos;
+
+uniform mat4 viewProjection;
+uniform vec3 boxMin;
+uniform vec3 boxMax;
+
+out vec3 WorldPos;
+
+void main() {
+    WorldPos = mix(boxMin, boxMax, aPos);
+    gl_Position = viewProjection * vec4(WorldPos, 1.0);
+}
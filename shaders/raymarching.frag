@@ -1,32 +1,143 @@
 #version 330 core
 
+#ifndef COMPUTE_PATH
 in vec2 TexCoord;
-out vec4 FragColor;
+layout(location = 0) out vec4 FragColor;
+layout(location = 1) out uvec2 FeedbackOut;  // 分块缓存反馈：(首个未驻留块 + 1, 访问过的块 + 1)
+#endif
 
 // 纹理
-uniform sampler3D volumeTexture;
+uniform sampler3D volumeTexture;      // rgb = 预计算梯度（编码），a = 密度
 uniform sampler1D transferFunction;
+uniform sampler3D macrocellTexture;   // 宏单元占用（0 = 可跳过）
+uniform sampler3D brickAtlas;         // 分块缓存图集（打包格式同volumeTexture）
+uniform sampler3D brickPageTable;     // 页表：xyz = 图集槽位，a = 标志（见BrickCache.h）
+uniform sampler3D densityTexture;     // 原生精度密度（16位/浮点数据）
+uniform sampler2D preIntegrationTable; // 预积分表：x = 前端值，y = 后端值（见PreIntegration.h）
+uniform sampler2D rayBoundsTexture;   // 代理几何的入口/出口距离（见ProxyGeometry.h）
+uniform sampler3D channelVolume0;     // 附加通道（见VolumeChannels.h），打包格式同volumeTexture
+uniform sampler3D channelVolume1;
+uniform sampler3D channelVolume2;
+uniform sampler1D channelTransferFunction0;
+uniform sampler1D channelTransferFunction1;
+uniform sampler1D channelTransferFunction2;
 
-// 渲染参数
-uniform float stepSize;
-uniform float density;
-uniform float threshold;
-uniform bool enableLighting;
-uniform float absorptionCoeff;
-uniform float scatteringCoeff;
-uniform vec3 lightDir;
-uniform int maxSteps;
-uniform bool enableJittering;
-
-// 摄像机
-uniform mat4 invView;
-uniform mat4 invProjection;
-uniform vec3 cameraPos;
-uniform float time;
-
-// 体积包围盒
-const vec3 boxMin = vec3(-0.5);
-const vec3 boxMax = vec3(0.5);
+// 摄像机（std140，CPU端结构见UniformBlocks.h，与temporal.frag共用）
+layout(std140) uniform CameraBlock {
+    mat4 invView;
+    mat4 invProjection;
+    vec3 cameraPos;
+    float time;
+};
+
+// 渲染参数与由体数据推导出的每帧状态（std140，字段顺序需与UniformBlocks.h中的RenderUniforms一致）
+layout(std140) uniform RenderBlock {
+    vec3 lightDir;
+    float stepSize;
+    vec3 macrocellGridScale;          // 纹理坐标 -> 宏单元坐标的缩放
+    float density;
+    vec3 gradientScale;               // 体素空间梯度 -> 包围盒空间梯度的缩放
+    float threshold;
+    vec3 volumeSize;                  // 体素数
+    float absorptionCoeff;
+    vec3 brickGridSize;               // 分块缓存：每轴块数
+    float scatteringCoeff;
+    vec3 atlasSize;                   // 分块缓存：图集尺寸（体素）
+    float windowScale;                // 窗宽/窗位：归一化原始值 -> 密度：clamp(v * windowScale + windowOffset)
+    vec3 boxMin;                      // 体积包围盒（按体素数和间距确定比例，最长轴为1）
+    float windowOffset;
+    vec3 boxMax;
+    float nativeDensityScale;         // 原生纹理采样值 -> 归一化原始值
+    float nativeDensityOffset;
+    float lodScale;                   // 单位距离处一个像素覆盖的体素数
+    float lodBias;                    // 层级偏移（含摄像机运动时的额外偏移）
+    float maxLod;                     // 最粗层级（0 = 仅原始分辨率）
+    float jitterSequence;             // >= 0 时按帧序列抖动（时间累积：逐像素固定偏移 + 帧序列），否则逐帧随机
+    int maxSteps;
+    bool enableLighting;
+    bool enableJittering;
+    bool enableEmptySpaceSkipping;
+    bool usePreIntegration;
+    bool useNativeDensity;            // 16位/浮点数据使用原生精度密度纹理
+    bool useBrickCache;
+    bool outputDepth;                 // FragColor.a输出代表深度（不透明度加权的平均距离，0 = 无可见内容），供时间累积重投影
+    bool useProxyBounds;              // 由代理几何的边界纹理收紧光线区间
+    vec2 proxyBoundsScale;            // 视图内纹理坐标 -> 边界纹理坐标（边界只画在纹理左下角子区域）
+};
+
+// 附加通道（std140，CPU端结构见UniformBlocks.h），只有前channelCount项有效
+layout(std140) uniform ChannelBlock {
+    mat4 channelWorldToTexture[3];    // 世界坐标 -> 通道纹理坐标 [0,1]
+    vec4 channelParams[3];            // x = 密度系数，y = 阈值
+    vec4 channelVolumeSize[3];        // xyz = 体素数
+    int channelCount;
+};
+
+#ifdef MULTI_VIEW
+// 批量多视图（见MultiViewRenderer.h）：摄像机按实例索引从ViewBlock读取（std140，CPU端结构见UniformBlocks.h中的ViewUniforms），
+// CameraBlock中只有time有效；声明需与raymarching.vert一致
+const int MAX_VIEWS = 64;
+struct ViewData {
+    mat4 invView;
+    mat4 invProjection;
+    vec3 cameraPos;
+    float pixelAngle;                 // 单位距离处一个像素的张角（RenderBlock中的lodScale此时为每单位长度的体素数）
+    vec4 viewport;
+};
+layout(std140) uniform ViewBlock {
+    ViewData views[MAX_VIEWS];
+};
+flat in int ViewIndex;
+#define VIEW_INV_VIEW views[ViewIndex].invView
+#define VIEW_INV_PROJECTION views[ViewIndex].invProjection
+#define VIEW_POSITION views[ViewIndex].cameraPos
+#define VIEW_LOD_SCALE (lodScale * views[ViewIndex].pixelAngle)
+#else
+#define VIEW_INV_VIEW invView
+#define VIEW_INV_PROJECTION invProjection
+#define VIEW_POSITION cameraPos
+#define VIEW_LOD_SCALE lodScale
+#endif
+
+// 编译期特化：变体由ShaderCache在#version之后注入SPECIALIZED、各FEATURE_*开关（0/1）和SPECIALIZED_MAX_STEPS，
+// 特性开关成为常量，关闭的分支（如光照、分块寻址）在编译时整段删除，主循环上界也是常量；
+// 通用程序（未定义SPECIALIZED）读取RenderBlock中的运行时值，在变体编译完成前使用
+#ifdef SPECIALIZED
+#define USE_LIGHTING (FEATURE_LIGHTING != 0)
+#define USE_JITTERING (FEATURE_JITTERING != 0)
+#define USE_EMPTY_SPACE_SKIPPING (FEATURE_EMPTY_SPACE_SKIPPING != 0)
+#define USE_PRE_INTEGRATION (FEATURE_PRE_INTEGRATION != 0)
+#define USE_NATIVE_DENSITY (FEATURE_NATIVE_DENSITY != 0)
+#define USE_BRICK_CACHE (FEATURE_BRICK_CACHE != 0)
+#define OUTPUT_DEPTH (FEATURE_OUTPUT_DEPTH != 0)
+#define USE_PROXY_BOUNDS (FEATURE_PROXY_BOUNDS != 0)
+#define CHANNEL_COUNT SPECIALIZED_CHANNEL_COUNT
+#define MAX_STEPS SPECIALIZED_MAX_STEPS
+#else
+#define USE_LIGHTING enableLighting
+#define USE_JITTERING enableJittering
+#define USE_EMPTY_SPACE_SKIPPING enableEmptySpaceSkipping
+#define USE_PRE_INTEGRATION usePreIntegration
+#define USE_NATIVE_DENSITY useNativeDensity
+#define USE_BRICK_CACHE useBrickCache
+#define OUTPUT_DEPTH outputDepth
+#define USE_PROXY_BOUNDS useProxyBounds
+#define CHANNEL_COUNT channelCount
+#define MAX_STEPS maxSteps
+#endif
+
+// COUNT_SAMPLES（见RayStatistics.h）：FragColor输出(采样数, 步数, 1, 0)代替颜色，未命中包围盒时为0
+
+// 消光系数缩放（与PreIntegration::OPACITY_SCALE一致）
+const float OPACITY_SCALE = 100.0;
+
+// 块尺寸（与BrickCache.h一致）
+const float BRICK_SIZE = 32.0;
+const float BRICK_APRON = 1.0;
+const float BRICK_STORAGE = 34.0;
+
+// 边界纹理中未被代理几何覆盖的值（与ProxyGeometry::MISS_DISTANCE一致）
+const float PROXY_MISS_DISTANCE = 1e30;
 
 // 随机函数（用于抖动采样）
 float random(vec2 st) {
@@ -48,13 +159,33 @@ bool intersectAABB(vec3 rayOrigin, vec3 rayDir, vec3 boxMin, vec3 boxMax, out fl
     return tFar > tNear && tFar > 0.0;
 }
 
-// 计算梯度（用于光照）
-vec3 computeGradient(vec3 pos) {
-    float offset = 0.01;
-    float dx = texture(volumeTexture, pos + vec3(offset, 0, 0)).r - texture(volumeTexture, pos - vec3(offset, 0, 0)).r;
-    float dy = texture(volumeTexture, pos + vec3(0, offset, 0)).r - texture(volumeTexture, pos - vec3(0, offset, 0)).r;
-    float dz = texture(volumeTexture, pos + vec3(0, 0, offset)).r - texture(volumeTexture, pos - vec3(0, 0, offset)).r;
-    return normalize(vec3(dx, dy, dz));
+// 光线参数t处按像素覆盖的体素数选择的LOD层级
+float lodAt(float t) {
+    if (maxLod <= 0.0) return 0.0;
+    return clamp(log2(max(t * VIEW_LOD_SCALE, 1.0)) + lodBias, 0.0, maxLod);
+}
+
+// 计算光线从pos出发离开当前网格单元（宏单元或块）所需的距离
+float cellExitDistance(vec3 pos, vec3 rayDir, vec3 cell, vec3 gridScale) {
+    vec3 cellMin = boxMin + cell / gridScale * (boxMax - boxMin);
+    vec3 cellMax = boxMin + (cell + 1.0) / gridScale * (boxMax - boxMin);
+    vec3 t = (mix(cellMin, cellMax, step(0.0, rayDir)) - pos) / rayDir;
+    return max(min(min(t.x, t.y), t.z), 0.0);
+}
+
+// 解码预计算的体素空间梯度方向，编码方式见VolumeGradient.h；
+// 零梯度编码为(128, 128, 128)，解码后短于MIN_DIRECTION_LENGTH时不计算光照
+const float MIN_DIRECTION_LENGTH = 0.5 / 127.0;
+
+vec3 decodeDirection(vec4 voxel) {
+    return (voxel.rgb * 255.0 - 128.0) / 127.0;
+}
+
+// 光线与附加通道包围盒的交点：在通道纹理坐标空间中与[0,1]求交（仿射变换不改变光线参数t）
+bool intersectChannel(int index, vec3 rayOrigin, vec3 rayDir, out float tNear, out float tFar) {
+    vec3 origin = (channelWorldToTexture[index] * vec4(rayOrigin, 1.0)).xyz;
+    vec3 direction = (channelWorldToTexture[index] * vec4(rayDir, 0.0)).xyz;
+    return intersectAABB(origin, direction, vec3(0.0), vec3(1.0), tNear, tFar);
 }
 
 // 简单的光照计算
@@ -74,88 +205,422 @@ vec3 computeLighting(vec3 normal, vec3 viewDir, vec3 color) {
     return ambient + diffuse + specular;
 }
 
-void main() {
+// 在pos处采样一个附加通道，把其光学厚度（消光 * 长度 * 吸收系数）和按厚度加权的颜色累加到本步的合计中
+void addChannelSample(sampler3D volume, sampler1D tf, int index, vec3 pos, float segmentLength,
+                      inout float opticalDepth, inout vec3 weightedColor) {
+    vec3 texCoord = (channelWorldToTexture[index] * vec4(pos, 1.0)).xyz;
+    if (any(lessThan(texCoord, vec3(0.0))) || any(greaterThan(texCoord, vec3(1.0)))) return;
+    
+    vec4 voxel = textureLod(volume, texCoord, 0.0);
+    float densityValue = voxel.a * channelParams[index].x;
+    if (densityValue <= channelParams[index].y) return;
+    
+    vec4 sampledColor = texture(tf, densityValue);
+    if (USE_LIGHTING && sampledColor.a > 0.01) {
+        // 体素空间梯度 -> 纹理坐标梯度 -> 世界空间梯度（乘以变换线性部分的转置）
+        vec3 direction = decodeDirection(voxel);
+        if (length(direction) > MIN_DIRECTION_LENGTH) {
+            vec3 gradient = transpose(mat3(channelWorldToTexture[index])) * (direction * channelVolumeSize[index].xyz);
+            sampledColor.rgb = computeLighting(normalize(gradient), normalize(VIEW_POSITION - pos), sampledColor.rgb);
+        }
+    }
+    
+    float sampleDepth = sampledColor.a * segmentLength * absorptionCoeff * OPACITY_SCALE;
+    opticalDepth += sampleDepth;
+    weightedColor += sampleDepth * sampledColor.rgb;
+}
+
+// 一条光线的步进状态：片段路径在一次调用中走完，计算路径（COMPUTE_PATH）按段推进，段之间保存在共享内存中
+struct RayState {
+    vec2 uv;                              // 视图内的纹理坐标（抖动和分块采样的随机种子）
+    vec3 rayDir;
+    float tNear;                          // 遍历区间起点（各包围盒区间的并集）
+    float volumeNear;                     // 主体数据包围盒的区间
+    float volumeFar;
+    float rayLength;
+    vec3 currentPos;
+    float traveled;
+    vec4 accumulatedColor;
+    float depthSum;                       // 按各采样点对最终不透明度的贡献加权的距离之和
+    float frontDensity;                   // 预积分：上一个采样点的密度和位置作为片段前端（小于0表示没有前端，如起点或跳跃之后）
+    float frontTraveled;
+    int steps;
+    int samples;                          // 实际读取体数据的次数（不含跳过的步数）
+    uint missingBrick;                    // 分块缓存反馈
+    uint touchedBrick;
+    uint lastBrick;
+    float touchedCount;
+};
+
+// 由视图内的纹理坐标建立光线并初始化步进状态，未命中任何包围盒时返回false
+bool beginRay(vec2 uv, out RayState ray) {
+    ray.uv = uv;
+    
     // 从屏幕空间坐标重建世界空间光线
-    vec4 clipPos = vec4(TexCoord * 2.0 - 1.0, -1.0, 1.0);
-    vec4 viewPos = invProjection * clipPos;
+    vec4 clipPos = vec4(uv * 2.0 - 1.0, -1.0, 1.0);
+    vec4 viewPos = VIEW_INV_PROJECTION * clipPos;
     viewPos /= viewPos.w;
     
-    vec3 rayDir = normalize((invView * vec4(viewPos.xyz, 0.0)).xyz);
-    vec3 rayOrigin = cameraPos;
+    vec3 rayDir = normalize((VIEW_INV_VIEW * vec4(viewPos.xyz, 0.0)).xyz);
+    vec3 rayOrigin = VIEW_POSITION;
+    ray.rayDir = rayDir;
     
-    // 计算与体积包围盒的交点
+    // 计算与体积包围盒的交点；有附加通道时遍历区间为各包围盒区间的并集，主体数据只在自己的区间内采样
     float tNear, tFar;
-    if (!intersectAABB(rayOrigin, rayDir, boxMin, boxMax, tNear, tFar)) {
-        FragColor = vec4(0.0, 0.0, 0.0, 1.0);
-        return;
+    bool hit = intersectAABB(rayOrigin, rayDir, boxMin, boxMax, tNear, tFar);
+    ray.volumeNear = tNear;
+    ray.volumeFar = tFar;
+    if (!hit) {
+        tNear = 1e30;
+        tFar = -1e30;
+    }
+    for (int i = 0; i < CHANNEL_COUNT; i++) {
+        float channelNear, channelFar;
+        if (intersectChannel(i, rayOrigin, rayDir, channelNear, channelFar)) {
+            tNear = min(tNear, channelNear);
+            tFar = max(tFar, channelFar);
+            hit = true;
+        }
+    }
+    if (!hit) {
+        return false;
     }
     
     // 确保起点在包围盒内
     if (tNear < 0.0) tNear = 0.0;
+    ray.tNear = tNear;
     
     // Ray Marching初始化
     vec3 startPos = rayOrigin + rayDir * tNear;
     vec3 endPos = rayOrigin + rayDir * tFar;
-    float rayLength = distance(startPos, endPos);
+    ray.rayLength = distance(startPos, endPos);
     
     // 抖动采样优化（减少条带伪影）
     float jitter = 0.0;
-    if (enableJittering) {
-        jitter = random(TexCoord + time) * stepSize;
+    if (USE_JITTERING) {
+        float offset = jitterSequence >= 0.0 ? fract(random(uv) + jitterSequence) : random(uv + time);
+        jitter = offset * stepSize;
     }
     
-    // 累积颜色和透明度
-    vec4 accumulatedColor = vec4(0.0);
-    vec3 currentPos = startPos + rayDir * jitter;
-    float traveled = jitter;
+    // 代理几何收紧区间：从第一个正面（最近的面为背面时摄像机在非空区域内，从0开始）到最后一个背面；
+    // 与空区域跳跃一样以入口处LOD层级的步长计数跳过的步数（取整到入口之前，不越过第一个非空单元），
+    // 不会因LOD层级下较短的基础步长多占用最大步数；未被覆盖的像素区间为空，不进入步进循环，输出与穿过空区域的光线相同的背景
+    int skippedSteps = 0;
+    if (USE_PROXY_BOUNDS) {
+        vec4 bounds = textureLod(rayBoundsTexture, uv * proxyBoundsScale, 0.0);
+        float proxyNear = tNear;
+        float proxyFar = tNear;
+        if (min(bounds.x, bounds.y) < 0.5 * PROXY_MISS_DISTANCE) {
+            proxyNear = bounds.x < bounds.y ? bounds.x : 0.0;
+            proxyFar = -bounds.z;
+        }
+        float entryStep = stepSize * exp2(lodAt(proxyNear));
+        skippedSteps = int(max(floor((proxyNear - tNear - jitter) / entryStep), 0.0));
+        jitter += float(skippedSteps) * entryStep;
+        ray.rayLength = min(ray.rayLength, proxyFar - tNear);
+    }
     
-    // Ray Marching主循环
-    int steps = 0;
-    while (traveled < rayLength && steps < maxSteps && accumulatedColor.a < 0.95) {
+    // 累积颜色和透明度
+    ray.accumulatedColor = vec4(0.0);
+    ray.currentPos = startPos + rayDir * jitter;
+    ray.traveled = jitter;
+    ray.depthSum = 0.0;
+    ray.frontDensity = -1.0;
+    ray.frontTraveled = 0.0;
+    ray.steps = skippedSteps;
+    ray.samples = 0;
+    ray.missingBrick = 0u;
+    ray.touchedBrick = 0u;
+    ray.lastBrick = 0xFFFFFFFFu;
+    ray.touchedCount = 0.0;
+    return true;
+}
+
+// 光线是否仍需步进（未走完区间、未达到最大步数且未接近不透明）
+bool rayActive(RayState ray) {
+    return ray.traveled < ray.rayLength && ray.steps < MAX_STEPS && ray.accumulatedColor.a < 0.95;
+}
+
+// Ray Marching主循环：最多执行iterationBudget次迭代（一次空区域跳跃算一次）
+void marchRay(inout RayState ray, int iterationBudget) {
+    for (int iteration = 0; iteration < iterationBudget && rayActive(ray); iteration++) {
         // 将位置转换到纹理坐标空间 [0,1]
-        vec3 texCoord = currentPos - boxMin;
+        vec3 texCoord = ray.currentPos - boxMin;
         texCoord /= (boxMax - boxMin);
         
-        // 采样体数据
-        float densityValue = texture(volumeTexture, texCoord).r;
+        // 本步的光学厚度与按厚度加权的颜色：主体数据和各附加通道的消光相加
+        float opticalDepth = 0.0;
+        vec3 weightedColor = vec3(0.0);
         
-        // 应用密度系数和阈值
-        densityValue *= density;
+        // 并集区间中不在主体数据包围盒内的部分只采样附加通道
+        float rayT = ray.tNear + ray.traveled;
+        bool insideVolume = CHANNEL_COUNT == 0 || (rayT >= ray.volumeNear && rayT <= ray.volumeFar);
         
-        if (densityValue > threshold) {
-            // 从传输函数获取颜色
-            vec4 sampledColor = texture(transferFunction, densityValue);
-            
-            // 应用光照
-            if (enableLighting && sampledColor.a > 0.01) {
-                vec3 gradient = computeGradient(texCoord);
-                if (length(gradient) > 0.01) {
-                    vec3 normal = normalize(gradient);
-                    vec3 viewDir = normalize(cameraPos - currentPos);
-                    sampledColor.rgb = computeLighting(normal, viewDir, sampledColor.rgb);
+        // 按像素覆盖的体素数选择LOD层级，步长随该层体素尺寸放大
+        float lod = lodAt(ray.tNear + ray.traveled);
+        float currentStep = stepSize * exp2(lod);
+        
+        // 空区域跳跃：整块跳过当前宏单元，并对齐到原有步进网格以保持采样位置不变
+        if (USE_EMPTY_SPACE_SKIPPING) {
+            vec3 cell = clamp(floor(texCoord * macrocellGridScale), vec3(0.0), ceil(macrocellGridScale) - 1.0);
+            if (texelFetch(macrocellTexture, ivec3(cell), 0).r == 0.0) {
+                float exitDistance = cellExitDistance(ray.currentPos, ray.rayDir, cell, macrocellGridScale);
+                int skipSteps = max(int(ceil(exitDistance / currentStep)), 1);
+                ray.currentPos += ray.rayDir * (currentStep * float(skipSteps));
+                ray.traveled += currentStep * float(skipSteps);
+                ray.steps += skipSteps;
+                ray.frontDensity = -1.0;
+                continue;
+            }
+        }
+        
+        if (insideVolume) {
+            // 采样体数据（一次读取同时得到密度和梯度）
+            vec4 voxel;
+            if (USE_BRICK_CACHE) {
+                // 通过页表把体素坐标映射到图集
+                vec3 voxelPos = texCoord * volumeSize;
+                vec3 brick = clamp(floor(voxelPos / BRICK_SIZE), vec3(0.0), brickGridSize - 1.0);
+                vec4 entry = texelFetch(brickPageTable, ivec3(brick), 0);
+                uint brickId = uint(brick.x + brick.y * brickGridSize.x + brick.z * brickGridSize.x * brickGridSize.y);
+                
+                // 空块和未驻留块整块跳过，未驻留块记录到反馈中
+                if (entry.a < 0.75) {
+                    if (entry.a < 0.25 && ray.missingBrick == 0u) {
+                        ray.missingBrick = brickId + 1u;
+                    }
+                    float exitDistance = cellExitDistance(ray.currentPos, ray.rayDir, brick, volumeSize / BRICK_SIZE);
+                    int skipSteps = max(int(ceil(exitDistance / currentStep)), 1);
+                    ray.currentPos += ray.rayDir * (currentStep * float(skipSteps));
+                    ray.traveled += currentStep * float(skipSteps);
+                    ray.steps += skipSteps;
+                    ray.frontDensity = -1.0;
+                    continue;
+                }
+                
+                // 对访问过的块做蓄水池采样，供LRU更新使用
+                if (brickId != ray.lastBrick) {
+                    ray.lastBrick = brickId;
+                    ray.touchedCount += 1.0;
+                    if (random(ray.uv + vec2(time, ray.touchedCount)) * ray.touchedCount < 1.0) {
+                        ray.touchedBrick = brickId + 1u;
+                    }
                 }
+                
+                vec3 atlasTexel = floor(entry.xyz * 255.0 + 0.5) * BRICK_STORAGE + BRICK_APRON + (voxelPos - brick * BRICK_SIZE);
+                voxel = texture(brickAtlas, atlasTexel / atlasSize);
+            } else {
+                voxel = textureLod(volumeTexture, texCoord, lod);
             }
+            float densityValue = voxel.a;
+            ray.samples++;
+            
+            // 16位/浮点数据在各LOD层级都使用原生精度密度（密度纹理有自己的平均mip链）
+            if (USE_NATIVE_DENSITY) {
+                densityValue = textureLod(densityTexture, texCoord, lod).r * nativeDensityScale + nativeDensityOffset;
+            }
+            
+            // 窗宽/窗位映射（默认为恒等映射）
+            densityValue = clamp(densityValue * windowScale + windowOffset, 0.0, 1.0);
             
-            // 调整透明度（基于步长和吸收系数）
-            sampledColor.a *= stepSize * absorptionCoeff * 100.0;
-            sampledColor.a = clamp(sampledColor.a, 0.0, 1.0);
+            // 应用密度系数和阈值
+            densityValue *= density;
+            
+            // 片段[前一采样点, 当前采样点]；没有前端时退化为长度为一步的逐点采样
+            float front = ray.frontDensity >= 0.0 ? ray.frontDensity : densityValue;
+            float segmentLength = (USE_PRE_INTEGRATION && ray.frontDensity >= 0.0) ? ray.traveled - ray.frontTraveled : currentStep;
+            ray.frontDensity = densityValue;
+            ray.frontTraveled = ray.traveled;
+            
+            bool visible = USE_PRE_INTEGRATION ? max(front, densityValue) > threshold : densityValue > threshold;
+            if (visible) {
+                // 颜色与消光：预积分时为片段上的积分平均（阈值已烘焙进表），否则为逐点传输函数
+                vec4 sampledColor;
+                if (USE_PRE_INTEGRATION) {
+                    sampledColor = texture(preIntegrationTable, vec2(front, densityValue));
+                } else {
+                    sampledColor = texture(transferFunction, densityValue);
+                }
+                
+                // 应用光照（法线来自同一次读取的梯度方向，均匀区域不计算光照）
+                if (USE_LIGHTING && sampledColor.a > 0.01) {
+                    vec3 direction = decodeDirection(voxel);
+                    if (length(direction) > MIN_DIRECTION_LENGTH) {
+                        vec3 normal = normalize(direction * gradientScale);
+                        vec3 viewDir = normalize(VIEW_POSITION - ray.currentPos);
+                        sampledColor.rgb = computeLighting(normal, viewDir, sampledColor.rgb);
+                    }
+                }
+                
+                float sampleDepth = sampledColor.a * segmentLength * absorptionCoeff * OPACITY_SCALE;
+                opticalDepth += sampleDepth;
+                weightedColor += sampleDepth * sampledColor.rgb;
+            }
+        }
+        
+        // 附加通道（采样器不能用循环变量索引，逐个展开）
+        if (CHANNEL_COUNT > 0) {
+            addChannelSample(channelVolume0, channelTransferFunction0, 0, ray.currentPos, currentStep, opticalDepth, weightedColor);
+        }
+        if (CHANNEL_COUNT > 1) {
+            addChannelSample(channelVolume1, channelTransferFunction1, 1, ray.currentPos, currentStep, opticalDepth, weightedColor);
+        }
+        if (CHANNEL_COUNT > 2) {
+            addChannelSample(channelVolume2, channelTransferFunction2, 2, ray.currentPos, currentStep, opticalDepth, weightedColor);
+        }
+        
+        if (opticalDepth > 0.0) {
+            // 按片段长度做不透明度校正：alpha = 1 - exp(-光学厚度)，颜色为各来源按厚度的加权平均
+            vec4 sampledColor;
+            sampledColor.a = 1.0 - exp(-opticalDepth);
             
             // 预乘Alpha混合
-            sampledColor.rgb *= sampledColor.a;
+            sampledColor.rgb = weightedColor / opticalDepth * sampledColor.a;
             
             // Front-to-back合成
-            accumulatedColor += (1.0 - accumulatedColor.a) * sampledColor;
+            ray.depthSum += (1.0 - ray.accumulatedColor.a) * sampledColor.a * (ray.tNear + ray.traveled);
+            ray.accumulatedColor += (1.0 - ray.accumulatedColor.a) * sampledColor;
         }
         
         // 前进一步
-        currentPos += rayDir * stepSize;
-        traveled += stepSize;
-        steps++;
+        ray.currentPos += ray.rayDir * currentStep;
+        ray.traveled += currentStep;
+        ray.steps++;
     }
-    
-    // 背景混合
+}
+
+// 背景混合后的最终颜色；OUTPUT_DEPTH时a为代表深度（不透明度加权的平均距离），否则为1
+vec4 finishRay(RayState ray) {
     vec3 backgroundColor = vec3(0.1, 0.1, 0.15);
-    vec3 finalColor = accumulatedColor.rgb + (1.0 - accumulatedColor.a) * backgroundColor;
+    vec3 finalColor = ray.accumulatedColor.rgb + (1.0 - ray.accumulatedColor.a) * backgroundColor;
+    
+    float depth = ray.accumulatedColor.a > 0.01 ? ray.depthSum / ray.accumulatedColor.a : 0.0;
+    return vec4(finalColor, OUTPUT_DEPTH ? depth : 1.0);
+}
+
+// 未命中任何包围盒的光线
+vec4 missColor() {
+    return vec4(0.0, 0.0, 0.0, OUTPUT_DEPTH ? 0.0 : 1.0);
+}
+
+#ifndef COMPUTE_PATH
+void main() {
+    FeedbackOut = uvec2(0u);
+    
+    RayState ray;
+    if (!beginRay(TexCoord, ray)) {
+#ifdef COUNT_SAMPLES
+        FragColor = vec4(0.0);
+        return;
+#endif
+        FragColor = missColor();
+        return;
+    }
+    marchRay(ray, MAX_STEPS);
+    
+    FragColor = finishRay(ray);
+    FeedbackOut = uvec2(ray.missingBrick, ray.touchedBrick);
+#ifdef COUNT_SAMPLES
+    FragColor = vec4(float(ray.samples), float(ray.steps), 1.0, 0.0);
+#endif
+}
+#else
+// 计算路径（见ComputeRayMarcher.h）：常驻工作组从原子计数器领取COMPUTE_TILE_SIZE²像素的屏幕块，
+// 每轮每个线程把自己槽位上的光线推进COMPUTE_SEGMENT_STEPS次迭代；结束的光线写出结果，
+// 仍在步进的光线压缩到槽位前部，空出的槽位由当前块（取完时领取下一块）的新像素补充，
+// 工作组内的线程始终处理活动光线，而不是等待同一批中最长的一条
+// 工作组大小COMPUTE_GROUP_SIZE = COMPUTE_TILE_SIZE²（布局限定符需为字面量，由C++端一并注入）
+const uint GROUP_SIZE = uint(COMPUTE_GROUP_SIZE);
+layout(local_size_x = COMPUTE_GROUP_SIZE) in;
+layout(binding = 0, rgba16f) writeonly uniform image2D sceneImage;
+layout(std430, binding = 0) buffer TileQueue {
+    uint nextTile;
+};
+uniform vec2 computeRenderSize;           // 本帧渲染尺寸（sceneImage左下角子区域）
+
+shared RayState rays[GROUP_SIZE];
+shared ivec2 rayPixels[GROUP_SIZE];
+shared uint liveCount;                    // 槽位[0, liveCount)中为活动光线
+shared uint compactCount;
+shared uint currentTile;
+shared uint tilePixel;                    // 当前块中下一个未领取的像素（>= GROUP_SIZE表示已取完）
+shared bool queueEmpty;
+
+void main() {
+    uint lane = gl_LocalInvocationIndex;
+    ivec2 renderSize = ivec2(computeRenderSize);
+    int tilesX = (renderSize.x + COMPUTE_TILE_SIZE - 1) / COMPUTE_TILE_SIZE;
+    uint tileCount = uint(tilesX * ((renderSize.y + COMPUTE_TILE_SIZE - 1) / COMPUTE_TILE_SIZE));
     
-    FragColor = vec4(finalColor, 1.0);
+    if (lane == 0u) {
+        liveCount = 0u;
+        compactCount = 0u;
+        tilePixel = GROUP_SIZE;
+        queueEmpty = false;
+    }
+    barrier();
+    
+    while (true) {
+        // 当前块已取完且有空槽位时领取下一块
+        if (lane == 0u && tilePixel >= GROUP_SIZE && !queueEmpty && liveCount < GROUP_SIZE) {
+            uint tile = atomicAdd(nextTile, 1u);
+            if (tile < tileCount) {
+                currentTile = tile;
+                tilePixel = 0u;
+            } else {
+                queueEmpty = true;
+            }
+        }
+        barrier();
+        
+        uint live = liveCount;
+        if (live == 0u && tilePixel >= GROUP_SIZE && queueEmpty) {
+            break;
+        }
+        
+        // 空槽位[live, live + refill)从当前块补充新光线
+        uint refill = tilePixel < GROUP_SIZE ? min(GROUP_SIZE - live, GROUP_SIZE - tilePixel) : 0u;
+        bool active = lane < live;
+        RayState ray;
+        ivec2 pixel;
+        if (active) {
+            ray = rays[lane];
+            pixel = rayPixels[lane];
+        } else if (lane < live + refill) {
+            uint index = tilePixel + (lane - live);
+            ivec2 tileOrigin = ivec2(int(currentTile) % tilesX, int(currentTile) / tilesX) * COMPUTE_TILE_SIZE;
+            pixel = tileOrigin + ivec2(int(index) % COMPUTE_TILE_SIZE, int(index) / COMPUTE_TILE_SIZE);
+            if (all(lessThan(pixel, renderSize))) {
+                active = beginRay((vec2(pixel) + 0.5) / vec2(renderSize), ray);
+                if (!active) {
+                    imageStore(sceneImage, pixel, missColor());
+                }
+            }
+        }
+        
+        // 推进一段；结束的光线写出结果
+        if (active) {
+            marchRay(ray, COMPUTE_SEGMENT_STEPS);
+            if (!rayActive(ray)) {
+                imageStore(sceneImage, pixel, finishRay(ray));
+                active = false;
+            }
+        }
+        barrier();
+        
+        // 压缩：仍在步进的光线写回槽位前部（顺序不重要）
+        if (active) {
+            uint slot = atomicAdd(compactCount, 1u);
+            rays[slot] = ray;
+            rayPixels[slot] = pixel;
+        }
+        barrier();
+        if (lane == 0u) {
+            liveCount = compactCount;
+            compactCount = 0u;
+            tilePixel += refill;
+        }
+        barrier();
+    }
 }
+#endif
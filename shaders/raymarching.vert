@@ -5,7 +5,30 @@ layout (location = 1) in vec2 aTexCoord;
 
 out vec2 TexCoord;
 
+#ifdef MULTI_VIEW
+// 批量多视图（见MultiViewRenderer.h）：每个实例为一个视图，与raymarching.frag中的ViewBlock声明一致
+const int MAX_VIEWS = 64;
+struct ViewData {
+    mat4 invView;
+    mat4 invProjection;
+    vec3 cameraPos;
+    float pixelAngle;
+    vec4 viewport;                    // 图集中的NDC矩形 (x0, y0, x1, y1)
+};
+layout(std140) uniform ViewBlock {
+    ViewData views[MAX_VIEWS];
+};
+flat out int ViewIndex;
+#endif
+
 void main() {
+#ifdef MULTI_VIEW
+    // 全屏四边形缩放到该视图在图集中的矩形，TexCoord仍为视图内的[0,1]
+    vec4 rect = views[gl_InstanceID].viewport;
+    gl_Position = vec4(mix(rect.xy, rect.zw, aPos.xy * 0.5 + 0.5), 0.0, 1.0);
+    ViewIndex = gl_InstanceID;
+#else
     gl_Position = vec4(aPos, 1.0);
+#endif
     TexCoord = aTexCoord;
 }
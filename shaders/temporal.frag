@@ -0,0 +1,88 @@
+#version 330 core
+
+in vec2 TexCoord;
+out vec4 FragColor;
+
+// 时间累积：当前帧与重投影的历史帧混合（见TemporalAccumulation.h）
+// 历史按当前像素的代表深度（不透明度加权的平均距离）重建世界坐标，再用上一帧的视图/投影矩阵投影回去
+// 静止时按 1 / (帧数 + 1) 求累积平均；运动时把历史限制在当前帧3x3邻域的颜色范围内并提高当前帧权重
+uniform sampler2D currentFrame;       // rgb = 本帧颜色，a = 代表深度（沿光线距离，0 = 无可见内容）
+uniform sampler2D historyFrame;       // rgb = 累积颜色，a = 已累积帧数
+uniform vec2 renderSize;              // 本帧子区域尺寸（像素）
+uniform vec2 historyUvScale;          // 上一帧uv -> 历史纹理坐标（上一帧子区域 / 纹理尺寸）
+uniform vec2 historyTexelSize;        // 1 / 历史纹理尺寸
+uniform bool historyValid;
+uniform bool cameraStill;             // 摄像机和场景均未变化
+uniform float maxSamples;             // 静止时最多累积的帧数
+uniform float movingBlend;            // 运动时当前帧的最小权重
+
+// 当前帧摄像机（std140，与raymarching.frag共用）
+layout(std140) uniform CameraBlock {
+    mat4 invView;
+    mat4 invProjection;
+    vec3 cameraPos;
+    float time;
+};
+
+// 上一帧的视图投影矩阵
+uniform mat4 previousViewProjection;
+
+void main() {
+    ivec2 pixel = ivec2(gl_FragCoord.xy);
+    vec4 current = texelFetch(currentFrame, pixel, 0);
+    
+    if (!historyValid) {
+        FragColor = vec4(current.rgb, 1.0);
+        return;
+    }
+    
+    // 当前帧3x3邻域的颜色范围
+    ivec2 maxCoord = ivec2(renderSize) - 1;
+    vec3 minColor = current.rgb;
+    vec3 maxColor = current.rgb;
+    for (int y = -1; y <= 1; y++) {
+        for (int x = -1; x <= 1; x++) {
+            vec3 c = texelFetch(currentFrame, clamp(pixel + ivec2(x, y), ivec2(0), maxCoord), 0).rgb;
+            minColor = min(minColor, c);
+            maxColor = max(maxColor, c);
+        }
+    }
+    
+    // 重建本像素的光线，代表深度处的点投影到上一帧；没有可见内容时按无穷远方向投影（只受旋转影响）
+    vec2 uv = (vec2(pixel) + 0.5) / renderSize;
+    vec4 viewPos = invProjection * vec4(uv * 2.0 - 1.0, -1.0, 1.0);
+    viewPos /= viewPos.w;
+    vec3 rayDir = normalize((invView * vec4(viewPos.xyz, 0.0)).xyz);
+    vec4 previousClip = current.a > 0.0
+        ? previousViewProjection * vec4(cameraPos + rayDir * current.a, 1.0)
+        : previousViewProjection * vec4(rayDir, 0.0);
+    vec2 previousUv = previousClip.xy / previousClip.w * 0.5 + 0.5;
+    
+    // 上一帧不可见（移入画面或位于摄像机后方）：没有历史
+    if (previousClip.w <= 0.0 || any(lessThan(previousUv, vec2(0.0))) || any(greaterThan(previousUv, vec2(1.0)))) {
+        FragColor = vec4(current.rgb, 1.0);
+        return;
+    }
+    
+    // 双线性采样历史子区域，坐标限制在边缘纹素中心以内，避免采到子区域外的旧内容
+    vec2 historyCoord = clamp(previousUv * historyUvScale, 0.5 * historyTexelSize, historyUvScale - 0.5 * historyTexelSize);
+    vec4 history = texture(historyFrame, historyCoord);
+    
+    // 静止时邻域范围向两侧各放宽一倍，只拒绝明显的变化（如块载入）而保留已收敛的平均值；运动时严格约束
+    if (cameraStill) {
+        vec3 extent = maxColor - minColor;
+        minColor -= extent;
+        maxColor += extent;
+    }
+    vec3 clampedHistory = clamp(history.rgb, minColor, maxColor);
+    
+    // 帧数即历史的权重；运动或历史被拒绝时限制帧数，使当前帧权重不低于movingBlend
+    float count = min(history.a, maxSamples - 1.0);
+    float movingCount = 1.0 / movingBlend - 1.0;
+    if (!cameraStill || distance(clampedHistory, history.rgb) > 1.0 / 255.0) {
+        count = min(count, movingCount);
+    }
+    
+    vec3 color = mix(clampedHistory, current.rgb, 1.0 / (count + 1.0));
+    FragColor = vec4(color, count + 1.0);
+}
@@ -0,0 +1,44 @@
+#version 330 core
+
+in vec2 TexCoord;
+out vec4 FragColor;
+
+// 动态分辨率的边缘保持上采样
+// 在双线性的4个低分辨率像素上再乘以与最近像素的亮度相似度权重（以颜色自身为引导的联合双边上采样），
+// 平坦区域等同于双线性插值，边缘两侧的像素互不混合，避免放大后的发糊和光晕
+uniform sampler2D sceneTexture;
+uniform vec2 renderSize;              // 离屏纹理中实际渲染的子区域尺寸（像素）
+
+const float EDGE_SHARPNESS = 60.0;    // 亮度差为0.13时权重约降为1/e
+
+float luminance(vec3 c) {
+    return dot(c, vec3(0.299, 0.587, 0.114));
+}
+
+void main() {
+    // 输出像素中心在低分辨率子区域中的位置（纹素中心位于整数 + 0.5）
+    vec2 pos = TexCoord * renderSize - 0.5;
+    vec2 base = floor(pos);
+    vec2 f = pos - base;
+    
+    ivec2 maxCoord = ivec2(renderSize) - 1;
+    ivec2 p00 = clamp(ivec2(base), ivec2(0), maxCoord);
+    ivec2 p11 = clamp(ivec2(base) + 1, ivec2(0), maxCoord);
+    
+    vec3 c00 = texelFetch(sceneTexture, p00, 0).rgb;
+    vec3 c10 = texelFetch(sceneTexture, ivec2(p11.x, p00.y), 0).rgb;
+    vec3 c01 = texelFetch(sceneTexture, ivec2(p00.x, p11.y), 0).rgb;
+    vec3 c11 = texelFetch(sceneTexture, p11, 0).rgb;
+    
+    // 引导值取距离最近的低分辨率像素
+    vec3 nearest = f.y < 0.5 ? (f.x < 0.5 ? c00 : c10) : (f.x < 0.5 ? c01 : c11);
+    float reference = luminance(nearest);
+    
+    vec4 d = vec4(luminance(c00), luminance(c10), luminance(c01), luminance(c11)) - reference;
+    vec4 w = vec4((1.0 - f.x) * (1.0 - f.y), f.x * (1.0 - f.y), (1.0 - f.x) * f.y, f.x * f.y);
+    w *= exp(-EDGE_SHARPNESS * d * d);
+    
+    // 最近像素的权重不小于0.25，总权重不会为0
+    vec3 color = (c00 * w.x + c10 * w.y + c01 * w.z + c11 * w.w) / (w.x + w.y + w.z + w.w);
+    FragColor = vec4(color, 1.0);
+}
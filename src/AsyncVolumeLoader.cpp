@@ -0,0 +1,246 @@
+#include "AsyncVolumeLoader.h"
+#include "MappedFile.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+AsyncVolumeLoader::AsyncVolumeLoader()
+    : state(State::Idle), width(0), height(0), depth(0),
+      gradientFilter(GradientFilter::CentralDifference), slicesPerChunk(1),
+      cancelRequested(false), workerFailed(false), workerFinished(false),
+      nextPbo(0), uploadedSlices(0), totalSlices(0) {
+    for (int i = 0; i < PBO_COUNT; i++) {
+        pbos[i] = 0;
+        fences[i] = nullptr;
+    }
+}
+
+AsyncVolumeLoader::~AsyncVolumeLoader() {
+    Cancel();
+}
+
+bool AsyncVolumeLoader::Start(const std::string& file, int w, int h, int d, GradientFilter filter) {
+    Cancel();
+    
+    filename = file;
+    width = w;
+    height = h;
+    depth = d;
+    gradientFilter = filter;
+    
+    const uint64_t sliceBytes = (uint64_t)width * height * 4;
+    slicesPerChunk = (int)std::max<uint64_t>(1, CHUNK_BYTES / sliceBytes);
+    slicesPerChunk = std::min(slicesPerChunk, depth);
+    
+    // 新体数据在后台填充，完成前不影响当前显示的体数据
+    pendingVolume = std::make_unique<VolumeData>();
+    pendingVolume->SetGradientFilter(filter);
+    if (!pendingVolume->BeginUpload(width, height, depth)) {
+        pendingVolume.reset();
+        state = State::Failed;
+        return false;
+    }
+    
+    GLsizeiptr chunkBytes = (GLsizeiptr)(sliceBytes * slicesPerChunk);
+    glGenBuffers(PBO_COUNT, pbos);
+    for (int i = 0; i < PBO_COUNT; i++) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbos[i]);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, chunkBytes, nullptr, GL_STREAM_DRAW);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    nextPbo = 0;
+    uploadedSlices = 0;
+    totalSlices = 0;
+    for (int level = 0; level < pendingVolume->GetLodLevelCount(); level++) {
+        totalSlices += pendingVolume->GetLodLevelSize(level).z;
+    }
+    
+    cancelRequested = false;
+    workerFailed = false;
+    workerFinished = false;
+    readyChunks.clear();
+    state = State::Loading;
+    worker = std::thread(&AsyncVolumeLoader::WorkerMain, this);
+    
+    std::cout << "Started async volume load: " << filename << std::endl;
+    return true;
+}
+
+void AsyncVolumeLoader::WorkerMain() {
+    MappedFile file;
+    uint64_t dataSize = (uint64_t)width * (uint64_t)height * (uint64_t)depth;
+    if (!file.Open(filename) || file.GetSize() < dataSize) {
+        std::cerr << "Failed to read volume data file: " << filename << std::endl;
+        workerFailed = true;
+        std::lock_guard<std::mutex> lock(queueMutex);
+        workerFinished = true;
+        return;
+    }
+    file.AdviseSequential();
+    
+    const uint64_t sliceVoxels = (uint64_t)width * height;
+    for (int z0 = 0; z0 < depth && !cancelRequested; z0 += slicesPerChunk) {
+        int z1 = std::min(z0 + slicesPerChunk, depth);
+        
+        Chunk chunk;
+        chunk.level = 0;
+        chunk.zBegin = z0;
+        chunk.zEnd = z1;
+        chunk.packed.resize((size_t)(sliceVoxels * 4 * (z1 - z0)));
+        VolumeGradient::ComputePacked(file.GetData(), width, height, depth, z0, z1, gradientFilter, chunk.packed.data());
+        pendingVolume->AccumulateMacrocells(file.GetData(), z0, z1);
+        pendingVolume->AccumulateLod(file.GetData(), z0, z1);
+        file.Release(0, (uint64_t)std::max(z1 - 1, 0) * sliceVoxels);
+        
+        if (!PushChunk(std::move(chunk))) break;
+    }
+    file.Close();
+    
+    // 其余LOD层级也在本线程下采样并计算梯度，按不超过PBO大小的块排队上传，
+    // 完成帧不再有整层的CPU计算和大块上传
+    std::vector<unsigned char> levelDensity;
+    if (!cancelRequested) {
+        levelDensity = pendingVolume->TakeLodDensity();
+    }
+    const uint64_t pboBytes = sliceVoxels * 4 * slicesPerChunk;
+    for (int level = 1; level < pendingVolume->GetLodLevelCount() && !cancelRequested; level++) {
+        if (level > 1) {
+            std::vector<unsigned char> nextDensity;
+            pendingVolume->DownsampleLodLevel(level, levelDensity, nextDensity);
+            levelDensity.swap(nextDensity);
+        }
+        
+        glm::ivec3 size = pendingVolume->GetLodLevelSize(level);
+        const uint64_t levelSliceBytes = (uint64_t)size.x * size.y * 4;
+        const int levelSlices = (int)std::max<uint64_t>(1, pboBytes / levelSliceBytes);
+        for (int z0 = 0; z0 < size.z && !cancelRequested; z0 += levelSlices) {
+            int z1 = std::min(z0 + levelSlices, size.z);
+            
+            Chunk chunk;
+            chunk.level = level;
+            chunk.zBegin = z0;
+            chunk.zEnd = z1;
+            chunk.packed.resize((size_t)(levelSliceBytes * (z1 - z0)));
+            VolumeGradient::ComputePacked(levelDensity.data(), size.x, size.y, size.z, z0, z1, gradientFilter,
+                                          chunk.packed.data());
+            if (!PushChunk(std::move(chunk))) break;
+        }
+    }
+    
+    std::lock_guard<std::mutex> lock(queueMutex);
+    workerFinished = true;
+}
+
+bool AsyncVolumeLoader::PushChunk(Chunk&& chunk) {
+    std::unique_lock<std::mutex> lock(queueMutex);
+    queueCondition.wait(lock, [this]() {
+        return cancelRequested || (int)readyChunks.size() < MAX_QUEUED_CHUNKS;
+    });
+    if (cancelRequested) return false;
+    readyChunks.push_back(std::move(chunk));
+    return true;
+}
+
+AsyncVolumeLoader::State AsyncVolumeLoader::Update(int chunksPerFrame) {
+    if (state != State::Loading) {
+        return state;
+    }
+    
+    for (int i = 0; i < chunksPerFrame; i++) {
+        // 下一个PBO仍在被GPU读取时本帧不再上传，避免阻塞
+        GLsync& fence = fences[nextPbo];
+        if (fence) {
+            GLenum status = glClientWaitSync(fence, 0, 0);
+            if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+                break;
+            }
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+        
+        Chunk chunk;
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            if (readyChunks.empty()) break;
+            chunk = std::move(readyChunks.front());
+            readyChunks.pop_front();
+        }
+        queueCondition.notify_one();
+        
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbos[nextPbo]);
+        void* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, (GLsizeiptr)chunk.packed.size(),
+                                        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+        if (mapped) {
+            std::memcpy(mapped, chunk.packed.data(), chunk.packed.size());
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+            pendingVolume->UploadSlices(chunk.zBegin, chunk.zEnd, nullptr, chunk.level);
+        } else {
+            // 映射失败时退回直接上传
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            pendingVolume->UploadSlices(chunk.zBegin, chunk.zEnd, chunk.packed.data(), chunk.level);
+        }
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        
+        fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        nextPbo = (nextPbo + 1) % PBO_COUNT;
+        uploadedSlices += chunk.zEnd - chunk.zBegin;
+    }
+    
+    if (workerFailed) {
+        Cancel();
+        state = State::Failed;
+    } else if (uploadedSlices >= totalSlices) {
+        // 各LOD层级已经上传，完成帧只创建宏单元占用纹理
+        worker.join();
+        ReleaseGLResources();
+        if (pendingVolume->FinishUpload(false)) {
+            state = State::Completed;
+            std::cout << "Async volume load completed: " << filename << std::endl;
+        } else {
+            pendingVolume.reset();
+            state = State::Failed;
+        }
+    }
+    return state;
+}
+
+void AsyncVolumeLoader::Cancel() {
+    cancelRequested = true;
+    queueCondition.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+    readyChunks.clear();
+    ReleaseGLResources();
+    pendingVolume.reset();
+    state = State::Idle;
+}
+
+std::unique_ptr<VolumeData> AsyncVolumeLoader::TakeResult() {
+    if (state != State::Completed) {
+        return nullptr;
+    }
+    state = State::Idle;
+    return std::move(pendingVolume);
+}
+
+float AsyncVolumeLoader::GetProgress() const {
+    if (state == State::Completed) return 1.0f;
+    if (totalSlices <= 0) return 0.0f;
+    return (float)uploadedSlices / (float)totalSlices;
+}
+
+void AsyncVolumeLoader::ReleaseGLResources() {
+    for (int i = 0; i < PBO_COUNT; i++) {
+        if (fences[i]) {
+            glDeleteSync(fences[i]);
+            fences[i] = nullptr;
+        }
+    }
+    if (pbos[0] != 0) {
+        glDeleteBuffers(PBO_COUNT, pbos);
+        for (int i = 0; i < PBO_COUNT; i++) {
+            pbos[i] = 0;
+        }
+    }
+}
@@ -0,0 +1,383 @@
+#include "BrickCache.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <thread>
+
+BrickCache::BrickCache()
+    : width(0), height(0), depth(0), gradientFilter(GradientFilter::CentralDifference),
+      brickGridSize(0), atlasSlots(0), frameIndex(0),
+      atlasTexture(0), pageTableTexture(0), feedbackTexture(0), feedbackFBO(0),
+      feedbackWidth(0), feedbackHeight(0), nextFeedbackPbo(0), lastFeedbackMissing(true),
+      inFlightLoads(0) {
+    for (int i = 0; i < 2; i++) {
+        feedbackPBOs[i] = 0;
+        feedbackFences[i] = nullptr;
+        feedbackPboSize[i] = 0;
+    }
+}
+
+BrickCache::~BrickCache() {
+    // 等待后台加载任务结束（任务引用了映射文件和就绪队列）
+    while (inFlightLoads > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    Release();
+}
+
+bool BrickCache::Open(const std::string& filename, int w, int h, int d,
+                      GradientFilter filter, uint64_t atlasBudgetBytes) {
+    width = w;
+    height = h;
+    depth = d;
+    gradientFilter = filter;
+    
+    if (!file.Open(filename)) {
+        std::cerr << "Failed to open volume data file: " << filename << std::endl;
+        return false;
+    }
+    uint64_t dataSize = (uint64_t)width * (uint64_t)height * (uint64_t)depth;
+    if (file.GetSize() < dataSize) {
+        std::cerr << "Failed to read complete volume data: expected " << dataSize
+                  << " bytes, file has " << file.GetSize() << std::endl;
+        return false;
+    }
+    
+    const int B = BRICK_SIZE;
+    brickGridSize = glm::ivec3((width + B - 1) / B, (height + B - 1) / B, (depth + B - 1) / B);
+    uint64_t brickCount = (uint64_t)brickGridSize.x * brickGridSize.y * brickGridSize.z;
+    
+    // 图集槽位数：受显存预算、最大3D纹理尺寸和页表编码（每轴最多256个槽位）限制
+    GLint maxTextureSize = 0;
+    glGetIntegerv(GL_MAX_3D_TEXTURE_SIZE, &maxTextureSize);
+    int maxSlotsPerAxis = std::min(maxTextureSize / BRICK_STORAGE, 256);
+    uint64_t bytesPerBrick = (uint64_t)BRICK_STORAGE * BRICK_STORAGE * BRICK_STORAGE * 4;
+    uint64_t slotBudget = std::max<uint64_t>(1, std::min(atlasBudgetBytes / bytesPerBrick, brickCount));
+    int n = std::max(1, std::min(maxSlotsPerAxis, (int)std::cbrt((double)slotBudget)));
+    int nz = (int)std::max<uint64_t>(1, std::min<uint64_t>(maxSlotsPerAxis, slotBudget / ((uint64_t)n * n)));
+    atlasSlots = glm::ivec3(n, n, nz);
+    
+    glm::ivec3 atlasSize = atlasSlots * BRICK_STORAGE;
+    glGenTextures(1, &atlasTexture);
+    glBindTexture(GL_TEXTURE_3D, atlasTexture);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexImage3D(GL_TEXTURE_3D, 0, GL_RGBA8, atlasSize.x, atlasSize.y, atlasSize.z,
+                 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    
+    // 页表：每个块一个texel，初始全部不驻留
+    pageTable.assign((size_t)brickCount * 4, 0);
+    glGenTextures(1, &pageTableTexture);
+    glBindTexture(GL_TEXTURE_3D, pageTableTexture);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexImage3D(GL_TEXTURE_3D, 0, GL_RGBA8, brickGridSize.x, brickGridSize.y, brickGridSize.z,
+                 0, GL_RGBA, GL_UNSIGNED_BYTE, pageTable.data());
+    glBindTexture(GL_TEXTURE_3D, 0);
+    
+    int slotCount = atlasSlots.x * atlasSlots.y * atlasSlots.z;
+    freeSlots.clear();
+    for (int slot = slotCount - 1; slot >= 0; slot--) {
+        freeSlots.push_back(slot);
+    }
+    
+    std::cout << "Opened bricked volume: " << width << "x" << height << "x" << depth
+              << ", " << brickCount << " bricks, atlas " << atlasSlots.x << "x" << atlasSlots.y
+              << "x" << atlasSlots.z << " slots (" << (slotCount * bytesPerBrick >> 20) << " MB)" << std::endl;
+    return true;
+}
+
+void BrickCache::BeginFeedback(int screenWidth, int screenHeight) {
+    int w = std::max(1, screenWidth / FEEDBACK_DIVISOR);
+    int h = std::max(1, screenHeight / FEEDBACK_DIVISOR);
+    if (w != feedbackWidth || h != feedbackHeight) {
+        CreateFeedbackTarget(w, h);
+    }
+    
+    glBindFramebuffer(GL_FRAMEBUFFER, feedbackFBO);
+    glViewport(0, 0, feedbackWidth, feedbackHeight);
+    
+    // 反馈写入片段着色器的location 1输出
+    const GLuint zero[4] = { 0, 0, 0, 0 };
+    glClearBufferuiv(GL_COLOR, 1, zero);
+}
+
+void BrickCache::EndFeedback(int screenWidth, int screenHeight) {
+    // 异步回读到PBO，下一次Update时再映射
+    int index = nextFeedbackPbo;
+    if (feedbackFences[index]) {
+        glDeleteSync(feedbackFences[index]);
+        feedbackFences[index] = nullptr;
+    }
+    
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, feedbackPBOs[index]);
+    glReadPixels(0, 0, feedbackWidth, feedbackHeight, GL_RG_INTEGER, GL_UNSIGNED_INT, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    feedbackFences[index] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    feedbackPboSize[index] = feedbackWidth * feedbackHeight;
+    nextFeedbackPbo = (index + 1) % 2;
+    
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, screenWidth, screenHeight);
+}
+
+void BrickCache::Update() {
+    frameIndex++;
+    ProcessFeedback();
+    UploadLoadedBricks();
+}
+
+void BrickCache::Bind(GLuint atlasUnit, GLuint pageTableUnit) const {
+    glActiveTexture(GL_TEXTURE0 + atlasUnit);
+    glBindTexture(GL_TEXTURE_3D, atlasTexture);
+    glActiveTexture(GL_TEXTURE0 + pageTableUnit);
+    glBindTexture(GL_TEXTURE_3D, pageTableTexture);
+}
+
+void BrickCache::ProcessFeedback() {
+    // 读取较早一次的反馈（GPU已完成时才映射，不阻塞）
+    int index = nextFeedbackPbo;
+    GLsync& fence = feedbackFences[index];
+    if (!fence) return;
+    GLenum status = glClientWaitSync(fence, 0, 0);
+    if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) return;
+    glDeleteSync(fence);
+    fence = nullptr;
+    
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, feedbackPBOs[index]);
+    const GLuint* pixels = static_cast<const GLuint*>(
+        glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, feedbackPboSize[index] * 2 * sizeof(GLuint), GL_MAP_READ_BIT));
+    if (!pixels) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        return;
+    }
+    
+    // r = 光线遇到的第一个未驻留块 + 1，g = 光线访问过的某个块 + 1（蓄水池采样）
+    std::unordered_map<uint32_t, int> requests;
+    for (int i = 0; i < feedbackPboSize[index]; i++) {
+        GLuint missing = pixels[i * 2 + 0];
+        GLuint touched = pixels[i * 2 + 1];
+        if (missing != 0) {
+            requests[missing - 1]++;
+        }
+        if (touched != 0) {
+            TouchBrick(touched - 1);
+        }
+    }
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    lastFeedbackMissing = !requests.empty();
+    
+    // 被更多光线请求的块优先加载
+    std::vector<std::pair<int, uint32_t>> ordered;
+    ordered.reserve(requests.size());
+    for (const auto& request : requests) {
+        ordered.emplace_back(request.second, request.first);
+    }
+    std::sort(ordered.begin(), ordered.end(), [](const std::pair<int, uint32_t>& a, const std::pair<int, uint32_t>& b) {
+        return a.first > b.first;
+    });
+    for (const auto& request : ordered) {
+        if ((int)pendingBricks.size() >= MAX_PENDING_LOADS) break;
+        RequestBrick(request.second);
+    }
+}
+
+void BrickCache::RequestBrick(uint32_t brickIndex) {
+    uint64_t brickCount = (uint64_t)brickGridSize.x * brickGridSize.y * brickGridSize.z;
+    if (brickIndex >= brickCount) return;
+    if (pendingBricks.count(brickIndex) || residentBricks.count(brickIndex)) return;
+    if (pageTable[(size_t)brickIndex * 4 + 3] == PAGE_EMPTY) return;
+    
+    pendingBricks.insert(brickIndex);
+    inFlightLoads++;
+    
+    // 在线程池中从映射文件读取块（含边缘）并预计算梯度
+    ThreadPool::Shared().Submit([this, brickIndex]() {
+        int bx = (int)(brickIndex % brickGridSize.x);
+        int by = (int)((brickIndex / brickGridSize.x) % brickGridSize.y);
+        int bz = (int)(brickIndex / ((uint32_t)brickGridSize.x * brickGridSize.y));
+        
+        LoadedBrick brick;
+        brick.brickIndex = brickIndex;
+        brick.packed.resize((size_t)BRICK_STORAGE * BRICK_STORAGE * BRICK_STORAGE * 4);
+        VolumeGradient::ComputePackedRegion(file.GetData(), width, height, depth,
+                                            bx * BRICK_SIZE - BRICK_APRON, by * BRICK_SIZE - BRICK_APRON,
+                                            bz * BRICK_SIZE - BRICK_APRON,
+                                            BRICK_STORAGE, BRICK_STORAGE, BRICK_STORAGE,
+                                            gradientFilter, brick.packed.data());
+        
+        // 全零的块不占用图集槽位
+        brick.empty = true;
+        for (size_t i = 3; i < brick.packed.size(); i += 4) {
+            if (brick.packed[i] != 0) {
+                brick.empty = false;
+                break;
+            }
+        }
+        if (brick.empty) {
+            brick.packed.clear();
+        }
+        
+        {
+            std::lock_guard<std::mutex> lock(loadedMutex);
+            loadedBricks.push_back(std::move(brick));
+        }
+        inFlightLoads--;
+    });
+}
+
+void BrickCache::UploadLoadedBricks() {
+    std::vector<LoadedBrick> ready;
+    {
+        std::lock_guard<std::mutex> lock(loadedMutex);
+        int count = std::min((int)loadedBricks.size(), MAX_UPLOADS_PER_FRAME);
+        ready.assign(std::make_move_iterator(loadedBricks.begin()),
+                     std::make_move_iterator(loadedBricks.begin() + count));
+        loadedBricks.erase(loadedBricks.begin(), loadedBricks.begin() + count);
+    }
+    
+    glBindTexture(GL_TEXTURE_3D, atlasTexture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    for (LoadedBrick& brick : ready) {
+        pendingBricks.erase(brick.brickIndex);
+        
+        if (brick.empty) {
+            SetPageEntry(brick.brickIndex, 0, PAGE_EMPTY);
+            continue;
+        }
+        
+        // 没有可用槽位时丢弃，之后的反馈会再次请求
+        int slot = AllocateSlot();
+        if (slot < 0) continue;
+        
+        int sx = slot % atlasSlots.x;
+        int sy = (slot / atlasSlots.x) % atlasSlots.y;
+        int sz = slot / (atlasSlots.x * atlasSlots.y);
+        glBindTexture(GL_TEXTURE_3D, atlasTexture);
+        glTexSubImage3D(GL_TEXTURE_3D, 0, sx * BRICK_STORAGE, sy * BRICK_STORAGE, sz * BRICK_STORAGE,
+                        BRICK_STORAGE, BRICK_STORAGE, BRICK_STORAGE, GL_RGBA, GL_UNSIGNED_BYTE, brick.packed.data());
+        
+        lruList.push_front(brick.brickIndex);
+        residentBricks[brick.brickIndex] = ResidentBrick{ slot, frameIndex, lruList.begin() };
+        SetPageEntry(brick.brickIndex, slot, PAGE_RESIDENT);
+    }
+    glBindTexture(GL_TEXTURE_3D, 0);
+}
+
+void BrickCache::TouchBrick(uint32_t brickIndex) {
+    auto it = residentBricks.find(brickIndex);
+    if (it == residentBricks.end()) return;
+    it->second.lastUsedFrame = frameIndex;
+    lruList.splice(lruList.begin(), lruList, it->second.lruPosition);
+}
+
+int BrickCache::AllocateSlot() {
+    if (!freeSlots.empty()) {
+        int slot = freeSlots.back();
+        freeSlots.pop_back();
+        return slot;
+    }
+    
+    // 淘汰最久未使用的块，最近两帧内被访问过的块不淘汰（避免抖动）
+    if (lruList.empty()) return -1;
+    uint32_t victim = lruList.back();
+    ResidentBrick& resident = residentBricks[victim];
+    if (resident.lastUsedFrame + 2 > frameIndex) return -1;
+    
+    int slot = resident.slot;
+    lruList.pop_back();
+    residentBricks.erase(victim);
+    SetPageEntry(victim, 0, PAGE_NOT_RESIDENT);
+    return slot;
+}
+
+void BrickCache::SetPageEntry(uint32_t brickIndex, int slot, unsigned char flag) {
+    unsigned char* entry = &pageTable[(size_t)brickIndex * 4];
+    entry[0] = (unsigned char)(slot % atlasSlots.x);
+    entry[1] = (unsigned char)((slot / atlasSlots.x) % atlasSlots.y);
+    entry[2] = (unsigned char)(slot / (atlasSlots.x * atlasSlots.y));
+    entry[3] = flag;
+    
+    int bx = (int)(brickIndex % brickGridSize.x);
+    int by = (int)((brickIndex / brickGridSize.x) % brickGridSize.y);
+    int bz = (int)(brickIndex / ((uint32_t)brickGridSize.x * brickGridSize.y));
+    glBindTexture(GL_TEXTURE_3D, pageTableTexture);
+    glTexSubImage3D(GL_TEXTURE_3D, 0, bx, by, bz, 1, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE, entry);
+}
+
+void BrickCache::CreateFeedbackTarget(int w, int h) {
+    feedbackWidth = w;
+    feedbackHeight = h;
+    
+    if (feedbackTexture == 0) {
+        glGenTextures(1, &feedbackTexture);
+        glGenFramebuffers(1, &feedbackFBO);
+        glGenBuffers(2, feedbackPBOs);
+    }
+    
+    glBindTexture(GL_TEXTURE_2D, feedbackTexture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RG32UI, w, h, 0, GL_RG_INTEGER, GL_UNSIGNED_INT, nullptr);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    
+    glBindFramebuffer(GL_FRAMEBUFFER, feedbackFBO);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, feedbackTexture, 0);
+    // 片段输出location 0丢弃，location 1写入反馈纹理
+    const GLenum drawBuffers[2] = { GL_NONE, GL_COLOR_ATTACHMENT0 };
+    glDrawBuffers(2, drawBuffers);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "Brick feedback framebuffer is incomplete" << std::endl;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    
+    for (int i = 0; i < 2; i++) {
+        if (feedbackFences[i]) {
+            glDeleteSync(feedbackFences[i]);
+            feedbackFences[i] = nullptr;
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, feedbackPBOs[i]);
+        glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr)w * h * 2 * sizeof(GLuint), nullptr, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+void BrickCache::Release() {
+    for (int i = 0; i < 2; i++) {
+        if (feedbackFences[i]) {
+            glDeleteSync(feedbackFences[i]);
+            feedbackFences[i] = nullptr;
+        }
+    }
+    if (feedbackPBOs[0] != 0) {
+        glDeleteBuffers(2, feedbackPBOs);
+        feedbackPBOs[0] = feedbackPBOs[1] = 0;
+    }
+    if (feedbackFBO != 0) {
+        glDeleteFramebuffers(1, &feedbackFBO);
+        feedbackFBO = 0;
+    }
+    if (feedbackTexture != 0) {
+        glDeleteTextures(1, &feedbackTexture);
+        feedbackTexture = 0;
+    }
+    if (pageTableTexture != 0) {
+        glDeleteTextures(1, &pageTableTexture);
+        pageTableTexture = 0;
+    }
+    if (atlasTexture != 0) {
+        glDeleteTextures(1, &atlasTexture);
+        atlasTexture = 0;
+    }
+}
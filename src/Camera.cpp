@@ -1,7 +1,11 @@
 #include "Camera.h"
+#include <cmath>
 
 CameraController::CameraController() {
     UpdateCameraVectors();
+    lastPosition = camera.position;
+    lastFront = camera.front;
+    lastFov = camera.fov;
 }
 
 glm::mat4 CameraController::GetViewMatrix() const {
@@ -13,6 +17,36 @@ glm::mat4 CameraController::GetProjectionMatrix() const {
                            camera.nearPlane, camera.farPlane);
 }
 
+glm::mat4 CameraController::GetInverseViewMatrix() const {
+    return ComputeInverseViewMatrix(camera);
+}
+
+glm::mat4 CameraController::GetInverseProjectionMatrix() const {
+    return ComputeInverseProjectionMatrix(camera);
+}
+
+glm::mat4 CameraController::ComputeInverseViewMatrix(const Camera& camera) {
+    // 视图矩阵是刚体变换：逆矩阵的列即glm::lookAt使用的右、上、后方向和摄像机位置
+    glm::vec3 f = glm::normalize(camera.front);
+    glm::vec3 s = glm::normalize(glm::cross(f, camera.up));
+    glm::vec3 u = glm::cross(s, f);
+    return glm::mat4(glm::vec4(s, 0.0f), glm::vec4(u, 0.0f), glm::vec4(-f, 0.0f), glm::vec4(camera.position, 1.0f));
+}
+
+glm::mat4 CameraController::ComputeInverseProjectionMatrix(const Camera& camera) {
+    // glm::perspective的逆：x、y按视场缩放，z/w由近远平面决定
+    float tanHalfFov = std::tan(glm::radians(camera.fov) * 0.5f);
+    float n = camera.nearPlane;
+    float f = camera.farPlane;
+    glm::mat4 inverse(0.0f);
+    inverse[0][0] = camera.aspectRatio * tanHalfFov;
+    inverse[1][1] = tanHalfFov;
+    inverse[2][3] = -(f - n) / (2.0f * f * n);
+    inverse[3][2] = -1.0f;
+    inverse[3][3] = (f + n) / (2.0f * f * n);
+    return inverse;
+}
+
 void CameraController::ProcessKeyboard(int direction, float deltaTime) {
     float velocity = camera.movementSpeed * deltaTime;
     
@@ -64,6 +98,15 @@ void CameraController::ProcessMouseScroll(float yoffset) {
         camera.fov = 90.0f;
 }
 
+bool CameraController::ConsumeMovement() {
+    // 直接比较状态而不是在各输入处理函数中置标志，外部修改GetCamera()同样能被检测到
+    bool moved = camera.position != lastPosition || camera.front != lastFront || camera.fov != lastFov;
+    lastPosition = camera.position;
+    lastFront = camera.front;
+    lastFov = camera.fov;
+    return moved;
+}
+
 void CameraController::UpdateCameraVectors() {
     glm::vec3 front;
     front.x = cos(glm::radians(camera.yaw)) * cos(glm::radians(camera.pitch));
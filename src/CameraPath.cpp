@@ -0,0 +1,95 @@
+#include "CameraPath.h"
+#include "Camera.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+void CameraPath::AddKeyframe(const Camera& camera) {
+    keyframes.push_back({ camera.position, camera.yaw, camera.pitch, camera.fov });
+}
+
+bool CameraPath::Load(const std::string& filename) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open camera path: " << filename << std::endl;
+        return false;
+    }
+    
+    std::vector<Keyframe> loaded;
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        lineNumber++;
+        if (line.empty() || line[0] == '#') continue;
+        
+        std::istringstream stream(line);
+        Keyframe keyframe;
+        if (!(stream >> keyframe.position.x >> keyframe.position.y >> keyframe.position.z
+                     >> keyframe.yaw >> keyframe.pitch >> keyframe.fov)) {
+            std::cerr << "Invalid camera keyframe at " << filename << ":" << lineNumber << std::endl;
+            return false;
+        }
+        loaded.push_back(keyframe);
+    }
+    
+    if (loaded.empty()) {
+        std::cerr << "Camera path has no keyframes: " << filename << std::endl;
+        return false;
+    }
+    keyframes = std::move(loaded);
+    return true;
+}
+
+bool CameraPath::Save(const std::string& filename) const {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open file: " << filename << std::endl;
+        return false;
+    }
+    
+    file << "# px py pz yaw pitch fov\n";
+    for (const Keyframe& keyframe : keyframes) {
+        file << keyframe.position.x << " " << keyframe.position.y << " " << keyframe.position.z << " "
+             << keyframe.yaw << " " << keyframe.pitch << " " << keyframe.fov << "\n";
+    }
+    return true;
+}
+
+void CameraPath::Apply(int index, Camera& camera) const {
+    if (keyframes.empty()) return;
+    
+    int count = (int)keyframes.size();
+    const Keyframe& keyframe = keyframes[((index % count) + count) % count];
+    
+    // 通过CameraController按欧拉角重建朝向向量，与交互时的约定一致
+    CameraController controller;
+    Camera& target = controller.GetCamera();
+    target = camera;
+    target.position = keyframe.position;
+    target.yaw = keyframe.yaw;
+    target.pitch = keyframe.pitch;
+    target.fov = keyframe.fov;
+    controller.UpdateCameraVectors();
+    camera = target;
+}
+
+CameraPath CameraPath::CreateOrbit(int frames, float radius, float height) {
+    CameraPath path;
+    const float PI = 3.14159265358979f;
+    for (int i = 0; i < frames; i++) {
+        float angle = 2.0f * PI * i / std::max(frames, 1);
+        glm::vec3 position(radius * std::sin(angle), height, radius * std::cos(angle));
+        
+        // front = (cos(yaw)cos(pitch), sin(pitch), sin(yaw)cos(pitch)) 指向原点
+        glm::vec3 direction = glm::normalize(-position);
+        Keyframe keyframe;
+        keyframe.position = position;
+        keyframe.yaw = glm::degrees(std::atan2(direction.z, direction.x));
+        keyframe.pitch = glm::degrees(std::asin(direction.y));
+        keyframe.fov = 45.0f;
+        path.keyframes.push_back(keyframe);
+    }
+    return path;
+}
@@ -0,0 +1,67 @@
+#include "ComputeRayMarcher.h"
+#include <algorithm>
+#include <iostream>
+
+ComputeRayMarcher::ComputeRayMarcher() : queueBuffer(0) {
+}
+
+ComputeRayMarcher::~ComputeRayMarcher() {
+    Release();
+}
+
+bool ComputeRayMarcher::IsSupported() {
+    return GLAD_GL_VERSION_4_3 != 0;
+}
+
+bool ComputeRayMarcher::Initialize(const std::function<void(Shader&)>& setup) {
+    if (!IsSupported()) {
+        std::cerr << "Compute ray marching requires OpenGL 4.3" << std::endl;
+        return false;
+    }
+    
+    // 块尺寸和每段迭代数注入shader，与此处的常量保持一致
+    std::string baseDefines = "#define COMPUTE_PATH 1\n";
+    baseDefines += "#define COMPUTE_TILE_SIZE " + std::to_string(TILE_SIZE) + "\n";
+    baseDefines += "#define COMPUTE_GROUP_SIZE " + std::to_string(TILE_SIZE * TILE_SIZE) + "\n";
+    baseDefines += "#define COMPUTE_SEGMENT_STEPS " + std::to_string(SEGMENT_STEPS) + "\n";
+    shaders = ShaderCache::CreateCompute("shaders/raymarching.frag", baseDefines, setup);
+    if (!shaders->Initialize()) {
+        std::cerr << "Failed to load compute ray marching shader" << std::endl;
+        return false;
+    }
+    
+    glGenBuffers(1, &queueBuffer);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, queueBuffer);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(GLuint), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    return true;
+}
+
+void ComputeRayMarcher::Dispatch(uint64_t key, GLuint targetTexture, int width, int height) {
+    int tileCount = ((width + TILE_SIZE - 1) / TILE_SIZE) * ((height + TILE_SIZE - 1) / TILE_SIZE);
+    if (tileCount <= 0) return;
+    
+    // 队列清零（上一帧的派发读完之前驱动会保持顺序）
+    const GLuint zero = 0;
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, queueBuffer);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof(GLuint), &zero);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, queueBuffer);
+    glBindImageTexture(0, targetTexture, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+    
+    Shader& shader = shaders->Get(key);
+    shader.Use();
+    shader.SetVec2("computeRenderSize", glm::vec2((float)width, (float)height));
+    glDispatchCompute((GLuint)std::min(tileCount, MAX_PERSISTENT_GROUPS), 1, 1);
+    
+    // 之后的时间累积/上采样以纹理采样读取，缓存帧经帧缓冲操作写出
+    glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_FRAMEBUFFER_BARRIER_BIT);
+    glBindImageTexture(0, 0, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA16F);
+}
+
+void ComputeRayMarcher::Release() {
+    if (queueBuffer != 0) {
+        glDeleteBuffers(1, &queueBuffer);
+        queueBuffer = 0;
+    }
+}
@@ -0,0 +1,342 @@
+#include "CpuRenderer.h"
+#include "Camera.h"
+#include "MappedFile.h"
+#include "PreIntegration.h"
+#include "VolumeGeometry.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace {
+    // 与shader中的random()相同的哈希
+    float Random(float x, float y) {
+        float v = std::sin(x * 12.9898f + y * 78.233f) * 43758.5453123f;
+        return v - std::floor(v);
+    }
+    
+    bool IntersectAABB(const glm::vec3& rayOrigin, const glm::vec3& rayDir, const glm::vec3& boxMin,
+                       const glm::vec3& boxMax, float& tNear, float& tFar) {
+        glm::vec3 invDir = glm::vec3(1.0f) / rayDir;
+        glm::vec3 t0 = (boxMin - rayOrigin) * invDir;
+        glm::vec3 t1 = (boxMax - rayOrigin) * invDir;
+        
+        glm::vec3 tmin = glm::min(t0, t1);
+        glm::vec3 tmax = glm::max(t0, t1);
+        
+        tNear = std::max(std::max(tmin.x, tmin.y), tmin.z);
+        tFar = std::min(std::min(tmax.x, tmax.y), tmax.z);
+        
+        return tFar > tNear && tFar > 0.0f;
+    }
+    
+    glm::vec3 ComputeLighting(const glm::vec3& normal, const glm::vec3& viewDir,
+                              const glm::vec3& lightDir, const glm::vec3& color) {
+        glm::vec3 ambient = 0.3f * color;
+        
+        float diff = std::max(glm::dot(normal, lightDir), 0.0f);
+        glm::vec3 diffuse = diff * color;
+        
+        glm::vec3 reflectDir = glm::reflect(-lightDir, normal);
+        float spec = std::pow(std::max(glm::dot(viewDir, reflectDir), 0.0f), 32.0f);
+        glm::vec3 specular = glm::vec3(0.5f * spec);
+        
+        return ambient + diffuse + specular;
+    }
+    
+    unsigned char ToUnorm8(float v) {
+        return (unsigned char)(std::max(0.0f, std::min(1.0f, v)) * 255.0f + 0.5f);
+    }
+}
+
+CpuRenderer::CpuRenderer(ThreadPool* pool)
+    : threadPool(pool ? pool : &ThreadPool::Shared()),
+      volumeWidth(0), volumeHeight(0), volumeDepth(0), volumeSpacing(1.0f),
+      bricksX(0), bricksY(0), bricksZ(0), gradientFilter(GradientFilter::CentralDifference),
+      preIntegrationThreshold(0.0f) {
+    // 默认传输函数与Renderer一致：从透明蓝色到不透明白色
+    const int tfSize = 256;
+    transferFunction.resize(tfSize);
+    for (int i = 0; i < tfSize; i++) {
+        float t = (float)i / (tfSize - 1);
+        transferFunction[i] = glm::vec4(t, t, 1.0f, t);
+    }
+}
+
+bool CpuRenderer::LoadFromFile(const std::string& filename, int width, int height, int depth) {
+    MappedFile file;
+    if (!file.Open(filename)) {
+        std::cerr << "Failed to open volume data file: " << filename << std::endl;
+        return false;
+    }
+    
+    uint64_t dataSize = (uint64_t)width * (uint64_t)height * (uint64_t)depth;
+    if (file.GetSize() < dataSize) {
+        std::cerr << "Failed to read complete volume data" << std::endl;
+        return false;
+    }
+    
+    return SetVolumeData(file.GetData(), width, height, depth);
+}
+
+bool CpuRenderer::SetVolumeData(const unsigned char* data, int width, int height, int depth,
+                                const glm::vec3& spacing) {
+    if (!data || width <= 0 || height <= 0 || depth <= 0) return false;
+    
+    volumeWidth = width;
+    volumeHeight = height;
+    volumeDepth = depth;
+    volumeSpacing = spacing;
+    
+    const int B = BRICK_SIZE;
+    bricksX = (width + B - 1) / B;
+    bricksY = (height + B - 1) / B;
+    bricksZ = (depth + B - 1) / B;
+    brickedVoxels.assign((size_t)bricksX * bricksY * bricksZ * B * B * B * 4, 0);
+    
+    std::vector<unsigned char> packed = VolumeGradient::ComputePacked(data, width, height, depth, gradientFilter, *threadPool);
+    
+    // 按z切片并行重排为分块布局
+    threadPool->ParallelFor(0, depth, [&](int z) {
+        for (int y = 0; y < height; y++) {
+            const unsigned char* row = &packed[((size_t)z * height + y) * width * 4];
+            for (int x = 0; x < width; x++) {
+                size_t brick = ((size_t)(z / B) * bricksY + y / B) * bricksX + x / B;
+                size_t local = ((size_t)(z % B) * B + y % B) * B + x % B;
+                unsigned char* dst = &brickedVoxels[(brick * B * B * B + local) * 4];
+                dst[0] = row[x * 4 + 0];
+                dst[1] = row[x * 4 + 1];
+                dst[2] = row[x * 4 + 2];
+                dst[3] = row[x * 4 + 3];
+            }
+        }
+    });
+    
+    return true;
+}
+
+void CpuRenderer::SetTransferFunction(const std::vector<glm::vec4>& colors) {
+    if (colors.empty()) return;
+    transferFunction = colors;
+    
+    std::lock_guard<std::mutex> lock(preIntegrationMutex);
+    preIntegrationTable.reset();
+}
+
+std::shared_ptr<const std::vector<glm::vec4>> CpuRenderer::GetPreIntegrationTable(float threshold) const {
+    std::lock_guard<std::mutex> lock(preIntegrationMutex);
+    // 预积分表中烘焙了阈值
+    if (!preIntegrationTable || preIntegrationThreshold != threshold) {
+        auto table = std::make_shared<std::vector<glm::vec4>>();
+        PreIntegration::BuildTable(transferFunction, threshold, *table);
+        preIntegrationTable = table;
+        preIntegrationThreshold = threshold;
+    }
+    return preIntegrationTable;
+}
+
+const unsigned char* CpuRenderer::FetchVoxel(int x, int y, int z) const {
+    const int B = BRICK_SIZE;
+    size_t brick = ((size_t)(z / B) * bricksY + y / B) * bricksX + x / B;
+    size_t local = ((size_t)(z % B) * B + y % B) * B + x % B;
+    return &brickedVoxels[(brick * B * B * B + local) * 4];
+}
+
+glm::vec4 CpuRenderer::SampleVolume(const glm::vec3& texCoord) const {
+    // 纹素中心位于 (i + 0.5) / size
+    float u = texCoord.x * volumeWidth - 0.5f;
+    float v = texCoord.y * volumeHeight - 0.5f;
+    float w = texCoord.z * volumeDepth - 0.5f;
+    
+    float fu = std::floor(u), fv = std::floor(v), fw = std::floor(w);
+    float tx = u - fu, ty = v - fv, tz = w - fw;
+    
+    int x0 = std::max(0, std::min((int)fu, volumeWidth - 1));
+    int y0 = std::max(0, std::min((int)fv, volumeHeight - 1));
+    int z0 = std::max(0, std::min((int)fw, volumeDepth - 1));
+    int x1 = std::max(0, std::min((int)fu + 1, volumeWidth - 1));
+    int y1 = std::max(0, std::min((int)fv + 1, volumeHeight - 1));
+    int z1 = std::max(0, std::min((int)fw + 1, volumeDepth - 1));
+    
+    const unsigned char* c000 = FetchVoxel(x0, y0, z0);
+    const unsigned char* c100 = FetchVoxel(x1, y0, z0);
+    const unsigned char* c010 = FetchVoxel(x0, y1, z0);
+    const unsigned char* c110 = FetchVoxel(x1, y1, z0);
+    const unsigned char* c001 = FetchVoxel(x0, y0, z1);
+    const unsigned char* c101 = FetchVoxel(x1, y0, z1);
+    const unsigned char* c011 = FetchVoxel(x0, y1, z1);
+    const unsigned char* c111 = FetchVoxel(x1, y1, z1);
+    
+    glm::vec4 result;
+    for (int c = 0; c < 4; c++) {
+        float c00 = c000[c] + (c100[c] - c000[c]) * tx;
+        float c10 = c010[c] + (c110[c] - c010[c]) * tx;
+        float c01 = c001[c] + (c101[c] - c001[c]) * tx;
+        float c11 = c011[c] + (c111[c] - c011[c]) * tx;
+        float c0 = c00 + (c10 - c00) * ty;
+        float c1 = c01 + (c11 - c01) * ty;
+        result[c] = (c0 + (c1 - c0) * tz) / 255.0f;
+    }
+    return result;
+}
+
+glm::vec4 CpuRenderer::SampleTransferFunction(float value) const {
+    const int tfSize = (int)transferFunction.size();
+    float u = value * tfSize - 0.5f;
+    float fu = std::floor(u);
+    float t = u - fu;
+    int i0 = std::max(0, std::min((int)fu, tfSize - 1));
+    int i1 = std::max(0, std::min((int)fu + 1, tfSize - 1));
+    return glm::mix(transferFunction[i0], transferFunction[i1], t);
+}
+
+glm::vec4 CpuRenderer::SamplePreIntegration(const std::vector<glm::vec4>& table, float front, float back) const {
+    // 与GL_LINEAR + GL_CLAMP_TO_EDGE的2D纹理一致
+    const int n = (int)transferFunction.size();
+    float u = front * n - 0.5f;
+    float v = back * n - 0.5f;
+    float fu = std::floor(u), fv = std::floor(v);
+    float tx = u - fu, ty = v - fv;
+    int x0 = std::max(0, std::min((int)fu, n - 1));
+    int x1 = std::max(0, std::min((int)fu + 1, n - 1));
+    int y0 = std::max(0, std::min((int)fv, n - 1));
+    int y1 = std::max(0, std::min((int)fv + 1, n - 1));
+    glm::vec4 c0 = glm::mix(table[(size_t)y0 * n + x0], table[(size_t)y0 * n + x1], tx);
+    glm::vec4 c1 = glm::mix(table[(size_t)y1 * n + x0], table[(size_t)y1 * n + x1], tx);
+    return glm::mix(c0, c1, ty);
+}
+
+void CpuRenderer::Render(const RenderParams& params, const Camera& camera, float time,
+                         unsigned char* rgba, int width, int height) const {
+    if (!rgba || width <= 0 || height <= 0) return;
+    
+    // 与Renderer::Resize一致，宽高比取自输出尺寸
+    CameraController controller;
+    controller.GetCamera() = camera;
+    controller.SetAspectRatio((float)width / (float)height);
+    glm::mat4 invView = glm::inverse(controller.GetViewMatrix());
+    glm::mat4 invProjection = glm::inverse(controller.GetProjectionMatrix());
+    
+    // 预积分表缓存在渲染器中，传输函数或阈值变化后才重建；关闭预积分时传空表
+    static const std::vector<glm::vec4> noPreIntegration;
+    std::shared_ptr<const std::vector<glm::vec4>> preIntegration;
+    if (params.enablePreIntegration) {
+        preIntegration = GetPreIntegrationTable(params.threshold);
+    }
+    const std::vector<glm::vec4>& table = preIntegration ? *preIntegration : noPreIntegration;
+    
+    int tilesX = (width + TILE_SIZE - 1) / TILE_SIZE;
+    int tilesY = (height + TILE_SIZE - 1) / TILE_SIZE;
+    threadPool->ParallelFor(0, tilesX * tilesY, [&](int tile) {
+        RenderTile(tile % tilesX, tile / tilesX, params, invView, invProjection,
+                   camera.position, time, table, rgba, width, height);
+    });
+}
+
+void CpuRenderer::RenderTile(int tileX, int tileY, const RenderParams& params, const glm::mat4& invView,
+                             const glm::mat4& invProjection, const glm::vec3& cameraPos, float time,
+                             const std::vector<glm::vec4>& preIntegrationTable,
+                             unsigned char* rgba, int width, int height) const {
+    const glm::vec3 lightDir = glm::normalize(params.lightDir);
+    const glm::vec3 backgroundColor(0.1f, 0.1f, 0.15f);
+    const bool hasVolume = !brickedVoxels.empty();
+    const bool preIntegrated = !preIntegrationTable.empty();
+    
+    // 包围盒、梯度缩放和窗宽/窗位映射与Renderer的uniform由同一组函数计算
+    glm::vec3 volumeSize((float)volumeWidth, (float)volumeHeight, (float)volumeDepth);
+    const glm::vec3 boxExtent = VolumeGeometry::GetBoxExtent(volumeSize, volumeSpacing);
+    const glm::vec3 boxMin = -0.5f * boxExtent;
+    const glm::vec3 boxMax = 0.5f * boxExtent;
+    const glm::vec3 gradientScale = VolumeGeometry::GetGradientScale(volumeSize, boxExtent);
+    const glm::vec2 windowMapping = VolumeGeometry::GetWindowMapping(params.windowWidth, params.windowCenter);
+    
+    int xEnd = std::min((tileX + 1) * TILE_SIZE, width);
+    int yEnd = std::min((tileY + 1) * TILE_SIZE, height);
+    for (int py = tileY * TILE_SIZE; py < yEnd; py++) {
+        for (int px = tileX * TILE_SIZE; px < xEnd; px++) {
+            unsigned char* out = rgba + ((size_t)py * width + px) * 4;
+            
+            // 全屏四边形在像素中心处插值得到的纹理坐标
+            glm::vec2 texCoord((px + 0.5f) / width, (py + 0.5f) / height);
+            
+            glm::vec4 viewPos = invProjection * glm::vec4(texCoord.x * 2.0f - 1.0f, texCoord.y * 2.0f - 1.0f, -1.0f, 1.0f);
+            viewPos /= viewPos.w;
+            glm::vec3 rayDir = glm::normalize(glm::vec3(invView * glm::vec4(viewPos.x, viewPos.y, viewPos.z, 0.0f)));
+            glm::vec3 rayOrigin = cameraPos;
+            
+            float tNear, tFar;
+            if (!hasVolume || !IntersectAABB(rayOrigin, rayDir, boxMin, boxMax, tNear, tFar)) {
+                out[0] = out[1] = out[2] = 0;
+                out[3] = 255;
+                continue;
+            }
+            if (tNear < 0.0f) tNear = 0.0f;
+            
+            glm::vec3 startPos = rayOrigin + rayDir * tNear;
+            glm::vec3 endPos = rayOrigin + rayDir * tFar;
+            float rayLength = glm::distance(startPos, endPos);
+            
+            float jitter = 0.0f;
+            if (params.enableJittering) {
+                jitter = Random(texCoord.x + time, texCoord.y + time) * params.stepSize;
+            }
+            
+            glm::vec4 accumulatedColor(0.0f);
+            glm::vec3 currentPos = startPos + rayDir * jitter;
+            float traveled = jitter;
+            
+            // 预积分：上一个采样点的密度作为片段前端值（首个采样点没有前端，退化为逐点采样）
+            float frontDensity = -1.0f;
+            
+            int steps = 0;
+            while (traveled < rayLength && steps < params.maxSteps && accumulatedColor.a < 0.95f) {
+                glm::vec3 sampleCoord = (currentPos - boxMin) / (boxMax - boxMin);
+                
+                glm::vec4 voxel = SampleVolume(sampleCoord);
+                float densityValue = std::max(0.0f, std::min(1.0f, voxel.a * windowMapping.x + windowMapping.y));
+                densityValue *= params.density;
+                float front = frontDensity >= 0.0f ? frontDensity : densityValue;
+                frontDensity = densityValue;
+                
+                bool visible = preIntegrated ? std::max(front, densityValue) > params.threshold
+                                             : densityValue > params.threshold;
+                if (visible) {
+                    // a为消光（逐点采样时即tf.a），不透明度按步长做指数校正
+                    glm::vec4 sampledColor = preIntegrated
+                        ? SamplePreIntegration(preIntegrationTable, front, densityValue)
+                        : SampleTransferFunction(densityValue);
+                    
+                    if (params.enableLighting && sampledColor.a > 0.01f) {
+                        // 与shader相同：解码出零方向（均匀区域）时不计算光照，否则乘以各轴缩放后归一化
+                        glm::vec3 gradient(VolumeGradient::Decode(voxel.r), VolumeGradient::Decode(voxel.g),
+                                           VolumeGradient::Decode(voxel.b));
+                        if (glm::length(gradient) > VolumeGradient::MIN_DIRECTION_LENGTH) {
+                            gradient *= gradientScale;
+                            glm::vec3 normal = glm::normalize(gradient);
+                            glm::vec3 viewDir = glm::normalize(cameraPos - currentPos);
+                            glm::vec3 lit = ComputeLighting(normal, viewDir, lightDir, glm::vec3(sampledColor));
+                            sampledColor = glm::vec4(lit, sampledColor.a);
+                        }
+                    }
+                    
+                    sampledColor.a = PreIntegration::SegmentOpacity(sampledColor.a, params.stepSize, params.absorptionCoeff);
+                    
+                    sampledColor.r *= sampledColor.a;
+                    sampledColor.g *= sampledColor.a;
+                    sampledColor.b *= sampledColor.a;
+                    
+                    accumulatedColor += (1.0f - accumulatedColor.a) * sampledColor;
+                }
+                
+                currentPos += rayDir * params.stepSize;
+                traveled += params.stepSize;
+                steps++;
+            }
+            
+            glm::vec3 finalColor = glm::vec3(accumulatedColor) + (1.0f - accumulatedColor.a) * backgroundColor;
+            out[0] = ToUnorm8(finalColor.r);
+            out[1] = ToUnorm8(finalColor.g);
+            out[2] = ToUnorm8(finalColor.b);
+            out[3] = 255;
+        }
+    }
+}
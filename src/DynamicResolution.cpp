@@ -0,0 +1,100 @@
+#include "DynamicResolution.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+DynamicResolution::DynamicResolution()
+    : colorTexture(0), framebuffer(0), targetWidth(0), targetHeight(0), renderSize(0), scale(1.0f) {
+}
+
+DynamicResolution::~DynamicResolution() {
+    Release();
+}
+
+bool DynamicResolution::Initialize() {
+    upsampleShader = std::make_unique<Shader>();
+    if (!upsampleShader->LoadFromFile("shaders/raymarching.vert", "shaders/upsample.frag")) {
+        std::cerr << "Failed to load upsample shader" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void DynamicResolution::Update(float gpuTimeMs, float targetTimeMs, float minScale) {
+    if (gpuTimeMs <= 0.0f || targetTimeMs <= 0.0f) return;
+    
+    float ratio = gpuTimeMs / targetTimeMs;
+    if (std::abs(ratio - 1.0f) < DEADBAND) return;
+    
+    float desired = scale * std::sqrt(1.0f / ratio);
+    desired = std::max(std::min(desired, 1.0f), std::min(std::max(minScale, 0.05f), 1.0f));
+    scale += (desired - scale) * (desired < scale ? DECREASE_RATE : INCREASE_RATE);
+}
+
+glm::ivec2 DynamicResolution::GetRenderSize(int screenWidth, int screenHeight) const {
+    float quantized = std::max(std::round(scale / SCALE_STEP) * SCALE_STEP, SCALE_STEP);
+    quantized = std::min(quantized, 1.0f);
+    return glm::ivec2(std::max(1, (int)std::lround(screenWidth * quantized)),
+                      std::max(1, (int)std::lround(screenHeight * quantized)));
+}
+
+void DynamicResolution::BeginScene(int screenWidth, int screenHeight) {
+    if (screenWidth != targetWidth || screenHeight != targetHeight) {
+        CreateTarget(screenWidth, screenHeight);
+    }
+    renderSize = GetRenderSize(screenWidth, screenHeight);
+    
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glViewport(0, 0, renderSize.x, renderSize.y);
+    glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+}
+
+void DynamicResolution::Upsample(int screenWidth, int screenHeight, GLuint sourceTexture, GLuint targetFramebuffer) {
+    glBindFramebuffer(GL_FRAMEBUFFER, targetFramebuffer);
+    glViewport(0, 0, screenWidth, screenHeight);
+    
+    upsampleShader->Use();
+    upsampleShader->SetInt("sceneTexture", 0);
+    upsampleShader->SetVec2("renderSize", glm::vec2(renderSize));
+    
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, sourceTexture);
+    glDrawArrays(GL_TRIANGLES, 0, 6);
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void DynamicResolution::CreateTarget(int width, int height) {
+    targetWidth = width;
+    targetHeight = height;
+    
+    if (colorTexture == 0) {
+        glGenTextures(1, &colorTexture);
+        glGenFramebuffers(1, &framebuffer);
+    }
+    
+    // 上采样shader用texelFetch自行插值，不需要过滤
+    glBindTexture(GL_TEXTURE_2D, colorTexture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, width, height, 0, GL_RGBA, GL_FLOAT, nullptr);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTexture, 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "Dynamic resolution framebuffer is incomplete" << std::endl;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void DynamicResolution::Release() {
+    if (framebuffer != 0) {
+        glDeleteFramebuffers(1, &framebuffer);
+        framebuffer = 0;
+    }
+    if (colorTexture != 0) {
+        glDeleteTextures(1, &colorTexture);
+        colorTexture = 0;
+    }
+}
@@ -0,0 +1,55 @@
+#include "FrameCache.h"
+#include <iostream>
+
+FrameCache::FrameCache()
+    : colorRenderbuffer(0), framebuffer(0), cacheWidth(0), cacheHeight(0), valid(false) {
+}
+
+FrameCache::~FrameCache() {
+    Release();
+}
+
+void FrameCache::Begin(int width, int height) {
+    if (width != cacheWidth || height != cacheHeight) {
+        if (colorRenderbuffer == 0) {
+            glGenRenderbuffers(1, &colorRenderbuffer);
+            glGenFramebuffers(1, &framebuffer);
+        }
+        
+        glBindRenderbuffer(GL_RENDERBUFFER, colorRenderbuffer);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+        
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorRenderbuffer);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            std::cerr << "Frame cache framebuffer is incomplete" << std::endl;
+        }
+        cacheWidth = width;
+        cacheHeight = height;
+    }
+    
+    // 调用方随后写满整个画面
+    valid = true;
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glViewport(0, 0, width, height);
+}
+
+void FrameCache::Present(int width, int height) {
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glBlitFramebuffer(0, 0, cacheWidth, cacheHeight, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, width, height);
+}
+
+void FrameCache::Release() {
+    if (framebuffer != 0) {
+        glDeleteFramebuffers(1, &framebuffer);
+        framebuffer = 0;
+    }
+    if (colorRenderbuffer != 0) {
+        glDeleteRenderbuffers(1, &colorRenderbuffer);
+        colorRenderbuffer = 0;
+    }
+}
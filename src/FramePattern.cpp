@@ -0,0 +1,27 @@
+#include "FramePattern.h"
+
+bool FramePattern::Format(const std::string& pattern, int frame, std::string& name) {
+    size_t percent = pattern.find('%');
+    if (percent == std::string::npos || pattern.find('%', percent + 1) != std::string::npos) {
+        return false;
+    }
+    
+    // %[0][宽度]d
+    size_t pos = percent + 1;
+    bool zeroPad = pos < pattern.size() && pattern[pos] == '0';
+    int fieldWidth = 0;
+    while (pos < pattern.size() && pattern[pos] >= '0' && pattern[pos] <= '9') {
+        fieldWidth = fieldWidth * 10 + (pattern[pos] - '0');
+        pos++;
+    }
+    if (pos >= pattern.size() || pattern[pos] != 'd' || fieldWidth > 16) {
+        return false;
+    }
+    
+    std::string number = std::to_string(frame);
+    if ((int)number.size() < fieldWidth) {
+        number.insert(0, fieldWidth - number.size(), zeroPad ? '0' : ' ');
+    }
+    name = pattern.substr(0, percent) + number + pattern.substr(pos + 1);
+    return true;
+}
@@ -0,0 +1,114 @@
+#include "FrameProfiler.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+
+FrameProfiler::FrameProfiler()
+    : historyHead(0), frameIndex(0) {
+    std::fill(frameMs, frameMs + PASS_COUNT, -1.0f);
+    history.reserve(HISTORY_SIZE);
+}
+
+void FrameProfiler::BeginFrame(float cpuFrameMs) {
+    // 从后往前取回：GPU按提交顺序完成，后面的阶段完成时同一帧前面的阶段也已完成，
+    // 这样同一帧各阶段的结果尽量在同一次取回
+    for (int i = PASS_COUNT - 1; i >= 0; i--) {
+        float ms = 0.0f;
+        frameMs[i] = timers[i].Poll(ms) ? ms : -1.0f;
+    }
+    
+    FrameRecord record;
+    record.frame = frameIndex++;
+    record.cpuMs = cpuFrameMs;
+    std::copy(frameMs, frameMs + PASS_COUNT, record.passMs);
+    if ((int)history.size() < HISTORY_SIZE) {
+        history.push_back(record);
+    } else {
+        history[historyHead] = record;
+    }
+    historyHead = (historyHead + 1) % HISTORY_SIZE;
+}
+
+void FrameProfiler::Reset() {
+    history.clear();
+    historyHead = 0;
+}
+
+TimingPercentiles FrameProfiler::GetFramePercentiles() const {
+    return ComputePercentiles(-1);
+}
+
+TimingPercentiles FrameProfiler::GetPassPercentiles(GpuPass pass) const {
+    return ComputePercentiles((int)pass);
+}
+
+TimingPercentiles FrameProfiler::ComputePercentiles(int column) const {
+    std::vector<float> values;
+    values.reserve(history.size());
+    for (const FrameRecord& record : history) {
+        float value = column < 0 ? record.cpuMs : record.passMs[column];
+        if (value >= 0.0f) {
+            values.push_back(value);
+        }
+    }
+    
+    TimingPercentiles result;
+    if (values.empty()) return result;
+    
+    // 最近秩法：第p百分位数为排序后第ceil(p * n)个值
+    std::sort(values.begin(), values.end());
+    auto percentile = [&values](float p) {
+        size_t rank = (size_t)std::ceil(p * values.size());
+        return values[std::min(std::max(rank, (size_t)1), values.size()) - 1];
+    };
+    result.p50 = percentile(0.50f);
+    result.p95 = percentile(0.95f);
+    result.p99 = percentile(0.99f);
+    return result;
+}
+
+bool FrameProfiler::WriteCsv(const std::string& filename) const {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open file: " << filename << std::endl;
+        return false;
+    }
+    
+    file << "frame,cpu_frame_ms";
+    for (int i = 0; i < PASS_COUNT; i++) {
+        file << "," << GetPassName((GpuPass)i) << "_ms";
+    }
+    file << "\n";
+    
+    // 从最早的一帧开始（缓冲未满时从0开始）
+    size_t count = history.size();
+    size_t start = count < (size_t)HISTORY_SIZE ? 0 : (size_t)historyHead;
+    for (size_t n = 0; n < count; n++) {
+        const FrameRecord& record = history[(start + n) % count];
+        file << record.frame << "," << record.cpuMs;
+        for (int i = 0; i < PASS_COUNT; i++) {
+            file << ",";
+            if (record.passMs[i] >= 0.0f) {
+                file << record.passMs[i];
+            }
+        }
+        file << "\n";
+    }
+    
+    std::cout << "Wrote " << count << " frame timings to " << filename << std::endl;
+    return true;
+}
+
+const char* FrameProfiler::GetPassName(GpuPass pass) {
+    switch (pass) {
+        case GpuPass::Upload:   return "upload";
+        case GpuPass::Proxy:    return "proxy";
+        case GpuPass::Feedback: return "feedback";
+        case GpuPass::RayMarch: return "ray_march";
+        case GpuPass::Temporal: return "temporal";
+        case GpuPass::Present:  return "present";
+        case GpuPass::Overlay:  return "overlay";
+        default:                return "unknown";
+    }
+}
@@ -0,0 +1,42 @@
+#include "GpuTimer.h"
+
+GpuTimer::GpuTimer()
+    : writeIndex(0), readIndex(0), pending(0), active(false), lastMs(0.0f) {
+    glGenQueries(QUERY_COUNT, queries);
+}
+
+GpuTimer::~GpuTimer() {
+    glDeleteQueries(QUERY_COUNT, queries);
+}
+
+void GpuTimer::Begin() {
+    if (active || pending == QUERY_COUNT) return;
+    glBeginQuery(GL_TIME_ELAPSED, queries[writeIndex]);
+    active = true;
+}
+
+void GpuTimer::End() {
+    if (!active) return;
+    glEndQuery(GL_TIME_ELAPSED);
+    active = false;
+    writeIndex = (writeIndex + 1) % QUERY_COUNT;
+    pending++;
+}
+
+bool GpuTimer::Poll(float& milliseconds) {
+    bool updated = false;
+    while (pending > 0) {
+        GLint available = 0;
+        glGetQueryObjectiv(queries[readIndex], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) break;
+        
+        GLuint64 elapsed = 0;
+        glGetQueryObjectui64v(queries[readIndex], GL_QUERY_RESULT, &elapsed);
+        lastMs = (float)(elapsed / 1.0e6);
+        readIndex = (readIndex + 1) % QUERY_COUNT;
+        pending--;
+        updated = true;
+    }
+    milliseconds = lastMs;
+    return updated;
+}
@@ -0,0 +1,284 @@
+#include "ImageWriter.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace {
+    // deflate长度码257..285的基础长度与额外位数
+    const uint16_t LENGTH_BASE[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                       35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+    const uint8_t LENGTH_EXTRA[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                       3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+    // 距离码0..29的基础距离与额外位数
+    const uint16_t DISTANCE_BASE[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+                                         257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+                                         8193, 12289, 16385, 24577 };
+    const uint8_t DISTANCE_EXTRA[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+                                         7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+    
+    const int WINDOW_SIZE = 32768;
+    const int MIN_MATCH = 3;
+    const int MAX_MATCH = 258;
+    const int HASH_BITS = 15;
+    const int MAX_CHAIN = 32;           // 每个位置最多比较的候选数
+    
+    // deflate按LSB优先写位
+    class BitWriter {
+    public:
+        explicit BitWriter(std::vector<unsigned char>& out) : out(out), buffer(0), count(0) {}
+        
+        void Write(uint32_t value, int bits) {
+            buffer |= (uint64_t)value << count;
+            count += bits;
+            while (count >= 8) {
+                out.push_back((unsigned char)buffer);
+                buffer >>= 8;
+                count -= 8;
+            }
+        }
+        
+        // 哈夫曼码按MSB优先定义，需要逆序后写入
+        void WriteHuffman(uint32_t code, int bits) {
+            uint32_t reversed = 0;
+            for (int i = 0; i < bits; i++) {
+                reversed = (reversed << 1) | ((code >> i) & 1);
+            }
+            Write(reversed, bits);
+        }
+        
+        void Flush() {
+            if (count > 0) {
+                out.push_back((unsigned char)buffer);
+                buffer = 0;
+                count = 0;
+            }
+        }
+        
+    private:
+        std::vector<unsigned char>& out;
+        uint64_t buffer;
+        int count;
+    };
+    
+    // 固定哈夫曼表中的字面量/长度符号
+    void WriteLiteralLength(BitWriter& writer, int symbol) {
+        if (symbol < 144) {
+            writer.WriteHuffman(0x30 + symbol, 8);
+        } else if (symbol < 256) {
+            writer.WriteHuffman(0x190 + (symbol - 144), 9);
+        } else if (symbol < 280) {
+            writer.WriteHuffman(symbol - 256, 7);
+        } else {
+            writer.WriteHuffman(0xC0 + (symbol - 280), 8);
+        }
+    }
+    
+    void WriteMatch(BitWriter& writer, int length, int distance) {
+        int lengthCode = 28;
+        while (LENGTH_BASE[lengthCode] > length) lengthCode--;
+        WriteLiteralLength(writer, 257 + lengthCode);
+        writer.Write(length - LENGTH_BASE[lengthCode], LENGTH_EXTRA[lengthCode]);
+        
+        int distanceCode = 29;
+        while (DISTANCE_BASE[distanceCode] > distance) distanceCode--;
+        writer.WriteHuffman(distanceCode, 5);
+        writer.Write(distance - DISTANCE_BASE[distanceCode], DISTANCE_EXTRA[distanceCode]);
+    }
+    
+    uint32_t Hash3(const unsigned char* p) {
+        uint32_t v = (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16);
+        return (v * 2654435761u) >> (32 - HASH_BITS);
+    }
+    
+    uint32_t Adler32(const unsigned char* data, size_t size) {
+        uint32_t a = 1, b = 0;
+        while (size > 0) {
+            size_t chunk = std::min<size_t>(size, 5552);  // 保证累加不溢出后再取模
+            for (size_t i = 0; i < chunk; i++) {
+                a += data[i];
+                b += a;
+            }
+            a %= 65521;
+            b %= 65521;
+            data += chunk;
+            size -= chunk;
+        }
+        return (b << 16) | a;
+    }
+    
+    uint32_t Crc32(const unsigned char* data, size_t size, uint32_t crc = 0) {
+        static uint32_t table[256];
+        static bool initialized = [] {
+            for (uint32_t n = 0; n < 256; n++) {
+                uint32_t c = n;
+                for (int k = 0; k < 8; k++) {
+                    c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                }
+                table[n] = c;
+            }
+            return true;
+        }();
+        (void)initialized;
+        
+        crc = ~crc;
+        for (size_t i = 0; i < size; i++) {
+            crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+        }
+        return ~crc;
+    }
+    
+    void AppendBigEndian(std::vector<unsigned char>& out, uint32_t value) {
+        out.push_back((unsigned char)(value >> 24));
+        out.push_back((unsigned char)(value >> 16));
+        out.push_back((unsigned char)(value >> 8));
+        out.push_back((unsigned char)value);
+    }
+    
+    // PNG块：长度 + 类型 + 数据 + CRC（覆盖类型和数据）
+    void AppendChunk(std::vector<unsigned char>& out, const char* type, const std::vector<unsigned char>& data) {
+        AppendBigEndian(out, (uint32_t)data.size());
+        size_t typeStart = out.size();
+        out.insert(out.end(), type, type + 4);
+        out.insert(out.end(), data.begin(), data.end());
+        AppendBigEndian(out, Crc32(out.data() + typeStart, out.size() - typeStart));
+    }
+    
+    bool WriteBytes(const std::string& filename, const unsigned char* data, size_t size) {
+        std::ofstream file(filename, std::ios::binary);
+        if (!file.is_open()) {
+            std::cerr << "Failed to open file: " << filename << std::endl;
+            return false;
+        }
+        file.write(reinterpret_cast<const char*>(data), (std::streamsize)size);
+        if (!file) {
+            std::cerr << "Failed to write file: " << filename << std::endl;
+            return false;
+        }
+        return true;
+    }
+}
+
+namespace ImageWriter {
+
+bool FormatFromFilename(const std::string& filename, Format& format) {
+    size_t dot = filename.find_last_of('.');
+    if (dot == std::string::npos) return false;
+    std::string extension = filename.substr(dot + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return (char)std::tolower(c); });
+    if (extension == "ppm") format = Format::PPM;
+    else if (extension == "png") format = Format::PNG;
+    else return false;
+    return true;
+}
+
+bool WritePPM(const std::string& filename, int width, int height, const unsigned char* rgb) {
+    std::string header = "P6\n" + std::to_string(width) + " " + std::to_string(height) + "\n255\n";
+    std::vector<unsigned char> out(header.begin(), header.end());
+    out.insert(out.end(), rgb, rgb + (size_t)width * height * 3);
+    return WriteBytes(filename, out.data(), out.size());
+}
+
+std::vector<unsigned char> ZlibCompress(const unsigned char* data, size_t size) {
+    std::vector<unsigned char> out;
+    out.reserve(size / 2 + 64);
+    out.push_back(0x78);    // CM = 8 (deflate)，32K窗口
+    out.push_back(0x01);    // 最快压缩级别，FCHECK使头部为31的倍数
+    
+    // 整个输入作为一个固定哈夫曼块（BFINAL = 1，BTYPE = 01）
+    BitWriter writer(out);
+    writer.Write(1, 1);
+    writer.Write(1, 2);
+    
+    // head[hash]为该哈希最近出现的位置，prev按窗口取模链接更早的位置
+    std::vector<int> head((size_t)1 << HASH_BITS, -1);
+    std::vector<int> prev(WINDOW_SIZE, -1);
+    auto insert = [&](size_t pos) {
+        uint32_t h = Hash3(data + pos);
+        prev[pos % WINDOW_SIZE] = head[h];
+        head[h] = (int)pos;
+    };
+    
+    size_t pos = 0;
+    while (pos < size) {
+        int bestLength = 0;
+        int bestDistance = 0;
+        if (pos + MIN_MATCH <= size) {
+            int maxLength = (int)std::min<size_t>(MAX_MATCH, size - pos);
+            int candidate = head[Hash3(data + pos)];
+            for (int chain = 0; candidate >= 0 && chain < MAX_CHAIN; chain++) {
+                int distance = (int)pos - candidate;
+                if (distance > WINDOW_SIZE) break;
+                if (data[candidate + bestLength] == data[pos + bestLength]) {
+                    int length = 0;
+                    while (length < maxLength && data[candidate + length] == data[pos + length]) length++;
+                    if (length > bestLength) {
+                        bestLength = length;
+                        bestDistance = distance;
+                        if (length == maxLength) break;
+                    }
+                }
+                int next = prev[candidate % WINDOW_SIZE];
+                if (next >= candidate) break;   // 槽位已被更新的位置覆盖
+                candidate = next;
+            }
+        }
+        
+        if (bestLength >= MIN_MATCH) {
+            WriteMatch(writer, bestLength, bestDistance);
+            for (int i = 0; i < bestLength; i++) {
+                if (pos + MIN_MATCH <= size) insert(pos);
+                pos++;
+            }
+        } else {
+            WriteLiteralLength(writer, data[pos]);
+            if (pos + MIN_MATCH <= size) insert(pos);
+            pos++;
+        }
+    }
+    WriteLiteralLength(writer, 256);    // 块结束
+    writer.Flush();
+    
+    AppendBigEndian(out, Adler32(data, size));
+    return out;
+}
+
+bool WritePNG(const std::string& filename, int width, int height, const unsigned char* rgb) {
+    // 每行前加滤波类型字节：Up滤波（减去上一行），体渲染画面大面积平滑，压缩效果好于不滤波
+    size_t rowBytes = (size_t)width * 3;
+    std::vector<unsigned char> filtered((rowBytes + 1) * height);
+    for (int y = 0; y < height; y++) {
+        unsigned char* out = &filtered[(rowBytes + 1) * y];
+        const unsigned char* row = rgb + rowBytes * y;
+        const unsigned char* above = y > 0 ? row - rowBytes : nullptr;
+        out[0] = 2;
+        for (size_t i = 0; i < rowBytes; i++) {
+            out[i + 1] = (unsigned char)(row[i] - (above ? above[i] : 0));
+        }
+    }
+    
+    std::vector<unsigned char> png = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    
+    std::vector<unsigned char> header;
+    AppendBigEndian(header, (uint32_t)width);
+    AppendBigEndian(header, (uint32_t)height);
+    header.push_back(8);    // 位深
+    header.push_back(2);    // 颜色类型：RGB
+    header.push_back(0);    // 压缩方法
+    header.push_back(0);    // 滤波方法
+    header.push_back(0);    // 不隔行
+    AppendChunk(png, "IHDR", header);
+    AppendChunk(png, "IDAT", ZlibCompress(filtered.data(), filtered.size()));
+    AppendChunk(png, "IEND", {});
+    
+    return WriteBytes(filename, png.data(), png.size());
+}
+
+bool Write(const std::string& filename, Format format, int width, int height, const unsigned char* rgb) {
+    return format == Format::PNG ? WritePNG(filename, width, height, rgb) : WritePPM(filename, width, height, rgb);
+}
+
+}
@@ -0,0 +1,204 @@
+#include "LZCodec.h"
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+const size_t MIN_MATCH = 4;
+const size_t MAX_OFFSET = 65535;
+const int HASH_BITS = 14;
+const size_t WILD_COPY = 16;
+
+inline uint32_t Read32(const unsigned char* p) {
+    uint32_t value;
+    std::memcpy(&value, p, 4);
+    return value;
+}
+
+inline uint32_t Hash(uint32_t value) {
+    return (value * 2654435761u) >> (32 - HASH_BITS);
+}
+
+// token中的长度字段取15时，剩余部分以若干255加一个<255的字节表示
+inline bool WriteExtraLength(unsigned char*& op, const unsigned char* oend, size_t length) {
+    while (length >= 255) {
+        if (op >= oend) return false;
+        *op++ = 255;
+        length -= 255;
+    }
+    if (op >= oend) return false;
+    *op++ = (unsigned char)length;
+    return true;
+}
+
+inline bool ReadExtraLength(const unsigned char*& ip, const unsigned char* iend, size_t& length) {
+    unsigned char b;
+    do {
+        if (ip >= iend) return false;
+        b = *ip++;
+        length += b;
+    } while (b == 255);
+    return true;
+}
+
+// 输出一个序列；matchLength为0表示最后一个只含字面量的序列
+bool EmitSequence(unsigned char*& op, const unsigned char* oend, const unsigned char* literals,
+                  size_t literalLength, size_t matchLength, size_t offset) {
+    if (op >= oend) return false;
+    unsigned char* token = op++;
+    
+    size_t matchCode = matchLength >= MIN_MATCH ? matchLength - MIN_MATCH : 0;
+    *token = (unsigned char)(((literalLength >= 15 ? 15 : literalLength) << 4) | (matchCode >= 15 ? 15 : matchCode));
+    
+    if (literalLength >= 15 && !WriteExtraLength(op, oend, literalLength - 15)) return false;
+    if ((size_t)(oend - op) < literalLength) return false;
+    std::memcpy(op, literals, literalLength);
+    op += literalLength;
+    
+    if (matchLength == 0) return true;
+    
+    if (oend - op < 2) return false;
+    *op++ = (unsigned char)(offset & 0xFF);
+    *op++ = (unsigned char)(offset >> 8);
+    if (matchCode >= 15 && !WriteExtraLength(op, oend, matchCode - 15)) return false;
+    return true;
+}
+
+} // namespace
+
+size_t LZCodec::CompressBound(size_t size) {
+    // 全部为字面量时：token + 扩展长度字节 + 数据
+    return size + size / 255 + 16;
+}
+
+size_t LZCodec::Compress(const unsigned char* src, size_t size, unsigned char* dst, size_t capacity) {
+    unsigned char* op = dst;
+    const unsigned char* oend = dst + capacity;
+    size_t anchor = 0;
+    
+    if (size >= MIN_MATCH) {
+        std::vector<uint32_t> table((size_t)1 << HASH_BITS, 0);
+        const size_t matchLimit = size - MIN_MATCH;
+        size_t ip = 0;
+        
+        while (ip <= matchLimit) {
+            uint32_t sequence = Read32(src + ip);
+            uint32_t h = Hash(sequence);
+            size_t candidate = table[h];
+            table[h] = (uint32_t)ip;
+            
+            if (candidate < ip && ip - candidate <= MAX_OFFSET && Read32(src + candidate) == sequence) {
+                size_t length = MIN_MATCH;
+                while (ip + length < size && src[candidate + length] == src[ip + length]) {
+                    length++;
+                }
+                if (!EmitSequence(op, oend, src + anchor, ip - anchor, length, ip - candidate)) return 0;
+                
+                // 为匹配末尾附近的位置补充哈希，提高下一次命中率
+                size_t end = ip + length;
+                if (end - 2 <= matchLimit) {
+                    table[Hash(Read32(src + end - 2))] = (uint32_t)(end - 2);
+                }
+                ip = end;
+                anchor = ip;
+            } else {
+                // 连续未命中时逐渐加大步长，不可压缩数据上不至于太慢
+                ip += 1 + ((ip - anchor) >> 6);
+            }
+        }
+    }
+    
+    if (!EmitSequence(op, oend, src + anchor, size - anchor, 0, 0)) return 0;
+    return (size_t)(op - dst);
+}
+
+bool LZCodec::Decompress(const unsigned char* src, size_t size, unsigned char* dst, size_t rawSize) {
+    const unsigned char* ip = src;
+    const unsigned char* iend = src + size;
+    unsigned char* op = dst;
+    unsigned char* oend = dst + rawSize;
+    
+    while (true) {
+        if (ip >= iend) return false;
+        unsigned char token = *ip++;
+        
+        // 快速路径：字面量与匹配都不超过token能直接表示的长度，且输入输出离末尾足够远时，
+        // 按固定16字节复制，省去逐项边界检查（噪声较多的数据几乎全是这种短序列）
+        if ((token >> 4) < 15 && (token & 15) < 15 && (size_t)(iend - ip) >= 2 * WILD_COPY &&
+            (size_t)(oend - op) >= 2 * WILD_COPY) {
+            size_t literalLength = token >> 4;
+            std::memcpy(op, ip, WILD_COPY);
+            op += literalLength;
+            ip += literalLength;
+            
+            size_t offset = (size_t)ip[0] | ((size_t)ip[1] << 8);
+            size_t matchLength = (token & 15) + MIN_MATCH;
+            if (offset >= WILD_COPY && offset <= (size_t)(op - dst)) {
+                ip += 2;
+                std::memcpy(op, op - offset, WILD_COPY);
+                std::memcpy(op + WILD_COPY, op - offset + WILD_COPY, 2);
+                op += matchLength;
+                continue;
+            }
+            // 短偏移：重叠复制（输入至少还剩2字节、输出余量不小于最长匹配，由进入条件保证）
+            ip += 2;
+            if (offset == 0 || offset > (size_t)(op - dst)) return false;
+            const unsigned char* match = op - offset;
+            if (offset == 1) {
+                std::memset(op, *match, matchLength);
+            } else {
+                for (size_t i = 0; i < matchLength; i++) {
+                    op[i] = match[i];
+                }
+            }
+            op += matchLength;
+            continue;
+        }
+        
+        // 字面量
+        size_t literalLength = token >> 4;
+        if (literalLength == 15 && !ReadExtraLength(ip, iend, literalLength)) return false;
+        if (literalLength > (size_t)(iend - ip) || literalLength > (size_t)(oend - op)) return false;
+        if (literalLength <= WILD_COPY && (size_t)(iend - ip) >= WILD_COPY && (size_t)(oend - op) >= WILD_COPY) {
+            // 短字面量：固定长度复制比变长memcpy快，多写的字节随后会被覆盖
+            std::memcpy(op, ip, WILD_COPY);
+        } else {
+            std::memcpy(op, ip, literalLength);
+        }
+        op += literalLength;
+        ip += literalLength;
+        
+        // 输入耗尽即为最后一个序列
+        if (ip == iend) return op == oend;
+        
+        // 匹配
+        if (iend - ip < 2) return false;
+        size_t offset = (size_t)ip[0] | ((size_t)ip[1] << 8);
+        ip += 2;
+        if (offset == 0 || offset > (size_t)(op - dst)) return false;
+        
+        size_t matchLength = token & 15;
+        if (matchLength == 15 && !ReadExtraLength(ip, iend, matchLength)) return false;
+        matchLength += MIN_MATCH;
+        if (matchLength > (size_t)(oend - op)) return false;
+        
+        const unsigned char* match = op - offset;
+        if (offset == 1) {
+            std::memset(op, *match, matchLength);
+        } else if (offset >= WILD_COPY && (size_t)(oend - op) >= matchLength + WILD_COPY) {
+            // 按16字节块复制，末块可能越过匹配末尾（输出仍有余量），偏移不小于块长时各块不重叠
+            for (size_t i = 0; i < matchLength; i += WILD_COPY) {
+                std::memcpy(op + i, match + i, WILD_COPY);
+            }
+        } else if (offset >= matchLength) {
+            std::memcpy(op, match, matchLength);
+        } else {
+            // 重叠复制（重复模式），必须逐字节向前复制
+            for (size_t i = 0; i < matchLength; i++) {
+                op[i] = match[i];
+            }
+        }
+        op += matchLength;
+    }
+}
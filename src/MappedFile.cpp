@@ -0,0 +1,169 @@
+#include "MappedFile.h"
+#include <iostream>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile() : data(nullptr), size(0), fileHandle(nullptr), mappingHandle(nullptr) {}
+
+bool MappedFile::Open(const std::string& filename) {
+    Close();
+    
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        std::cerr << "Failed to open file for mapping: " << filename << std::endl;
+        return false;
+    }
+    
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+        std::cerr << "Failed to get file size: " << filename << std::endl;
+        CloseHandle(file);
+        return false;
+    }
+    
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+        std::cerr << "Failed to create file mapping: " << filename << std::endl;
+        CloseHandle(file);
+        return false;
+    }
+    
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        std::cerr << "Failed to map view of file: " << filename << std::endl;
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    
+    fileHandle = file;
+    mappingHandle = mapping;
+    data = static_cast<const unsigned char*>(view);
+    size = (uint64_t)fileSize.QuadPart;
+    return true;
+}
+
+void MappedFile::Close() {
+    if (data) {
+        UnmapViewOfFile(data);
+    }
+    if (mappingHandle) {
+        CloseHandle((HANDLE)mappingHandle);
+    }
+    if (fileHandle) {
+        CloseHandle((HANDLE)fileHandle);
+    }
+    data = nullptr;
+    size = 0;
+    fileHandle = nullptr;
+    mappingHandle = nullptr;
+}
+
+void MappedFile::AdviseSequential() const {
+    // 已在CreateFileA中指定FILE_FLAG_SEQUENTIAL_SCAN
+}
+
+void MappedFile::Prefetch(uint64_t offset, uint64_t length) const {
+    // 依赖FILE_FLAG_SEQUENTIAL_SCAN的预读
+    (void)offset;
+    (void)length;
+}
+
+void MappedFile::Release(uint64_t offset, uint64_t length) const {
+    // 文件映射的只读页由系统按工作集自动回收
+    (void)offset;
+    (void)length;
+}
+
+#else
+
+MappedFile::MappedFile() : data(nullptr), size(0), fileDescriptor(-1) {}
+
+bool MappedFile::Open(const std::string& filename) {
+    Close();
+    
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Failed to open file for mapping: " << filename << std::endl;
+        return false;
+    }
+    
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        std::cerr << "Failed to get file size: " << filename << std::endl;
+        close(fd);
+        return false;
+    }
+    
+    void* view = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (view == MAP_FAILED) {
+        std::cerr << "Failed to map file: " << filename << std::endl;
+        close(fd);
+        return false;
+    }
+    
+    fileDescriptor = fd;
+    data = static_cast<const unsigned char*>(view);
+    size = (uint64_t)st.st_size;
+    return true;
+}
+
+void MappedFile::Close() {
+    if (data) {
+        munmap(const_cast<unsigned char*>(data), (size_t)size);
+    }
+    if (fileDescriptor >= 0) {
+        close(fileDescriptor);
+    }
+    data = nullptr;
+    size = 0;
+    fileDescriptor = -1;
+}
+
+void MappedFile::AdviseSequential() const {
+    if (data) {
+        madvise(const_cast<unsigned char*>(data), (size_t)size, MADV_SEQUENTIAL);
+    }
+}
+
+void MappedFile::Prefetch(uint64_t offset, uint64_t length) const {
+    if (!data || offset >= size) return;
+    
+    // madvise要求起点页对齐：向下取整到页边界
+    const uint64_t pageSize = (uint64_t)sysconf(_SC_PAGESIZE);
+    uint64_t begin = offset / pageSize * pageSize;
+    uint64_t end = offset + length < size ? offset + length : size;
+    madvise(const_cast<unsigned char*>(data) + begin, (size_t)(end - begin), MADV_WILLNEED);
+}
+
+void MappedFile::Release(uint64_t offset, uint64_t length) const {
+    if (!data || offset >= size) return;
+    
+    // madvise要求页对齐：只释放完全落在范围内的页
+    const uint64_t pageSize = (uint64_t)sysconf(_SC_PAGESIZE);
+    uint64_t begin = (offset + pageSize - 1) / pageSize * pageSize;
+    uint64_t end = offset + length < size ? offset + length : size;
+    end = end / pageSize * pageSize;
+    if (end > begin) {
+        madvise(const_cast<unsigned char*>(data) + begin, (size_t)(end - begin), MADV_DONTNEED);
+    }
+}
+
+#endif
+
+MappedFile::~MappedFile() {
+    Close();
+}
@@ -0,0 +1,119 @@
+#include "MultiViewRenderer.h"
+#include "Camera.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+MultiViewRenderer::MultiViewRenderer()
+    : texture(0), framebuffer(0), width(0), height(0) {
+}
+
+MultiViewRenderer::~MultiViewRenderer() {
+    Release();
+}
+
+bool MultiViewRenderer::Initialize(const std::function<void(Shader&)>& setup) {
+    shader = std::make_unique<Shader>();
+    if (!shader->LoadFromFile("shaders/raymarching.vert", "shaders/raymarching.frag", "#define MULTI_VIEW 1\n")) {
+        std::cerr << "Failed to load multi-view ray marching shader" << std::endl;
+        return false;
+    }
+    setup(*shader);
+    if (!viewUniformBuffer.Create(sizeof(ViewUniforms) * MAX_VIEWS_PER_DRAW)) {
+        std::cerr << "Failed to create view uniform buffer" << std::endl;
+        return false;
+    }
+    viewUniforms.resize(MAX_VIEWS_PER_DRAW);
+    return true;
+}
+
+void MultiViewRenderer::Render(const std::vector<BatchView>& views, int atlasWidth, int atlasHeight) {
+    if (atlasWidth != width || atlasHeight != height) {
+        CreateTarget(atlasWidth, atlasHeight);
+    }
+    
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glViewport(0, 0, width, height);
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    shader->Use();
+    
+    // 每MAX_VIEWS_PER_DRAW个视图一次实例化绘制；共享的纹理和RenderBlock在各次绘制之间不变
+    for (size_t first = 0; first < views.size(); first += MAX_VIEWS_PER_DRAW) {
+        int count = (int)std::min(views.size() - first, (size_t)MAX_VIEWS_PER_DRAW);
+        for (int i = 0; i < count; i++) {
+            const BatchView& view = views[first + i];
+            glm::vec4 viewport(view.viewport);
+            
+            // 宽高比由视口决定
+            Camera camera = view.camera;
+            camera.aspectRatio = viewport.z / std::max(viewport.w, 1.0f);
+            
+            ViewUniforms& uniforms = viewUniforms[i];
+            uniforms.invView = CameraController::ComputeInverseViewMatrix(camera);
+            uniforms.invProjection = CameraController::ComputeInverseProjectionMatrix(camera);
+            uniforms.cameraPos = camera.position;
+            uniforms.pixelAngle = 2.0f * std::tan(glm::radians(camera.fov) * 0.5f) / std::max(viewport.w, 1.0f);
+            
+            // 像素矩形 -> NDC
+            uniforms.viewport = glm::vec4(viewport.x / width, viewport.y / height,
+                                          (viewport.x + viewport.z) / width, (viewport.y + viewport.w) / height) * 2.0f -
+                                glm::vec4(1.0f);
+        }
+        viewUniformBuffer.Update(viewUniforms.data(), VIEW_BLOCK_BINDING);
+        glDrawArraysInstanced(GL_TRIANGLES, 0, 6, count);
+    }
+}
+
+std::vector<glm::ivec4> MultiViewRenderer::GridLayout(int count, int tileWidth, int tileHeight, int columns) {
+    std::vector<glm::ivec4> viewports;
+    if (count <= 0) return viewports;
+    if (columns <= 0) {
+        columns = (int)std::ceil(std::sqrt((double)count));
+    }
+    int rows = (count + columns - 1) / columns;
+    
+    viewports.reserve(count);
+    for (int i = 0; i < count; i++) {
+        int column = i % columns;
+        int row = i / columns;
+        viewports.emplace_back(column * tileWidth, (rows - 1 - row) * tileHeight, tileWidth, tileHeight);
+    }
+    return viewports;
+}
+
+void MultiViewRenderer::CreateTarget(int w, int h) {
+    width = w;
+    height = h;
+    
+    if (texture == 0) {
+        glGenTextures(1, &texture);
+        glGenFramebuffers(1, &framebuffer);
+    }
+    
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "Multi-view atlas framebuffer is incomplete" << std::endl;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void MultiViewRenderer::Release() {
+    if (framebuffer != 0) {
+        glDeleteFramebuffers(1, &framebuffer);
+        framebuffer = 0;
+    }
+    if (texture != 0) {
+        glDeleteTextures(1, &texture);
+        texture = 0;
+    }
+}
@@ -0,0 +1,80 @@
+#include "PreIntegration.h"
+#include <algorithm>
+
+namespace {
+    // 传输函数按纹素中心线性插值后的一次积分，自变量u以条目为单位（u = value * n - 0.5），
+    // 下限为u = -0.5（value = 0），两端之外按边缘值延伸（GL_CLAMP_TO_EDGE）
+    // 分量：w = 消光，xyz = 消光 * 颜色
+    class TransferIntegral {
+    public:
+        explicit TransferIntegral(const std::vector<glm::vec4>& tf) : knots(tf.size()), prefix(tf.size()) {
+            for (size_t i = 0; i < tf.size(); i++) {
+                knots[i] = glm::vec4(glm::vec3(tf[i]) * tf[i].a, tf[i].a);
+            }
+            prefix[0] = 0.5f * knots[0];
+            for (size_t i = 1; i < knots.size(); i++) {
+                prefix[i] = prefix[i - 1] + 0.5f * (knots[i - 1] + knots[i]);
+            }
+        }
+        
+        // ∫[-0.5, u]
+        glm::vec4 At(float u) const {
+            const int last = (int)knots.size() - 1;
+            if (u <= 0.0f) {
+                return (u + 0.5f) * knots[0];
+            }
+            if (u >= (float)last) {
+                return prefix[last] + (u - (float)last) * knots[last];
+            }
+            int k = (int)u;
+            float t = u - (float)k;
+            return prefix[k] + t * knots[k] + 0.5f * t * t * (knots[k + 1] - knots[k]);
+        }
+        
+        const glm::vec4& Knot(int i) const { return knots[i]; }
+        
+    private:
+        std::vector<glm::vec4> knots;
+        std::vector<glm::vec4> prefix;
+    };
+}
+
+void PreIntegration::BuildTable(const std::vector<glm::vec4>& transferFunction, float threshold,
+                                std::vector<glm::vec4>& table) {
+    const int n = (int)transferFunction.size();
+    table.assign((size_t)n * n, glm::vec4(0.0f));
+    if (n == 0) return;
+    
+    TransferIntegral integral(transferFunction);
+    
+    // 阈值以下视为透明：I(u) = G(u) - G(min(u, uThreshold))
+    float uThreshold = std::max(threshold * n - 0.5f, -0.5f);
+    glm::vec4 belowThreshold = integral.At(uThreshold);
+    std::vector<glm::vec4> cut(n);
+    for (int i = 0; i < n; i++) {
+        cut[i] = (float)i > uThreshold ? integral.At((float)i) - belowThreshold : glm::vec4(0.0f);
+    }
+    
+    for (int back = 0; back < n; back++) {
+        for (int front = 0; front < n; front++) {
+            glm::vec4 sum;
+            float length;
+            if (front == back) {
+                // 零长度区间：退化为逐点采样
+                sum = (float)front > uThreshold ? integral.Knot(front) : glm::vec4(0.0f);
+                length = 1.0f;
+            } else {
+                sum = cut[back] - cut[front];
+                length = (float)(back - front);
+            }
+            
+            glm::vec4& entry = table[(size_t)back * n + front];
+            entry.a = sum.w / length;
+            if (std::abs(sum.w) > 1e-8f) {
+                entry.r = sum.x / sum.w;
+                entry.g = sum.y / sum.w;
+                entry.b = sum.z / sum.w;
+            }
+        }
+    }
+}
@@ -0,0 +1,259 @@
+#include "ProceduralVolume.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // 晶格坐标哈希用的大质数（每轴不同，避免对称）
+    const uint32_t PRIME_X = 0x8da6b343u;
+    const uint32_t PRIME_Y = 0xd8163841u;
+    const uint32_t PRIME_Z = 0xcb1ab31fu;
+    
+    // 坐标整体平移，保证晶格坐标非负（可用截断代替floor，便于向量化）
+    const float COORD_OFFSET = 256.0f;
+    
+    // 梯度为(±1, ±1, ±1)时噪声的理论范围约为±1.5，缩放到约[-1, 1]
+    const float NOISE_SCALE = 0.66f;
+    
+    inline uint32_t Hash(uint32_t h) {
+        h ^= h >> 16;
+        h *= 0x7feb352du;
+        h ^= h >> 15;
+        h *= 0x846ca68bu;
+        h ^= h >> 16;
+        return h;
+    }
+    
+    // 由种子和序号得到[0, 1)的确定性随机数
+    inline float Random(uint32_t seed, uint32_t index) {
+        return (Hash(seed * 0x9e3779b9u + index) >> 8) * (1.0f / 16777216.0f);
+    }
+    
+    // 五次平滑插值权重 6t^5 - 15t^4 + 10t^3
+    inline float Fade(float t) {
+        return t * t * t * (t * (t * 6.0f - 15.0f) + 10.0f);
+    }
+    
+    inline float Lerp(float a, float b, float t) {
+        return a + (b - a) * t;
+    }
+    
+    // 晶格点梯度(±1, ±1, ±1)的分量符号，取自哈希的高3位（无分支）
+    inline float GradSign(uint32_t h, int bit) {
+        return (float)(int)((h >> (30 - bit)) & 2u) - 1.0f;
+    }
+    
+    // 单行噪声求值用的临时缓冲（每个任务一份）
+    struct NoiseScratch {
+        std::vector<float> px;
+        std::vector<float> slope;
+        std::vector<float> offset;
+    };
+    
+    // 对一行采样点（px[i], py, pz）求3D梯度噪声（五次平滑的Perlin噪声），乘以amplitude后累加到out
+    // ABSOLUTE为真时累加噪声的绝对值（湍流）；px需单调递增
+    // 噪声对各角梯度点积是线性的，因此先按行内固定的y/z权重把每条x晶格列的4个角混合成
+    // 一次函数 slope * (fx - 列的x偏移) + offset（每列只哈希一次，按列批量计算），
+    // 单元内逐体素只剩x方向的多项式运算
+    template <bool ABSOLUTE>
+    void AddNoiseRow(const float* px, int count, float py, float pz, uint32_t seed, float amplitude,
+                     NoiseScratch& scratch, float* out) {
+        int iy = (int)py;
+        int iz = (int)pz;
+        float fy = py - (float)iy;
+        float fz = pz - (float)iz;
+        float wy = Fade(fy);
+        float wz = Fade(fz);
+        uint32_t hy0 = (uint32_t)iy * PRIME_Y;
+        uint32_t hy1 = hy0 + PRIME_Y;
+        uint32_t hz0 = (uint32_t)iz * PRIME_Z + seed;
+        uint32_t hz1 = hz0 + PRIME_Z;
+        uint32_t h00 = hy0 ^ hz0, h10 = hy1 ^ hz0, h01 = hy0 ^ hz1, h11 = hy1 ^ hz1;
+        float w00 = (1.0f - wy) * (1.0f - wz), w10 = wy * (1.0f - wz);
+        float w01 = (1.0f - wy) * wz, w11 = wy * wz;
+        
+        // 行内涉及的晶格列 [ixFirst, ixFirst + columns)
+        int ixFirst = (int)px[0];
+        int columns = (int)px[count - 1] - ixFirst + 2;
+        if ((int)scratch.slope.size() < columns) {
+            scratch.slope.resize(columns);
+            scratch.offset.resize(columns);
+        }
+        float* slope = scratch.slope.data();
+        float* offset = scratch.offset.data();
+        for (int c = 0; c < columns; c++) {
+            uint32_t hx = (uint32_t)(ixFirst + c) * PRIME_X;
+            uint32_t a = Hash(hx ^ h00), b = Hash(hx ^ h10), d = Hash(hx ^ h01), e = Hash(hx ^ h11);
+            slope[c] = w00 * GradSign(a, 0) + w10 * GradSign(b, 0) + w01 * GradSign(d, 0) + w11 * GradSign(e, 0);
+            offset[c] = w00 * (GradSign(a, 1) * fy          + GradSign(a, 2) * fz) +
+                        w10 * (GradSign(b, 1) * (fy - 1.0f) + GradSign(b, 2) * fz) +
+                        w01 * (GradSign(d, 1) * fy          + GradSign(d, 2) * (fz - 1.0f)) +
+                        w11 * (GradSign(e, 1) * (fy - 1.0f) + GradSign(e, 2) * (fz - 1.0f));
+        }
+        
+        float scaledAmplitude = amplitude * NOISE_SCALE;
+        int i = 0;
+        while (i < count) {
+            // 落在同一单元[ix, ix+1)内的连续采样点
+            int ix = (int)px[i];
+            int end = i + 1;
+            float limit = (float)(ix + 1);
+            while (end < count && px[end] < limit) {
+                end++;
+            }
+            
+            int c = ix - ixFirst;
+            float slope0 = slope[c], offset0 = offset[c];
+            float slope1 = slope[c + 1], offset1 = offset[c + 1] - slope[c + 1];
+            for (int k = i; k < end; k++) {
+                float fx = px[k] - (float)ix;
+                float n0 = slope0 * fx + offset0;
+                float n1 = slope1 * fx + offset1;
+                float n = n0 + (n1 - n0) * Fade(fx);
+                out[k] += scaledAmplitude * (ABSOLUTE ? std::fabs(n) : n);
+            }
+            i = end;
+        }
+    }
+    
+    // 一行的fBm：各倍频使用不同种子，结果按总振幅归一化
+    template <bool ABSOLUTE>
+    void FbmRow(const ProceduralParams& params, const float* u, int count, float v, float w,
+                NoiseScratch& scratch, float* out) {
+        std::fill(out, out + count, 0.0f);
+        float* px = scratch.px.data();
+        float frequency = params.frequency;
+        float amplitude = 1.0f;
+        float amplitudeSum = 0.0f;
+        for (int octave = 0; octave < std::max(params.octaves, 1); octave++) {
+            for (int i = 0; i < count; i++) {
+                px[i] = u[i] * frequency + COORD_OFFSET;
+            }
+            uint32_t seed = Hash(params.seed + (uint32_t)octave * 0x632be5abu);
+            AddNoiseRow<ABSOLUTE>(px, count, v * frequency + COORD_OFFSET, w * frequency + COORD_OFFSET,
+                                  seed, amplitude, scratch, out);
+            amplitudeSum += amplitude;
+            frequency *= params.lacunarity;
+            amplitude *= params.gain;
+        }
+        float normalize = amplitudeSum > 0.0f ? 1.0f / amplitudeSum : 0.0f;
+        for (int i = 0; i < count; i++) {
+            out[i] *= normalize;
+        }
+    }
+    
+    struct Sphere {
+        float x, y, z;
+        float invRadius2;
+        float radius2;
+        float density;
+    };
+    
+    std::vector<Sphere> MakeSpheres(const ProceduralParams& params, float extentX, float extentY, float extentZ) {
+        std::vector<Sphere> spheres(std::max(params.sphereCount, 0));
+        for (size_t i = 0; i < spheres.size(); i++) {
+            uint32_t base = (uint32_t)i * 8;
+            float radius = 0.06f + 0.16f * Random(params.seed, base + 3);
+            Sphere& s = spheres[i];
+            s.x = extentX * (0.15f + 0.7f * Random(params.seed, base + 0));
+            s.y = extentY * (0.15f + 0.7f * Random(params.seed, base + 1));
+            s.z = extentZ * (0.15f + 0.7f * Random(params.seed, base + 2));
+            s.radius2 = radius * radius;
+            s.invRadius2 = 1.0f / s.radius2;
+            s.density = 0.4f + 0.6f * Random(params.seed, base + 4);
+        }
+        return spheres;
+    }
+}
+
+void ProceduralVolume::GenerateSlices(const ProceduralParams& params, int width, int height, int depth,
+                                      int zBegin, int zEnd, unsigned char* out, ThreadPool& pool) {
+    // 归一化坐标：体素中心，最长轴为[0, 1]
+    float invMaxDim = 1.0f / (float)std::max(std::max(width, height), depth);
+    float extentX = width * invMaxDim;
+    float extentY = height * invMaxDim;
+    float extentZ = depth * invMaxDim;
+    std::vector<Sphere> spheres;
+    if (params.shape == ProceduralShape::Spheres) {
+        spheres = MakeSpheres(params, extentX, extentY, extentZ);
+    }
+    
+    std::vector<float> u(width);
+    for (int x = 0; x < width; x++) {
+        u[x] = (x + 0.5f) * invMaxDim;
+    }
+    
+    pool.ParallelFor(zBegin, zEnd, [&](int z) {
+        NoiseScratch scratch;
+        scratch.px.resize(width);
+        std::vector<float> value(width);
+        unsigned char* slice = out + (size_t)(z - zBegin) * width * height;
+        float w = (z + 0.5f) * invMaxDim;
+        
+        for (int y = 0; y < height; y++) {
+            float v = (y + 0.5f) * invMaxDim;
+            
+            switch (params.shape) {
+                case ProceduralShape::Clouds: {
+                    // fBm叠加以体积中心为球心的衰减，边缘渐隐为空
+                    FbmRow<false>(params, u.data(), width, v, w, scratch, value.data());
+                    float dy = v - extentY * 0.5f;
+                    float dz = w - extentZ * 0.5f;
+                    float dyz2 = dy * dy + dz * dz;
+                    for (int i = 0; i < width; i++) {
+                        float dx = u[i] - extentX * 0.5f;
+                        float r = 1.0f - (dx * dx + dyz2) * (1.0f / 0.16f);
+                        value[i] = (value[i] * 0.5f + 0.5f + r * 0.6f - 0.6f) * 2.5f;
+                    }
+                    break;
+                }
+                case ProceduralShape::Spheres: {
+                    std::fill(value.begin(), value.end(), 0.0f);
+                    for (const Sphere& s : spheres) {
+                        float dy = v - s.y;
+                        float dz = w - s.z;
+                        float dyz2 = dy * dy + dz * dz;
+                        if (dyz2 >= s.radius2) continue;   // 该行与球体不相交
+                        for (int i = 0; i < width; i++) {
+                            float dx = u[i] - s.x;
+                            float t = std::max(1.0f - (dx * dx + dyz2) * s.invRadius2, 0.0f);
+                            value[i] = std::max(value[i], s.density * t * t);
+                        }
+                    }
+                    break;
+                }
+                case ProceduralShape::Turbulence:
+                    FbmRow<true>(params, u.data(), width, v, w, scratch, value.data());
+                    for (int i = 0; i < width; i++) {
+                        value[i] = value[i] * 2.5f - 0.1f;
+                    }
+                    break;
+            }
+            
+            // 循环上界用局部变量：lambda按引用捕获的width可能与输出字节别名，编译器会放弃向量化
+            unsigned char* row = slice + (size_t)y * width;
+            const int count = width;
+            for (int i = 0; i < count; i++) {
+                float scaled = value[i] * 255.0f + 0.5f;
+                scaled = scaled < 0.0f ? 0.0f : scaled;
+                scaled = scaled > 255.0f ? 255.0f : scaled;
+                row[i] = (unsigned char)(int)scaled;
+            }
+        }
+    });
+}
+
+std::vector<unsigned char> ProceduralVolume::Generate(const ProceduralParams& params, int width, int height, int depth,
+                                                      ThreadPool& pool) {
+    std::vector<unsigned char> data((size_t)width * height * depth);
+    GenerateSlices(params, width, height, depth, 0, depth, data.data(), pool);
+    return data;
+}
+
+const char* ProceduralVolume::GetShapeName(ProceduralShape shape) {
+    switch (shape) {
+        case ProceduralShape::Clouds: return "Clouds";
+        case ProceduralShape::Spheres: return "Spheres";
+        case ProceduralShape::Turbulence: return "Turbulence";
+    }
+    return "Unknown";
+}
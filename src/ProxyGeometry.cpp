@@ -0,0 +1,176 @@
+#include "ProxyGeometry.h"
+#include <algorithm>
+#include <iostream>
+
+ProxyGeometry::ProxyGeometry()
+    : vao(0), vbo(0), vertexCount(0), boundsTexture(0), framebuffer(0), textureWidth(0), textureHeight(0),
+      renderSize(0) {
+}
+
+ProxyGeometry::~ProxyGeometry() {
+    Release();
+}
+
+bool ProxyGeometry::Initialize() {
+    shader = std::make_unique<Shader>();
+    if (!shader->LoadFromFile("shaders/proxy.vert", "shaders/proxy.frag")) {
+        std::cerr << "Failed to load proxy geometry shader" << std::endl;
+        return false;
+    }
+    
+    glGenVertexArrays(1, &vao);
+    glGenBuffers(1, &vbo);
+    glBindVertexArray(vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(glm::vec3), (void*)0);
+    glEnableVertexAttribArray(0);
+    glBindVertexArray(0);
+    return true;
+}
+
+void ProxyGeometry::Build(const std::vector<unsigned char>& occupancy, const glm::ivec3& gridSize,
+                          const glm::vec3& gridScale) {
+    auto occupied = [&](const glm::ivec3& cell) {
+        if (cell.x < 0 || cell.y < 0 || cell.z < 0 || cell.x >= gridSize.x || cell.y >= gridSize.y || cell.z >= gridSize.z) {
+            return false;
+        }
+        return occupancy[((size_t)cell.z * gridSize.y + cell.y) * gridSize.x + cell.x] != 0;
+    };
+    // 宏单元坐标 -> 纹理坐标（最后一层单元超出体积的部分截到1）
+    auto toTexture = [&](int axis, int value) {
+        return std::min((float)value / gridScale[axis], 1.0f);
+    };
+    
+    std::vector<glm::vec3> vertices;
+    if (occupancy.size() == (size_t)gridSize.x * gridSize.y * gridSize.z) {
+        for (int axis = 0; axis < 3; axis++) {
+            // (axis, u, v)为右手轮换，e_u x e_v = e_axis：正侧的面按 (u0,v0) (u1,v0) (u1,v1) 为逆时针（从外侧看）
+            int u = (axis + 1) % 3;
+            int v = (axis + 2) % 3;
+            for (int side = 0; side < 2; side++) {
+                glm::ivec3 normal(0);
+                normal[axis] = side ? 1 : -1;
+                
+                glm::ivec3 cell(0);
+                for (cell[axis] = 0; cell[axis] < gridSize[axis]; cell[axis]++) {
+                    for (cell[v] = 0; cell[v] < gridSize[v]; cell[v]++) {
+                        // 沿u轴把相邻的同向面合并为一个长条
+                        int runStart = -1;
+                        for (cell[u] = 0; cell[u] <= gridSize[u]; cell[u]++) {
+                            bool face = cell[u] < gridSize[u] && occupied(cell) && !occupied(cell + normal);
+                            if (face && runStart < 0) {
+                                runStart = cell[u];
+                            } else if (!face && runStart >= 0) {
+                                glm::vec3 corners[4];
+                                const int us[4] = { runStart, cell[u], cell[u], runStart };
+                                const int vs[4] = { cell[v], cell[v], cell[v] + 1, cell[v] + 1 };
+                                for (int i = 0; i < 4; i++) {
+                                    corners[i][axis] = toTexture(axis, cell[axis] + side);
+                                    corners[i][u] = toTexture(u, us[i]);
+                                    corners[i][v] = toTexture(v, vs[i]);
+                                }
+                                if (side) {
+                                    vertices.insert(vertices.end(), { corners[0], corners[1], corners[2],
+                                                                      corners[0], corners[2], corners[3] });
+                                } else {
+                                    vertices.insert(vertices.end(), { corners[0], corners[2], corners[1],
+                                                                      corners[0], corners[3], corners[2] });
+                                }
+                                runStart = -1;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+    
+    vertexCount = (int)vertices.size();
+    glBindBuffer(GL_ARRAY_BUFFER, vbo);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(glm::vec3), vertices.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void ProxyGeometry::Render(int width, int height, const glm::mat4& viewProjection, const glm::vec3& cameraPos,
+                           const glm::vec3& boxMin, const glm::vec3& boxMax) {
+    if (width > textureWidth || height > textureHeight) {
+        CreateTarget(std::max(width, textureWidth), std::max(height, textureHeight));
+    }
+    renderSize = glm::ivec2(width, height);
+    
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glViewport(0, 0, width, height);
+    glClearColor(MISS_DISTANCE, MISS_DISTANCE, MISS_DISTANCE, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    if (vertexCount == 0) return;
+    
+    // 正反面都不剔除、不做深度测试：MIN混合同时得到最近正面、最近背面和最远背面
+    shader->Use();
+    shader->SetMat4("viewProjection", viewProjection);
+    shader->SetVec3("cameraPos", cameraPos);
+    shader->SetVec3("boxMin", boxMin);
+    shader->SetVec3("boxMax", boxMax);
+    
+    glEnable(GL_BLEND);
+    glBlendEquation(GL_MIN);
+    glBindVertexArray(vao);
+    glDrawArrays(GL_TRIANGLES, 0, vertexCount);
+    glBindVertexArray(0);
+    glBlendEquation(GL_FUNC_ADD);
+    glDisable(GL_BLEND);
+}
+
+void ProxyGeometry::Bind(GLuint textureUnit) const {
+    glActiveTexture(GL_TEXTURE0 + textureUnit);
+    glBindTexture(GL_TEXTURE_2D, boundsTexture);
+}
+
+glm::vec2 ProxyGeometry::GetBoundsScale() const {
+    if (textureWidth == 0 || textureHeight == 0) return glm::vec2(1.0f);
+    return glm::vec2((float)renderSize.x / (float)textureWidth, (float)renderSize.y / (float)textureHeight);
+}
+
+void ProxyGeometry::CreateTarget(int width, int height) {
+    textureWidth = width;
+    textureHeight = height;
+    
+    if (boundsTexture == 0) {
+        glGenTextures(1, &boundsTexture);
+        glGenFramebuffers(1, &framebuffer);
+    }
+    
+    // 距离需要完整精度（半精度在距离2处的误差约为0.002，与步长同一量级）；逐像素读取，不过滤
+    glBindTexture(GL_TEXTURE_2D, boundsTexture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, width, height, 0, GL_RGBA, GL_FLOAT, nullptr);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, boundsTexture, 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "Proxy geometry framebuffer is incomplete" << std::endl;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void ProxyGeometry::Release() {
+    if (framebuffer != 0) {
+        glDeleteFramebuffers(1, &framebuffer);
+        framebuffer = 0;
+    }
+    if (boundsTexture != 0) {
+        glDeleteTextures(1, &boundsTexture);
+        boundsTexture = 0;
+    }
+    if (vbo != 0) {
+        glDeleteBuffers(1, &vbo);
+        vbo = 0;
+    }
+    if (vao != 0) {
+        glDeleteVertexArrays(1, &vao);
+        vao = 0;
+    }
+}
@@ -0,0 +1,132 @@
+#include "RayStatistics.h"
+#include <algorithm>
+#include <iostream>
+
+RayStatistics::RayStatistics()
+    : texture(0), fbo(0), pbo(0), fence(nullptr), width(0), height(0), readSize(0), frameCounter(0) {
+}
+
+RayStatistics::~RayStatistics() {
+    Release();
+}
+
+bool RayStatistics::Initialize(const std::function<void(Shader&)>& setup) {
+    countShader = std::make_unique<Shader>();
+    if (!countShader->LoadFromFile("shaders/raymarching.vert", "shaders/raymarching.frag", "#define COUNT_SAMPLES 1\n")) {
+        std::cerr << "Failed to load sample counting shader" << std::endl;
+        return false;
+    }
+    setup(*countShader);
+    return true;
+}
+
+bool RayStatistics::Begin(int screenWidth, int screenHeight) {
+    // 上一次的回读尚未取回时推迟，同一时刻只有一次统计在途
+    if (fence || ++frameCounter < INTERVAL_FRAMES) return false;
+    frameCounter = 0;
+    
+    int w = std::max(1, screenWidth / DIVISOR);
+    int h = std::max(1, screenHeight / DIVISOR);
+    if (w != width || h != height) {
+        CreateTarget(w, h);
+    }
+    
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glViewport(0, 0, width, height);
+    countShader->Use();
+    return true;
+}
+
+void RayStatistics::End(int screenWidth, int screenHeight) {
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_FLOAT, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    readSize = width * height;
+    
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, screenWidth, screenHeight);
+}
+
+bool RayStatistics::Poll(float& samplesPerRay, float& stepsPerRay, int& maxSamplesPerRay) {
+    if (!fence) return false;
+    GLenum status = glClientWaitSync(fence, 0, 0);
+    if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) return false;
+    glDeleteSync(fence);
+    fence = nullptr;
+    
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+    const float* pixels = static_cast<const float*>(
+        glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, readSize * 4 * sizeof(float), GL_MAP_READ_BIT));
+    if (!pixels) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        return false;
+    }
+    
+    // r = 采样数，g = 步数，b = 1表示命中包围盒；只统计命中的光线
+    double samples = 0.0, steps = 0.0;
+    int rays = 0;
+    int maxSamples = 0;
+    for (int i = 0; i < readSize; i++) {
+        if (pixels[i * 4 + 2] <= 0.0f) continue;
+        samples += pixels[i * 4 + 0];
+        steps += pixels[i * 4 + 1];
+        maxSamples = std::max(maxSamples, (int)pixels[i * 4 + 0]);
+        rays++;
+    }
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    
+    samplesPerRay = rays > 0 ? (float)(samples / rays) : 0.0f;
+    stepsPerRay = rays > 0 ? (float)(steps / rays) : 0.0f;
+    maxSamplesPerRay = maxSamples;
+    return true;
+}
+
+void RayStatistics::CreateTarget(int w, int h) {
+    width = w;
+    height = h;
+    
+    if (texture == 0) {
+        glGenTextures(1, &texture);
+        glGenFramebuffers(1, &fbo);
+        glGenBuffers(1, &pbo);
+    }
+    
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, w, h, 0, GL_RGBA, GL_FLOAT, nullptr);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "Ray statistics framebuffer is incomplete" << std::endl;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pbo);
+    glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr)w * h * 4 * sizeof(float), nullptr, GL_STREAM_READ);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+void RayStatistics::Release() {
+    if (fence) {
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+    if (pbo != 0) {
+        glDeleteBuffers(1, &pbo);
+        pbo = 0;
+    }
+    if (fbo != 0) {
+        glDeleteFramebuffers(1, &fbo);
+        fbo = 0;
+    }
+    if (texture != 0) {
+        glDeleteTextures(1, &texture);
+        texture = 0;
+    }
+}
@@ -1,18 +1,103 @@
 #include "Renderer.h"
-#include <GLFW/glfw3.h>
+#include "PreIntegration.h"
+#include "VolumeGeometry.h"
 #include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <string>
 #include <glm/gtc/matrix_transform.hpp>
 
+namespace {
+    // 单调时钟（秒），不依赖窗口系统，无窗口的基准测试也可以使用
+    double GetTimeSeconds() {
+        static const auto start = std::chrono::steady_clock::now();
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    
+    // 除摄像机外影响画面的参数是否变化（变化后时间累积的历史失效）
+    bool ImageParamsChanged(const RenderParams& a, const RenderParams& b) {
+        return a.stepSize != b.stepSize || a.density != b.density || a.threshold != b.threshold ||
+               a.enableLighting != b.enableLighting || a.absorptionCoeff != b.absorptionCoeff ||
+               a.scatteringCoeff != b.scatteringCoeff || a.lightDir != b.lightDir || a.maxSteps != b.maxSteps ||
+               a.enableJittering != b.enableJittering || a.enablePreIntegration != b.enablePreIntegration ||
+               a.enableLod != b.enableLod || a.lodBias != b.lodBias ||
+               a.windowWidth != b.windowWidth || a.windowCenter != b.windowCenter;
+    }
+    
+    // 光线投射shader变体的特性位（低32位），高32位为最大步数
+    enum RayMarchingFeature : uint64_t {
+        FEATURE_LIGHTING = 1 << 0,
+        FEATURE_JITTERING = 1 << 1,
+        FEATURE_EMPTY_SPACE_SKIPPING = 1 << 2,
+        FEATURE_PRE_INTEGRATION = 1 << 3,
+        FEATURE_NATIVE_DENSITY = 1 << 4,
+        FEATURE_BRICK_CACHE = 1 << 5,
+        FEATURE_OUTPUT_DEPTH = 1 << 6,
+        FEATURE_PROXY_BOUNDS = 1 << 7
+    };
+    
+    // 附加通道数占用的特性位（2位，0 ~ VolumeChannels::MAX_CHANNELS）
+    const int CHANNEL_COUNT_SHIFT = 8;
+    const uint64_t CHANNEL_COUNT_MASK = 3;
+    
+    // 由变体键生成注入raymarching.frag的预处理定义
+    std::string RayMarchingDefines(uint64_t key) {
+        static const std::pair<RayMarchingFeature, const char*> features[] = {
+            { FEATURE_LIGHTING, "FEATURE_LIGHTING" },
+            { FEATURE_JITTERING, "FEATURE_JITTERING" },
+            { FEATURE_EMPTY_SPACE_SKIPPING, "FEATURE_EMPTY_SPACE_SKIPPING" },
+            { FEATURE_PRE_INTEGRATION, "FEATURE_PRE_INTEGRATION" },
+            { FEATURE_NATIVE_DENSITY, "FEATURE_NATIVE_DENSITY" },
+            { FEATURE_BRICK_CACHE, "FEATURE_BRICK_CACHE" },
+            { FEATURE_OUTPUT_DEPTH, "FEATURE_OUTPUT_DEPTH" },
+            { FEATURE_PROXY_BOUNDS, "FEATURE_PROXY_BOUNDS" }
+        };
+        std::string defines = "#define SPECIALIZED 1\n";
+        for (const auto& feature : features) {
+            defines += std::string("#define ") + feature.second + ((key & feature.first) ? " 1\n" : " 0\n");
+        }
+        defines += "#define SPECIALIZED_CHANNEL_COUNT " + std::to_string((key >> CHANNEL_COUNT_SHIFT) & CHANNEL_COUNT_MASK) + "\n";
+        defines += "#define SPECIALIZED_MAX_STEPS " + std::to_string(key >> 32) + "\n";
+        return defines;
+    }
+    
+    // 纹理单元固定不变，每个程序只在链接后设置一次；其余状态通过uniform缓冲按帧更新
+    void SetupRayMarchingShader(Shader& shader) {
+        shader.Use();
+        shader.SetInt("volumeTexture", 0);
+        shader.SetInt("transferFunction", 1);
+        shader.SetInt("macrocellTexture", 2);
+        shader.SetInt("brickAtlas", 3);
+        shader.SetInt("brickPageTable", 4);
+        shader.SetInt("densityTexture", 5);
+        shader.SetInt("preIntegrationTable", 6);
+        shader.SetInt("rayBoundsTexture", 13);
+        for (int i = 0; i < VolumeChannels::MAX_CHANNELS; i++) {
+            shader.SetInt("channelVolume" + std::to_string(i), VolumeChannels::FIRST_VOLUME_UNIT + i);
+            shader.SetInt("channelTransferFunction" + std::to_string(i), VolumeChannels::FIRST_TRANSFER_FUNCTION_UNIT + i);
+        }
+        shader.BindUniformBlock("CameraBlock", CAMERA_BLOCK_BINDING);
+        shader.BindUniformBlock("RenderBlock", RENDER_BLOCK_BINDING);
+        shader.BindUniformBlock("ChannelBlock", CHANNEL_BLOCK_BINDING);
+        shader.BindUniformBlock("ViewBlock", VIEW_BLOCK_BINDING);
+    }
+}
+
 Renderer::Renderer() 
-    : screenWidth(800), screenHeight(600),
-      transferFunctionTexture(0), quadVAO(0), quadVBO(0),
-      lastFrameTime(0.0f), deltaTime(0.0f), frameCount(0), fpsTimer(0.0f) {
+    : screenWidth(800), screenHeight(600), gradientFilter(GradientFilter::CentralDifference),
+      transferFunctionTexture(0), preIntegrationTexture(0), quadVAO(0), quadVBO(0), motionLod(0.0f),
+      lastFrameTime(0.0f), deltaTime(0.0f), frameCount(0), fpsTimer(0.0f), frameDirty(true), rayMarchingVariant(0),
+      computeVariant(0), presentToScreen(true) {
 }
 
 Renderer::~Renderer() {
     if (transferFunctionTexture != 0) {
         glDeleteTextures(1, &transferFunctionTexture);
     }
+    if (preIntegrationTexture != 0) {
+        glDeleteTextures(1, &preIntegrationTexture);
+    }
     if (quadVAO != 0) {
         glDeleteVertexArrays(1, &quadVAO);
     }
@@ -31,12 +116,53 @@ bool Renderer::InitRenderer(int width, int height) {
     cameraController = std::make_unique<CameraController>();
     cameraController->SetAspectRatio((float)width / (float)height);
     
-    // 加载Ray Marching Shader
-    rayMarchingShader = std::make_unique<Shader>();
-    if (!rayMarchingShader->LoadFromFile("shaders/raymarching.vert", "shaders/raymarching.frag")) {
+    // 加载Ray Marching Shader：先同步编译通用程序，按当前特性组合特化的变体在后台编译
+    rayMarchingShaders = std::make_unique<ShaderCache>(
+        "shaders/raymarching.vert", "shaders/raymarching.frag", SetupRayMarchingShader);
+    if (!rayMarchingShaders->Initialize()) {
         std::cerr << "Failed to load ray marching shaders" << std::endl;
         return false;
     }
+    if (!cameraUniformBuffer.Create(sizeof(CameraUniforms)) || !renderUniformBuffer.Create(sizeof(RenderUniforms)) ||
+        !channelUniformBuffer.Create(sizeof(ChannelUniforms))) {
+        std::cerr << "Failed to create uniform buffers" << std::endl;
+        return false;
+    }
+    
+    // 动态分辨率的离屏目标、上采样shader和GPU计时
+    dynamicResolution = std::make_unique<DynamicResolution>();
+    if (!dynamicResolution->Initialize()) {
+        return false;
+    }
+    frameProfiler = std::make_unique<FrameProfiler>();
+    rayStatistics = std::make_unique<RayStatistics>();
+    if (!rayStatistics->Initialize(SetupRayMarchingShader)) {
+        return false;
+    }
+    frameCache = std::make_unique<FrameCache>();
+    
+    // 计算shader路径为可选后端：上下文低于GL 4.3或编译失败时只使用片段路径
+    if (ComputeRayMarcher::IsSupported()) {
+        computeRayMarcher = std::make_unique<ComputeRayMarcher>();
+        if (!computeRayMarcher->Initialize(SetupRayMarchingShader)) {
+            computeRayMarcher.reset();
+        }
+    }
+    multiViewRenderer = std::make_unique<MultiViewRenderer>();
+    if (!multiViewRenderer->Initialize(SetupRayMarchingShader)) {
+        return false;
+    }
+    proxyGeometry = std::make_unique<ProxyGeometry>();
+    if (!proxyGeometry->Initialize()) {
+        return false;
+    }
+    volumeChannels = std::make_unique<VolumeChannels>();
+    
+    // 时间累积的历史缓冲和混合shader
+    temporalAccumulation = std::make_unique<TemporalAccumulation>();
+    if (!temporalAccumulation->Initialize()) {
+        return false;
+    }
     
     // 创建全屏四边形
     CreateFullScreenQuad();
@@ -51,7 +177,7 @@ bool Renderer::InitRenderer(int width, int height) {
     }
     
     // 初始化性能计时
-    lastFrameTime = (float)glfwGetTime();
+    lastFrameTime = (float)GetTimeSeconds();
     
     std::cout << "Renderer initialized successfully" << std::endl;
     return true;
@@ -59,55 +185,246 @@ bool Renderer::InitRenderer(int width, int height) {
 
 void Renderer::RenderFrame() {
     // 计算帧时间
-    float currentTime = (float)glfwGetTime();
+    float currentTime = (float)GetTimeSeconds();
     deltaTime = currentTime - lastFrameTime;
     lastFrameTime = currentTime;
     
+    // 取回各阶段的GPU时间（若干帧之前的测量值），记录帧间隔
+    frameProfiler->BeginFrame(deltaTime * 1000.0f);
+    
     // 更新FPS统计
     frameCount++;
     fpsTimer += deltaTime;
     if (fpsTimer >= 1.0f) {
         renderStats.fps = frameCount / fpsTimer;
         renderStats.frameTimeMs = (fpsTimer / frameCount) * 1000.0f;
+        renderStats.frameTime = frameProfiler->GetFramePercentiles();
+        for (int i = 0; i < FrameProfiler::PASS_COUNT; i++) {
+            renderStats.passTime[i] = frameProfiler->GetPassPercentiles((GpuPass)i);
+        }
         frameCount = 0;
         fpsTimer = 0.0f;
     }
     
-    // 清屏
-    glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
-    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    // 摄像机运动时降到更粗的LOD层级，静止后逐渐收敛回全分辨率
+    bool cameraMoved = cameraController->ConsumeMovement();
+    if (cameraMoved) {
+        motionLod = renderParams.motionLodBias;
+    } else {
+        motionLod = std::max(0.0f, motionLod - deltaTime * MOTION_LOD_RECOVERY_RATE);
+    }
+    
+    // 代理几何、光线步进、时间累积与上采样的GPU时间驱动动态分辨率（查询结果在若干帧后才可用，不阻塞）
+    if (frameProfiler->HasFrameResult(GpuPass::RayMarch)) {
+        float gpuTimeMs = frameProfiler->GetFrameMs(GpuPass::Proxy) + frameProfiler->GetFrameMs(GpuPass::RayMarch) + frameProfiler->GetFrameMs(GpuPass::Temporal) +
+                          frameProfiler->GetFrameMs(GpuPass::Present);
+        renderStats.gpuTimeMs = gpuTimeMs;
+        if (renderParams.enableDynamicResolution) {
+            dynamicResolution->Update(gpuTimeMs, renderParams.targetFrameTimeMs, renderParams.minResolutionScale);
+        }
+    }
+    if (!renderParams.enableDynamicResolution) {
+        dynamicResolution->Reset();
+    }
+    renderStats.resolutionScale = dynamicResolution->GetScale();
+    
+    // 关闭时间累积后丢弃历史，重新开启时从当前帧开始累积
+    if (!renderParams.enableTemporalAccumulation) {
+        temporalAccumulation->Invalidate();
+    }
+    
+    // 推进异步加载（上传少量切片，完成后替换体数据）
+    frameProfiler->BeginPass(GpuPass::Upload);
+    UpdateAsyncLoad();
     
-    // 使用Ray Marching shader
-    rayMarchingShader->Use();
+    // 时间序列：推进播放，上传预取好的步，显示的步变化后重新分类宏单元
+    if (timeSeries && timeSeries->Update(deltaTime)) {
+        UpdateMacrocellClassification();
+        InvalidateFrame();
+    }
     
-    // 更新uniform变量
+    // 分块缓存：处理反馈、上传已就绪的块
+    if (brickCache) {
+        brickCache->Update();
+        renderStats.residentBricks = brickCache->GetResidentBrickCount();
+    }
+    frameProfiler->EndPass(GpuPass::Upload);
+    
+    float samplesPerRay = 0.0f, stepsPerRay = 0.0f;
+    int maxSamplesPerRay = 0;
+    if (rayStatistics->Poll(samplesPerRay, stepsPerRay, maxSamplesPerRay)) {
+        renderStats.samplesPerRay = samplesPerRay;
+        renderStats.stepsPerRay = stepsPerRay;
+        renderStats.maxSamplesPerRay = maxSamplesPerRay;
+    }
+    
+    // 画面不会变化时直接呈现缓存的上一帧，不更新uniform也不重新光线步进：
+    // 需要重新渲染的情况为参数/传输函数/体数据/窗口尺寸变化、摄像机运动或LOD仍在收敛、
+    // 分块仍在载入、时间累积尚未达到最大帧数
+    bool converging = motionLod > 0.0f || (brickCache && brickCache->IsStreaming()) ||
+                      (renderParams.enableTemporalAccumulation &&
+                       temporalAccumulation->GetSampleCount() < renderParams.temporalMaxSamples);
+    if (!frameDirty && !cameraMoved && !converging && frameCache->IsValid(screenWidth, screenHeight)) {
+        frameProfiler->BeginPass(GpuPass::Present);
+        PresentFrame();
+        frameProfiler->EndPass(GpuPass::Present);
+        renderStats.cachedFrame = true;
+        return;
+    }
+    frameDirty = false;
+    renderStats.cachedFrame = false;
+    
+    // 代理几何：以本帧光线步进的分辨率（未启用动态分辨率时比例为1）画出各像素的入口/出口距离
+    bool useProxy = UseProxyBounds();
+    if (useProxy) {
+        frameProfiler->BeginPass(GpuPass::Proxy);
+        glm::ivec2 renderSize = dynamicResolution->GetRenderSize(screenWidth, screenHeight);
+        glm::vec3 boxExtent = GetBoxExtent();
+        proxyGeometry->Render(renderSize.x, renderSize.y,
+                              cameraController->GetProjectionMatrix() * cameraController->GetViewMatrix(),
+                              cameraController->GetCamera().position, -0.5f * boxExtent, 0.5f * boxExtent);
+        frameProfiler->EndPass(GpuPass::Proxy);
+    }
+    renderStats.proxyTriangles = useProxy ? proxyGeometry->GetTriangleCount() : 0;
+    
+    // 使用Ray Marching shader（特化变体尚未编译完成时使用通用程序）
+    // 计算路径只替换主光线步进pass，分块反馈和采样数统计仍使用片段程序
+    bool useCompute = renderParams.enableComputeRayMarching && computeRayMarcher;
+    SelectRayMarchingVariant();
+    rayMarchingShaders->Update();
+    if (computeRayMarcher) {
+        computeRayMarcher->Update();
+    }
+    Shader& rayMarchingShader = rayMarchingShaders->Get(rayMarchingVariant);
+    rayMarchingShader.Use();
+    renderStats.specializedShader = useCompute ? computeRayMarcher->IsReady(rayMarchingVariant)
+                                               : rayMarchingShaders->IsReady(rayMarchingVariant);
+    renderStats.shaderVariants = rayMarchingShaders->GetVariantCount();
+    renderStats.computeRayMarching = useCompute;
+    
+    // 更新uniform缓冲（纹理单元在初始化时已设置）并绑定纹理
     UpdateUniforms();
+    BindVolumeTextures();
     
-    // 绑定体数据纹理
-    if (volumeData) {
-        volumeData->Bind(0);
+    glBindVertexArray(quadVAO);
+    
+    // 分块缓存：先以低分辨率绘制一次反馈pass，记录光线访问/缺失的块
+    if (brickCache) {
+        frameProfiler->BeginPass(GpuPass::Feedback);
+        brickCache->BeginFeedback(screenWidth, screenHeight);
+        glDrawArrays(GL_TRIANGLES, 0, 6);
+        brickCache->EndFeedback(screenWidth, screenHeight);
+        frameProfiler->EndPass(GpuPass::Feedback);
     }
     
-    // 绑定传输函数纹理
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_1D, transferFunctionTexture);
+    // 定期以低分辨率统计每条光线的采样数
+    if (rayStatistics->Begin(screenWidth, screenHeight)) {
+        glDrawArrays(GL_TRIANGLES, 0, 6);
+        rayStatistics->End(screenWidth, screenHeight);
+        rayMarchingShader.Use();
+    }
+    
+    if (useCompute || renderParams.enableDynamicResolution || renderParams.enableTemporalAccumulation) {
+        // 以缩放后的分辨率渲染到离屏目标（未启用动态分辨率时比例为1），再上采样到窗口；计算路径总是写入离屏纹理
+        frameProfiler->BeginPass(GpuPass::RayMarch);
+        dynamicResolution->BeginScene(screenWidth, screenHeight);
+        if (useCompute) {
+            glm::ivec2 renderSize = dynamicResolution->GetRenderSize(screenWidth, screenHeight);
+            computeRayMarcher->Dispatch(rayMarchingVariant, dynamicResolution->GetColorTexture(), renderSize.x, renderSize.y);
+        } else {
+            glDrawArrays(GL_TRIANGLES, 0, 6);
+        }
+        frameProfiler->EndPass(GpuPass::RayMarch);
+        
+        // 与重投影的历史混合；LOD仍在收敛时画面在变化，按运动处理
+        GLuint sceneTexture = dynamicResolution->GetColorTexture();
+        if (renderParams.enableTemporalAccumulation) {
+            frameProfiler->BeginPass(GpuPass::Temporal);
+            sceneTexture = temporalAccumulation->Resolve(
+                sceneTexture, dynamicResolution->GetRenderSize(screenWidth, screenHeight), screenWidth, screenHeight,
+                cameraController->GetViewMatrix(), cameraController->GetProjectionMatrix(),
+                motionLod == 0.0f, renderParams.temporalMaxSamples);
+            frameProfiler->EndPass(GpuPass::Temporal);
+        }
+        frameProfiler->BeginPass(GpuPass::Present);
+        frameCache->Begin(screenWidth, screenHeight);
+        dynamicResolution->Upsample(screenWidth, screenHeight, sceneTexture, frameCache->GetFramebuffer());
+    } else {
+        // 清屏
+        frameProfiler->BeginPass(GpuPass::RayMarch);
+        frameCache->Begin(screenWidth, screenHeight);
+        glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        
+        // 渲染全屏四边形
+        glDrawArrays(GL_TRIANGLES, 0, 6);
+        frameProfiler->EndPass(GpuPass::RayMarch);
+        frameProfiler->BeginPass(GpuPass::Present);
+    }
+    glBindVertexArray(0);
+    
+    // 最终画面保留在缓存中，空闲时直接复制
+    PresentFrame();
+    frameProfiler->EndPass(GpuPass::Present);
+    renderStats.accumulatedFrames = renderParams.enableTemporalAccumulation ? temporalAccumulation->GetSampleCount() : 0;
+}
+
+bool Renderer::RenderViews(const std::vector<BatchView>& views, int atlasWidth, int atlasHeight) {
+    GLint maxSize = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+    if (views.empty() || atlasWidth <= 0 || atlasHeight <= 0 || atlasWidth > maxSize || atlasHeight > maxSize) {
+        std::cerr << "Invalid multi-view batch: " << views.size() << " views, atlas " << atlasWidth << "x" << atlasHeight
+                  << " (GL_MAX_TEXTURE_SIZE " << maxSize << ")" << std::endl;
+        return false;
+    }
     
-    // 渲染全屏四边形
+    // 共享状态只上传/绑定一次，各视图的摄像机由多视图程序按实例读取
+    UpdateUniforms(true);
+    BindVolumeTextures();
     glBindVertexArray(quadVAO);
-    glDrawArrays(GL_TRIANGLES, 0, 6);
+    multiViewRenderer->Render(views, atlasWidth, atlasHeight);
     glBindVertexArray(0);
+    
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, screenWidth, screenHeight);
+    return true;
 }
 
 void Renderer::SetRenderParams(const RenderParams& params) {
+    // 阈值、密度或窗宽/窗位变化会改变宏单元的空/非空分类
+    bool reclassify = params.threshold != renderParams.threshold || params.density != renderParams.density ||
+                      params.windowWidth != renderParams.windowWidth || params.windowCenter != renderParams.windowCenter;
+    bool thresholdChanged = params.threshold != renderParams.threshold;
+    if (ImageParamsChanged(params, renderParams)) {
+        InvalidateFrame();
+    }
+    // 切换离屏路径、光线步进后端或提高最大累积帧数只需重新渲染，历史仍然有效
+    if (params.enableDynamicResolution != renderParams.enableDynamicResolution ||
+        params.enableTemporalAccumulation != renderParams.enableTemporalAccumulation ||
+        params.temporalMaxSamples != renderParams.temporalMaxSamples ||
+        params.enableComputeRayMarching != renderParams.enableComputeRayMarching ||
+        params.enableProxyGeometry != renderParams.enableProxyGeometry) {
+        frameDirty = true;
+    }
     renderParams = params;
+    if (reclassify) {
+        UpdateMacrocellClassification();
+    }
+    // 预积分表中烘焙了阈值
+    if (thresholdChanged) {
+        UpdatePreIntegrationTable();
+    }
 }
 
 void Renderer::SetCamera(const Camera& camera) {
     cameraController->GetCamera() = camera;
+    frameDirty = true;
 }
 
 void Renderer::SetTransferFunction(const std::vector<glm::vec4>& colors) {
     UpdateTransferFunctionTexture(colors);
+    UpdateMacrocellClassification();
+    InvalidateFrame();
 }
 
 void Renderer::Resize(int width, int height) {
@@ -115,20 +432,172 @@ void Renderer::Resize(int width, int height) {
     screenHeight = height;
     glViewport(0, 0, width, height);
     cameraController->SetAspectRatio((float)width / (float)height);
+    frameDirty = true;
 }
 
 RenderStats Renderer::GetRenderStats() const {
     return renderStats;
 }
 
+bool Renderer::WriteTimingCsv(const std::string& filename) const {
+    return frameProfiler->WriteCsv(filename);
+}
+
 bool Renderer::LoadVolumeData(const std::string& filename, int width, int height, int depth) {
+    brickCache.reset();
+    timeSeries.reset();
     volumeData = std::make_unique<VolumeData>();
-    return volumeData->LoadFromFile(filename, width, height, depth);
+    volumeData->SetGradientFilter(gradientFilter);
+    if (!volumeData->LoadFromFile(filename, width, height, depth)) {
+        return false;
+    }
+    UpdateMacrocellClassification();
+    InvalidateFrame();
+    return true;
+}
+
+bool Renderer::LoadVolumeData(const std::string& filename) {
+    brickCache.reset();
+    timeSeries.reset();
+    volumeData = std::make_unique<VolumeData>();
+    volumeData->SetGradientFilter(gradientFilter);
+    if (!volumeData->LoadFromFile(filename)) {
+        return false;
+    }
+    UpdateMacrocellClassification();
+    InvalidateFrame();
+    return true;
+}
+
+bool Renderer::LoadVolumeDataAsync(const std::string& filename, int width, int height, int depth) {
+    return volumeLoader.Start(filename, width, height, depth, gradientFilter);
+}
+
+bool Renderer::LoadVolumeDataBricked(const std::string& filename, int width, int height, int depth,
+                                     uint64_t atlasBudgetBytes) {
+    auto cache = std::make_unique<BrickCache>();
+    if (!cache->Open(filename, width, height, depth, gradientFilter, atlasBudgetBytes)) {
+        return false;
+    }
+    volumeLoader.Cancel();
+    volumeData.reset();
+    timeSeries.reset();
+    brickCache = std::move(cache);
+    InvalidateFrame();
+    return true;
 }
 
-bool Renderer::GenerateTestVolume(int size) {
+void Renderer::UpdateAsyncLoad() {
+    AsyncVolumeLoader::State state = volumeLoader.Update();
+    if (state == AsyncVolumeLoader::State::Completed) {
+        // 新体数据完整上传后才替换，替换发生在两帧之间
+        volumeData = volumeLoader.TakeResult();
+        brickCache.reset();
+        timeSeries.reset();
+        UpdateMacrocellClassification();
+        InvalidateFrame();
+    } else if (state == AsyncVolumeLoader::State::Failed) {
+        std::cerr << "Async volume load failed, keeping current volume" << std::endl;
+        volumeLoader.Cancel();
+    }
+}
+
+bool Renderer::GenerateTestVolume(int size, const ProceduralParams& params) {
+    brickCache.reset();
+    timeSeries.reset();
     volumeData = std::make_unique<VolumeData>();
-    return volumeData->GenerateProceduralData(size, size, size);
+    volumeData->SetGradientFilter(gradientFilter);
+    if (!volumeData->GenerateProceduralData(size, size, size, params)) {
+        return false;
+    }
+    UpdateMacrocellClassification();
+    InvalidateFrame();
+    return true;
+}
+
+bool Renderer::LoadTimeSeries(const std::string& pattern, int firstIndex, int stepCount, int width, int height,
+                              int depth, uint64_t ramBudgetBytes) {
+    auto series = std::make_unique<TimeSeriesVolume>();
+    if (!series->Open(pattern, firstIndex, stepCount, width, height, depth, gradientFilter, ramBudgetBytes)) {
+        return false;
+    }
+    // 第一步上传完成前不显示体数据
+    volumeLoader.Cancel();
+    brickCache.reset();
+    volumeData.reset();
+    timeSeries = std::move(series);
+    InvalidateFrame();
+    return true;
+}
+
+int Renderer::AddChannel(const std::string& filename, const std::vector<glm::vec4>& transferFunction,
+                         const ChannelParams& params) {
+    auto volume = std::make_unique<VolumeData>();
+    volume->SetGradientFilter(gradientFilter);
+    if (!volume->LoadFromFile(filename)) {
+        return -1;
+    }
+    return AddChannelVolume(std::move(volume), transferFunction, params);
+}
+
+int Renderer::AddProceduralChannel(int size, const ProceduralParams& procedural,
+                                   const std::vector<glm::vec4>& transferFunction, const ChannelParams& params) {
+    auto volume = std::make_unique<VolumeData>();
+    volume->SetGradientFilter(gradientFilter);
+    if (!volume->GenerateProceduralData(size, size, size, procedural)) {
+        return -1;
+    }
+    return AddChannelVolume(std::move(volume), transferFunction, params);
+}
+
+int Renderer::AddChannelVolume(std::unique_ptr<VolumeData> volume, const std::vector<glm::vec4>& transferFunction,
+                               const ChannelParams& params) {
+    int index = volumeChannels->Add(std::move(volume), transferFunction, params);
+    if (index >= 0) {
+        InvalidateFrame();
+    }
+    return index;
+}
+
+void Renderer::RemoveChannel(int index) {
+    volumeChannels->Remove(index);
+    InvalidateFrame();
+}
+
+void Renderer::SetChannelParams(int index, const ChannelParams& params) {
+    volumeChannels->SetParams(index, params);
+    InvalidateFrame();
+}
+
+void Renderer::SetChannelTransferFunction(int index, const std::vector<glm::vec4>& colors) {
+    volumeChannels->SetTransferFunction(index, colors);
+    InvalidateFrame();
+}
+
+int Renderer::GetActiveChannelCount() const {
+    // 分块核外模式的空块/未驻留块跳跃会跨过附加通道的内容，不渲染附加通道
+    return brickCache ? 0 : volumeChannels->GetActiveCount();
+}
+
+VolumeData* Renderer::GetActiveVolume() const {
+    return timeSeries ? timeSeries->GetCurrentFrame() : volumeData.get();
+}
+
+glm::vec3 Renderer::GetBoxExtent() const {
+    // 包围盒按物理尺寸（体素数 * 间距）确定比例，最长轴为1
+    const VolumeData* volume = GetActiveVolume();
+    if (brickCache) {
+        return VolumeGeometry::GetBoxExtent(glm::vec3(brickCache->GetWidth(), brickCache->GetHeight(),
+                                                      brickCache->GetDepth()), glm::vec3(1.0f));
+    } else if (volume) {
+        return VolumeGeometry::GetBoxExtent(glm::vec3(volume->GetWidth(), volume->GetHeight(), volume->GetDepth()),
+                                            volume->GetSpacing());
+    }
+    return glm::vec3(1.0f);
+}
+
+bool Renderer::UseProxyBounds() const {
+    return renderParams.enableProxyGeometry && !brickCache && GetActiveChannelCount() == 0 && GetActiveVolume();
 }
 
 void Renderer::CreateFullScreenQuad() {
@@ -182,6 +651,18 @@ void Renderer::CreateTransferFunctionTexture() {
     glTexImage1D(GL_TEXTURE_1D, 0, GL_RGBA, tfSize, 0, GL_RGBA, GL_FLOAT, tfData.data());
     
     glBindTexture(GL_TEXTURE_1D, 0);
+    
+    transferFunctionColors = tfData;
+    
+    // 预积分表（RGBA16F，线性过滤，尺寸随传输函数）
+    glGenTextures(1, &preIntegrationTexture);
+    glBindTexture(GL_TEXTURE_2D, preIntegrationTexture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    UpdatePreIntegrationTable();
 }
 
 void Renderer::UpdateTransferFunctionTexture(const std::vector<glm::vec4>& colors) {
@@ -190,35 +671,193 @@ void Renderer::UpdateTransferFunctionTexture(const std::vector<glm::vec4>& color
     glBindTexture(GL_TEXTURE_1D, transferFunctionTexture);
     glTexImage1D(GL_TEXTURE_1D, 0, GL_RGBA, colors.size(), 0, GL_RGBA, GL_FLOAT, colors.data());
     glBindTexture(GL_TEXTURE_1D, 0);
+    
+    transferFunctionColors = colors;
+    UpdatePreIntegrationTable();
+}
+
+void Renderer::UpdatePreIntegrationTable() {
+    if (preIntegrationTexture == 0 || transferFunctionColors.empty()) return;
+    
+    const int size = (int)transferFunctionColors.size();
+    PreIntegration::BuildTable(transferFunctionColors, renderParams.threshold, preIntegrationData);
+    
+    glBindTexture(GL_TEXTURE_2D, preIntegrationTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, size, size, 0, GL_RGBA, GL_FLOAT, preIntegrationData.data());
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void Renderer::UpdateMacrocellClassification() {
+    VolumeData* volume = GetActiveVolume();
+    if (!volume) return;
+    volume->ClassifyMacrocells(renderParams.threshold, renderParams.density,
+                                   renderParams.windowWidth, renderParams.windowCenter, transferFunctionColors);
+    
+    // 代理几何随分类一起重建
+    if (!proxyGeometry) return;
+    glm::vec3 volumeSize(volume->GetWidth(), volume->GetHeight(), volume->GetDepth());
+    proxyGeometry->Build(volume->GetMacrocellOccupancy(), volume->GetMacrocellGridSize(),
+                         volumeSize / (float)VolumeData::MACROCELL_SIZE);
+}
+
+void Renderer::PresentFrame() {
+    if (presentToScreen) {
+        frameCache->Present(screenWidth, screenHeight);
+    } else {
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+}
+
+void Renderer::BindVolumeTextures() {
+    // 体数据、宏单元占用和原生精度密度纹理
+    VolumeData* volume = GetActiveVolume();
+    if (volume) {
+        volume->Bind(0);
+        volume->BindMacrocells(2);
+        if (volume->HasNativeDensity()) {
+            volume->BindDensity(5);
+        }
+    }
+    
+    // 传输函数、预积分表和代理几何的边界纹理
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_1D, transferFunctionTexture);
+    glActiveTexture(GL_TEXTURE6);
+    glBindTexture(GL_TEXTURE_2D, preIntegrationTexture);
+    proxyGeometry->Bind(13);
+    glActiveTexture(GL_TEXTURE0);
+    
+    // 分块缓存的图集和页表
+    if (brickCache) {
+        brickCache->Bind(3, 4);
+    }
+    
+    // 附加通道的体数据和传输函数
+    if (GetActiveChannelCount() > 0) {
+        volumeChannels->Bind();
+    }
+}
+
+void Renderer::InvalidateFrame() {
+    frameDirty = true;
+    if (temporalAccumulation) {
+        temporalAccumulation->Invalidate();
+    }
+}
+
+void Renderer::SelectRayMarchingVariant() {
+    // 与UpdateUniforms写入RenderBlock的开关一致
+    uint64_t key = 0;
+    int channelCount = GetActiveChannelCount();
+    if (renderParams.enableLighting) key |= FEATURE_LIGHTING;
+    if (renderParams.enableJittering) key |= FEATURE_JITTERING;
+    if (renderParams.enableEmptySpaceSkipping && !brickCache && channelCount == 0) key |= FEATURE_EMPTY_SPACE_SKIPPING;
+    if (renderParams.enablePreIntegration) key |= FEATURE_PRE_INTEGRATION;
+    const VolumeData* volume = GetActiveVolume();
+    if (!brickCache && volume && volume->HasNativeDensity()) key |= FEATURE_NATIVE_DENSITY;
+    if (brickCache) key |= FEATURE_BRICK_CACHE;
+    if (renderParams.enableTemporalAccumulation) key |= FEATURE_OUTPUT_DEPTH;
+    if (UseProxyBounds()) key |= FEATURE_PROXY_BOUNDS;
+    key |= (uint64_t)channelCount << CHANNEL_COUNT_SHIFT;
+    key |= (uint64_t)std::max(renderParams.maxSteps, 0) << 32;
+    
+    if (key != rayMarchingVariant) {
+        rayMarchingVariant = key;
+        rayMarchingShaders->Request(key, RayMarchingDefines(key));
+    }
+    if (computeRayMarcher && renderParams.enableComputeRayMarching && key != computeVariant) {
+        computeVariant = key;
+        computeRayMarcher->Request(key, RayMarchingDefines(key));
+    }
 }
 
-void Renderer::UpdateUniforms() {
-    // 设置纹理单元
-    rayMarchingShader->SetInt("volumeTexture", 0);
-    rayMarchingShader->SetInt("transferFunction", 1);
+void Renderer::UpdateUniforms(bool batched) {
+    // 渲染参数和由体数据推导出的状态写入RenderBlock
+    RenderUniforms uniforms = {};
+    uniforms.stepSize = renderParams.stepSize;
+    uniforms.density = renderParams.density;
+    uniforms.threshold = renderParams.threshold;
+    uniforms.enableLighting = renderParams.enableLighting;
+    uniforms.absorptionCoeff = renderParams.absorptionCoeff;
+    uniforms.scatteringCoeff = renderParams.scatteringCoeff;
+    uniforms.lightDir = glm::normalize(renderParams.lightDir);
+    uniforms.maxSteps = renderParams.maxSteps;
+    uniforms.enableJittering = renderParams.enableJittering;
+    // 时间累积：抖动偏移按帧序列分层，并输出代表深度供重投影
+    bool temporal = renderParams.enableTemporalAccumulation && !batched;
+    uniforms.jitterSequence = temporal ? temporalAccumulation->GetJitterOffset() : -1.0f;
+    uniforms.outputDepth = temporal;
+    uniforms.usePreIntegration = renderParams.enablePreIntegration;
+    
+    // 分块模式没有宏单元网格，由页表中的空块标志完成跳跃；宏单元只描述主体数据，有附加通道时不能跳过
+    int channelCount = GetActiveChannelCount();
+    uniforms.enableEmptySpaceSkipping = renderParams.enableEmptySpaceSkipping && !brickCache && channelCount == 0;
+    uniforms.useBrickCache = brickCache != nullptr;
+    // 边界纹理按主视图的摄像机绘制，批量多视图不使用
+    uniforms.useProxyBounds = UseProxyBounds() && !batched;
+    uniforms.proxyBoundsScale = proxyGeometry->GetBoundsScale();
+    
+    const VolumeData* volume = GetActiveVolume();
+    glm::vec3 volumeSize(1.0f);
+    if (brickCache) {
+        volumeSize = glm::vec3(brickCache->GetWidth(), brickCache->GetHeight(), brickCache->GetDepth());
+        uniforms.brickGridSize = glm::vec3(brickCache->GetBrickGridSize());
+        uniforms.atlasSize = brickCache->GetAtlasSize();
+    } else if (volume) {
+        volumeSize = glm::vec3(volume->GetWidth(), volume->GetHeight(), volume->GetDepth());
+        
+        // 原生精度密度的采样值映射到与打包纹理a通道相同的归一化值域
+        uniforms.useNativeDensity = volume->HasNativeDensity();
+        glm::vec2 nativeMapping = volume->GetNativeDensityMapping();
+        uniforms.nativeDensityScale = nativeMapping.x;
+        uniforms.nativeDensityOffset = nativeMapping.y;
+        
+        // 宏单元网格覆盖的纹理坐标比例（体素数不是单元边长整数倍时网格略大于体积）
+        uniforms.macrocellGridScale = volumeSize / (float)VolumeData::MACROCELL_SIZE;
+    }
+    uniforms.volumeSize = volumeSize;
+    
+    // 窗宽/窗位：归一化原始值 v -> clamp((v - center) / width + 0.5)
+    glm::vec2 windowMapping = VolumeGeometry::GetWindowMapping(renderParams.windowWidth, renderParams.windowCenter);
+    uniforms.windowScale = windowMapping.x;
+    uniforms.windowOffset = windowMapping.y;
+    
+    glm::vec3 boxExtent = GetBoxExtent();
+    uniforms.boxMin = -0.5f * boxExtent;
+    uniforms.boxMax = 0.5f * boxExtent;
     
-    // 设置渲染参数
-    rayMarchingShader->SetFloat("stepSize", renderParams.stepSize);
-    rayMarchingShader->SetFloat("density", renderParams.density);
-    rayMarchingShader->SetFloat("threshold", renderParams.threshold);
-    rayMarchingShader->SetBool("enableLighting", renderParams.enableLighting);
-    rayMarchingShader->SetFloat("absorptionCoeff", renderParams.absorptionCoeff);
-    rayMarchingShader->SetFloat("scatteringCoeff", renderParams.scatteringCoeff);
-    rayMarchingShader->SetVec3("lightDir", glm::normalize(renderParams.lightDir));
-    rayMarchingShader->SetInt("maxSteps", renderParams.maxSteps);
-    rayMarchingShader->SetBool("enableJittering", renderParams.enableJittering);
+    // 体素空间梯度 -> 包围盒空间梯度的各轴缩放（与CpuRenderer共用）
+    uniforms.gradientScale = VolumeGeometry::GetGradientScale(volumeSize, boxExtent);
     
-    // 设置摄像机矩阵
+    // LOD：单位距离处一个像素覆盖的体素数（按最细的轴计算）
+    // 分块图集没有mip层级，分块模式下固定使用原始分辨率
+    glm::vec3 voxelsPerUnit = volumeSize / boxExtent;
+    float maxSize = std::max(std::max(voxelsPerUnit.x, voxelsPerUnit.y), voxelsPerUnit.z);
     const Camera& cam = cameraController->GetCamera();
-    glm::mat4 view = cameraController->GetViewMatrix();
-    glm::mat4 projection = cameraController->GetProjectionMatrix();
-    glm::mat4 invView = glm::inverse(view);
-    glm::mat4 invProjection = glm::inverse(projection);
+    int lodLevels = (volume && !brickCache && renderParams.enableLod) ? volume->GetLodLevelCount() : 1;
+    // 动态分辨率下一个像素覆盖更大的角度
+    int viewHeight = renderParams.enableDynamicResolution
+        ? dynamicResolution->GetRenderSize(screenWidth, screenHeight).y : screenHeight;
+    float pixelAngle = 2.0f * std::tan(glm::radians(cam.fov) * 0.5f) / (float)viewHeight;
+    // 批量多视图时各视图的像素张角不同，这里只写入每单位长度的体素数，由视图块中的张角相乘
+    uniforms.lodScale = batched ? maxSize : pixelAngle * maxSize;
+    uniforms.lodBias = renderParams.lodBias + (batched ? 0.0f : motionLod);
+    uniforms.maxLod = (float)(lodLevels - 1);
     
-    rayMarchingShader->SetMat4("invView", invView);
-    rayMarchingShader->SetMat4("invProjection", invProjection);
-    rayMarchingShader->SetVec3("cameraPos", cam.position);
+    renderUniformBuffer.Update(&uniforms, RENDER_BLOCK_BINDING);
+    
+    // 附加通道的变换与参数写入ChannelBlock
+    ChannelUniforms channelUniforms = {};
+    if (channelCount > 0) {
+        volumeChannels->FillUniforms(channelUniforms);
+    }
+    channelUniformBuffer.Update(&channelUniforms, CHANNEL_BLOCK_BINDING);
     
-    // 设置时间（用于抖动采样）
-    rayMarchingShader->SetFloat("time", (float)glfwGetTime());
+    // 摄像机写入CameraBlock（逆矩阵解析求得）；时间用于逐帧随机抖动
+    CameraUniforms cameraUniforms;
+    cameraUniforms.invView = cameraController->GetInverseViewMatrix();
+    cameraUniforms.invProjection = cameraController->GetInverseProjectionMatrix();
+    cameraUniforms.cameraPos = cam.position;
+    cameraUniforms.time = (float)GetTimeSeconds();
+    cameraUniformBuffer.Update(&cameraUniforms, CAMERA_BLOCK_BINDING);
 }
@@ -0,0 +1,201 @@
+#include "SequenceRenderer.h"
+#include "FramePattern.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+SequenceRenderer::SequenceRenderer(Renderer& renderer, ThreadPool& pool)
+    : renderer(renderer), pool(pool), pbos{}, fences{}, slotFrames{}, width(0), height(0),
+      encodesInFlight(0), encodeFailed(false) {
+}
+
+SequenceRenderer::~SequenceRenderer() {
+    WaitForEncodes(0);
+    ReleaseBuffers();
+}
+
+bool SequenceRenderer::Render(const CameraPath& path, RenderParams params, const SequenceSettings& settings,
+                              const std::function<void(int, int)>& progress) {
+    ImageWriter::Format format;
+    std::string testName;
+    if (!FramePattern::Format(settings.outputPattern, 0, testName) ||
+        !ImageWriter::FormatFromFilename(settings.outputPattern, format)) {
+        std::cerr << "Invalid output pattern (expected e.g. frame_%05d.png or frame_%d.ppm): "
+                  << settings.outputPattern << std::endl;
+        return false;
+    }
+    if (path.IsEmpty() || settings.width <= 0 || settings.height <= 0) {
+        std::cerr << "Sequence needs at least one keyframe and a positive resolution" << std::endl;
+        return false;
+    }
+    GLint maxSize = 0;
+    glGetIntegerv(GL_MAX_RENDERBUFFER_SIZE, &maxSize);
+    if (settings.width > maxSize || settings.height > maxSize) {
+        std::cerr << "Sequence resolution " << settings.width << "x" << settings.height
+                  << " exceeds GL_MAX_RENDERBUFFER_SIZE (" << maxSize << ")" << std::endl;
+        return false;
+    }
+    
+    CreateBuffers(settings.width, settings.height);
+    encodeFailed = false;
+    
+    // 渲染到离屏缓存帧，结束后恢复
+    int previousWidth = renderer.GetWidth();
+    int previousHeight = renderer.GetHeight();
+    Camera previousCamera = renderer.GetCameraController().GetCamera();
+    renderer.SetPresentToScreen(false);
+    renderer.Resize(width, height);
+    params.enableDynamicResolution = false;
+    params.motionLodBias = 0.0f;
+    renderer.SetRenderParams(params);
+    
+    Camera camera = previousCamera;
+    camera.aspectRatio = (float)width / (float)height;
+    
+    auto start = std::chrono::steady_clock::now();
+    int frameCount = path.GetKeyframeCount();
+    int samples = std::max(settings.samplesPerFrame, 1);
+    for (int frame = 0; frame < frameCount; frame++) {
+        // 复用PBO前取回它PBO_COUNT帧之前的读回结果（GPU通常早已完成）
+        int slot = frame % PBO_COUNT;
+        if (fences[slot]) {
+            FinishReadback(slot, settings.outputPattern, format);
+        }
+        
+        // 关键帧之间摄像机跳变，重投影的历史会在输出中留下残影，每个关键帧从空历史开始累积
+        path.Apply(frame, camera);
+        renderer.SetCamera(camera);
+        renderer.InvalidateFrame();
+        for (int s = 0; s < samples; s++) {
+            renderer.RenderFrame();
+        }
+        BeginReadback(slot, frame);
+        
+        if (progress) {
+            progress(frame + 1, frameCount);
+        }
+    }
+    
+    // 按帧顺序取回剩余的读回
+    for (int frame = std::max(frameCount - PBO_COUNT, 0); frame < frameCount; frame++) {
+        int slot = frame % PBO_COUNT;
+        if (fences[slot]) {
+            FinishReadback(slot, settings.outputPattern, format);
+        }
+    }
+    WaitForEncodes(0);
+    
+    renderer.SetPresentToScreen(true);
+    renderer.Resize(previousWidth, previousHeight);
+    renderer.SetCamera(previousCamera);
+    
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Rendered " << frameCount << " frames (" << width << "x" << height << ") in " << seconds << " s ("
+              << frameCount / std::max(seconds, 1e-6) << " FPS)" << std::endl;
+    return !encodeFailed;
+}
+
+void SequenceRenderer::CreateBuffers(int w, int h) {
+    if (w == width && h == height && pbos[0] != 0) return;
+    ReleaseBuffers();
+    width = w;
+    height = h;
+    
+    glGenBuffers(PBO_COUNT, pbos);
+    for (int i = 0; i < PBO_COUNT; i++) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[i]);
+        glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr)w * h * 4, nullptr, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+void SequenceRenderer::ReleaseBuffers() {
+    for (int i = 0; i < PBO_COUNT; i++) {
+        if (fences[i]) {
+            glDeleteSync(fences[i]);
+            fences[i] = nullptr;
+        }
+    }
+    if (pbos[0] != 0) {
+        glDeleteBuffers(PBO_COUNT, pbos);
+        std::fill(pbos, pbos + PBO_COUNT, 0u);
+    }
+}
+
+void SequenceRenderer::BeginReadback(int slot, int frame) {
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, renderer.GetOutputFramebuffer());
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[slot]);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+    
+    fences[slot] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slotFrames[slot] = frame;
+    // 确保栅栏命令已提交，之后的等待不会因命令滞留在驱动中而卡住
+    glFlush();
+}
+
+void SequenceRenderer::FinishReadback(int slot, const std::string& pattern, ImageWriter::Format format) {
+    GLenum status;
+    do {
+        status = glClientWaitSync(fences[slot], GL_SYNC_FLUSH_COMMANDS_BIT, 100000000);   // 100ms
+    } while (status == GL_TIMEOUT_EXPIRED);
+    glDeleteSync(fences[slot]);
+    fences[slot] = nullptr;
+    
+    size_t byteCount = (size_t)width * height * 4;
+    auto rgba = std::make_shared<std::vector<unsigned char>>(byteCount);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[slot]);
+    const void* mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, (GLsizeiptr)byteCount, GL_MAP_READ_BIT);
+    if (mapped) {
+        std::memcpy(rgba->data(), mapped, byteCount);
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    if (!mapped || status == GL_WAIT_FAILED) {
+        std::cerr << "Failed to read back frame " << slotFrames[slot] << std::endl;
+        encodeFailed = true;
+        return;
+    }
+    
+    std::string filename;
+    FramePattern::Format(pattern, slotFrames[slot], filename);
+    
+    // 限制排队的帧数，编码跟不上时渲染线程在这里等待，内存占用不会无限增长
+    WaitForEncodes(pool.GetThreadCount() * 2);
+    {
+        std::lock_guard<std::mutex> lock(encodeMutex);
+        encodesInFlight++;
+    }
+    int w = width, h = height;
+    pool.Submit([this, rgba, filename, format, w, h]() {
+        // GL的行顺序为从下到上，翻转并去掉alpha
+        std::vector<unsigned char> rgb((size_t)w * h * 3);
+        for (int y = 0; y < h; y++) {
+            const unsigned char* src = rgba->data() + (size_t)(h - 1 - y) * w * 4;
+            unsigned char* dst = rgb.data() + (size_t)y * w * 3;
+            for (int x = 0; x < w; x++) {
+                dst[x * 3 + 0] = src[x * 4 + 0];
+                dst[x * 3 + 1] = src[x * 4 + 1];
+                dst[x * 3 + 2] = src[x * 4 + 2];
+            }
+        }
+        if (!ImageWriter::Write(filename, format, w, h, rgb.data())) {
+            encodeFailed = true;
+        }
+        
+        std::lock_guard<std::mutex> lock(encodeMutex);
+        encodesInFlight--;
+        encodeCondition.notify_all();
+    });
+}
+
+void SequenceRenderer::WaitForEncodes(int maxInFlight) {
+    std::unique_lock<std::mutex> lock(encodeMutex);
+    encodeCondition.wait(lock, [this, maxInFlight]() { return encodesInFlight <= maxInFlight; });
+}
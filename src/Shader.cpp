@@ -2,89 +2,236 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <initializer_list>
+#include <utility>
 #include <glm/gtc/type_ptr.hpp>
 
-Shader::Shader() : ID(0) {}
+Shader::Shader() : ID(0), pendingVertexShader(0), pendingFragmentShader(0), pendingComputeShader(0) {}
 
 Shader::~Shader() {
+    if (pendingVertexShader != 0) {
+        glDeleteShader(pendingVertexShader);
+    }
+    if (pendingFragmentShader != 0) {
+        glDeleteShader(pendingFragmentShader);
+    }
+    if (pendingComputeShader != 0) {
+        glDeleteShader(pendingComputeShader);
+    }
     if (ID != 0) {
         glDeleteProgram(ID);
     }
 }
 
-bool Shader::LoadFromFile(const std::string& vertexPath, const std::string& fragmentPath) {
-    // 读取顶点着色器文件
-    std::ifstream vShaderFile(vertexPath);
-    if (!vShaderFile.is_open()) {
-        std::cerr << "Failed to open vertex shader file: " << vertexPath << std::endl;
-        return false;
+namespace {
+    // GL_KHR_parallel_shader_compile的枚举值（glad头文件中未包含该扩展）
+    const GLenum COMPLETION_STATUS_KHR = 0x91B1;
+    
+    bool ReadFile(const std::string& path, const char* kind, std::string& content) {
+        std::ifstream file(path);
+        if (!file.is_open()) {
+            std::cerr << "Failed to open " << kind << " shader file: " << path << std::endl;
+            return false;
+        }
+        std::stringstream stream;
+        stream << file.rdbuf();
+        content = stream.str();
+        return true;
+    }
+    
+    // 把defines插入到#version行之后，并用#line恢复原文件的行号（编译错误信息中的行号不变）
+    std::string InjectDefines(const std::string& source, const std::string& defines) {
+        if (defines.empty()) return source;
+        size_t version = source.find("#version");
+        size_t lineEnd = version == std::string::npos ? std::string::npos : source.find('\n', version);
+        if (lineEnd == std::string::npos) {
+            return defines + "\n" + source;
+        }
+        int versionLine = 1 + (int)std::count(source.begin(), source.begin() + lineEnd, '\n');
+        return source.substr(0, lineEnd + 1) + defines + "\n#line " + std::to_string(versionLine + 1) + "\n" +
+               source.substr(lineEnd + 1);
     }
-    std::stringstream vShaderStream;
-    vShaderStream << vShaderFile.rdbuf();
-    std::string vertexCode = vShaderStream.str();
-    vShaderFile.close();
     
-    // 读取片段着色器文件
-    std::ifstream fShaderFile(fragmentPath);
-    if (!fShaderFile.is_open()) {
-        std::cerr << "Failed to open fragment shader file: " << fragmentPath << std::endl;
+    // 把#version行替换为给定版本（不改变行数）
+    std::string ReplaceVersion(const std::string& source, const std::string& version) {
+        size_t start = source.find("#version");
+        if (start == std::string::npos) {
+            return version + "\n" + source;
+        }
+        size_t lineEnd = source.find('\n', start);
+        return source.substr(0, start) + version + (lineEnd == std::string::npos ? "" : source.substr(lineEnd));
+    }
+}
+
+bool Shader::LoadFromFile(const std::string& vertexPath, const std::string& fragmentPath, const std::string& defines) {
+    if (!BeginLoadFromFile(vertexPath, fragmentPath, defines)) {
+        return false;
+    }
+    return FinishLoad();
+}
+
+bool Shader::BeginLoadFromFile(const std::string& vertexPath, const std::string& fragmentPath,
+                               const std::string& defines) {
+    // 读取顶点/片段着色器文件
+    std::string vertexCode, fragmentCode;
+    if (!ReadFile(vertexPath, "vertex", vertexCode) || !ReadFile(fragmentPath, "fragment", fragmentCode)) {
         return false;
     }
-    std::stringstream fShaderStream;
-    fShaderStream << fShaderFile.rdbuf();
-    std::string fragmentCode = fShaderStream.str();
-    fShaderFile.close();
     
-    // 编译着色器
-    GLuint vertexShader, fragmentShader;
-    if (!CompileShader(vertexCode, GL_VERTEX_SHADER, vertexShader)) {
+    // 提交编译和链接命令；结果在FinishLoad中查询，期间驱动可以在后台线程编译
+    pendingVertexShader = CompileShader(InjectDefines(vertexCode, defines), GL_VERTEX_SHADER);
+    pendingFragmentShader = CompileShader(InjectDefines(fragmentCode, defines), GL_FRAGMENT_SHADER);
+    LinkProgram(pendingVertexShader, pendingFragmentShader);
+    return true;
+}
+
+bool Shader::LoadComputeFromFile(const std::string& computePath, const std::string& defines) {
+    if (!BeginLoadComputeFromFile(computePath, defines)) {
         return false;
     }
-    if (!CompileShader(fragmentCode, GL_FRAGMENT_SHADER, fragmentShader)) {
-        glDeleteShader(vertexShader);
+    return FinishLoad();
+}
+
+bool Shader::BeginLoadComputeFromFile(const std::string& computePath, const std::string& defines) {
+    std::string computeCode;
+    if (!ReadFile(computePath, "compute", computeCode)) {
         return false;
     }
     
-    // 链接程序
-    bool success = LinkProgram(vertexShader, fragmentShader);
+    pendingComputeShader = CompileShader(InjectDefines(ReplaceVersion(computeCode, "#version 430 core"), defines),
+                                         GL_COMPUTE_SHADER);
+    LinkProgram(0, 0, pendingComputeShader);
+    return true;
+}
+
+bool Shader::IsLinkComplete() const {
+    if (ID == 0 || !SupportsParallelCompile()) return true;
+    GLint complete = GL_TRUE;
+    glGetProgramiv(ID, COMPLETION_STATUS_KHR, &complete);
+    return complete == GL_TRUE;
+}
+
+bool Shader::FinishLoad() {
+    bool success = true;
+    
+    // 检查编译错误（链接失败时编译日志更有用）
+    const std::pair<GLuint, const char*> stages[] = {
+        { pendingVertexShader, "VERTEX" },
+        { pendingFragmentShader, "FRAGMENT" },
+        { pendingComputeShader, "COMPUTE" }
+    };
+    GLint status = GL_FALSE;
+    for (const auto& stage : stages) {
+        if (stage.first == 0) continue;
+        glGetShaderiv(stage.first, GL_COMPILE_STATUS, &status);
+        if (!status) {
+            CheckCompileErrors(stage.first, stage.second);
+            success = false;
+        }
+    }
+    
+    // 检查链接错误
+    if (success) {
+        glGetProgramiv(ID, GL_LINK_STATUS, &status);
+        if (!status) {
+            CheckCompileErrors(ID, "PROGRAM");
+            success = false;
+        }
+    }
     
     // 删除着色器（已经链接到程序中）
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
+    for (const auto& stage : stages) {
+        if (stage.first != 0) {
+            glDeleteShader(stage.first);
+        }
+    }
+    pendingVertexShader = 0;
+    pendingFragmentShader = 0;
+    pendingComputeShader = 0;
     
+    if (success) {
+        CacheUniformLocations();
+    }
     return success;
 }
 
-bool Shader::CompileShader(const std::string& source, GLenum type, GLuint& shader) {
-    shader = glCreateShader(type);
+bool Shader::SupportsParallelCompile() {
+    static int supported = -1;
+    if (supported < 0) {
+        supported = 0;
+        GLint count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        for (GLint i = 0; i < count; i++) {
+            const char* name = (const char*)glGetStringi(GL_EXTENSIONS, (GLuint)i);
+            if (name && (std::strcmp(name, "GL_KHR_parallel_shader_compile") == 0 ||
+                         std::strcmp(name, "GL_ARB_parallel_shader_compile") == 0)) {
+                supported = 1;
+                break;
+            }
+        }
+    }
+    return supported == 1;
+}
+
+GLuint Shader::CompileShader(const std::string& source, GLenum type) {
+    GLuint shader = glCreateShader(type);
     const char* src = source.c_str();
     glShaderSource(shader, 1, &src, nullptr);
     glCompileShader(shader);
-    
-    // 检查编译错误
-    GLint success;
-    glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
-    if (!success) {
-        CheckCompileErrors(shader, type == GL_VERTEX_SHADER ? "VERTEX" : "FRAGMENT");
-        return false;
-    }
-    return true;
+    return shader;
 }
 
-bool Shader::LinkProgram(GLuint vertexShader, GLuint fragmentShader) {
+void Shader::LinkProgram(GLuint vertexShader, GLuint fragmentShader, GLuint computeShader) {
     ID = glCreateProgram();
-    glAttachShader(ID, vertexShader);
-    glAttachShader(ID, fragmentShader);
+    for (GLuint shader : { vertexShader, fragmentShader, computeShader }) {
+        if (shader != 0) {
+            glAttachShader(ID, shader);
+        }
+    }
     glLinkProgram(ID);
+}
+
+void Shader::CacheUniformLocations() {
+    uniformLocations.clear();
     
-    // 检查链接错误
-    GLint success;
-    glGetProgramiv(ID, GL_LINK_STATUS, &success);
-    if (!success) {
-        CheckCompileErrors(ID, "PROGRAM");
-        return false;
+    GLint count = 0;
+    GLint maxLength = 0;
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+    std::string name(std::max(maxLength, 1), '\0');
+    
+    for (GLint i = 0; i < count; i++) {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(ID, (GLuint)i, (GLsizei)name.size(), &length, &size, &type, &name[0]);
+        std::string uniformName(name.data(), length);
+        
+        // uniform块中的成员没有位置，通过uniform缓冲更新
+        GLint location = glGetUniformLocation(ID, uniformName.c_str());
+        if (location < 0) continue;
+        uniformLocations[uniformName] = location;
+        
+        // 数组uniform报告为"name[0]"
+        size_t bracket = uniformName.find('[');
+        if (bracket != std::string::npos) {
+            uniformLocations[uniformName.substr(0, bracket)] = location;
+        }
+    }
+}
+
+GLint Shader::GetUniformLocation(const std::string& name) const {
+    auto it = uniformLocations.find(name);
+    return it != uniformLocations.end() ? it->second : -1;
+}
+
+void Shader::BindUniformBlock(const std::string& blockName, GLuint binding) const {
+    GLuint index = glGetUniformBlockIndex(ID, blockName.c_str());
+    if (index != GL_INVALID_INDEX) {
+        glUniformBlockBinding(ID, index, binding);
     }
-    return true;
 }
 
 void Shader::CheckCompileErrors(GLuint shader, const std::string& type) {
@@ -112,25 +259,29 @@ void Shader::Use() const {
 }
 
 void Shader::SetBool(const std::string& name, bool value) const {
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+    glUniform1i(GetUniformLocation(name), (int)value);
 }
 
 void Shader::SetInt(const std::string& name, int value) const {
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+    glUniform1i(GetUniformLocation(name), value);
 }
 
 void Shader::SetFloat(const std::string& name, float value) const {
-    glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+    glUniform1f(GetUniformLocation(name), value);
+}
+
+void Shader::SetVec2(const std::string& name, const glm::vec2& value) const {
+    glUniform2fv(GetUniformLocation(name), 1, glm::value_ptr(value));
 }
 
 void Shader::SetVec3(const std::string& name, const glm::vec3& value) const {
-    glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, glm::value_ptr(value));
+    glUniform3fv(GetUniformLocation(name), 1, glm::value_ptr(value));
 }
 
 void Shader::SetVec4(const std::string& name, const glm::vec4& value) const {
-    glUniform4fv(glGetUniformLocation(ID, name.c_str()), 1, glm::value_ptr(value));
+    glUniform4fv(GetUniformLocation(name), 1, glm::value_ptr(value));
 }
 
 void Shader::SetMat4(const std::string& name, const glm::mat4& mat) const {
-    glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, glm::value_ptr(mat));
+    glUniformMatrix4fv(GetUniformLocation(name), 1, GL_FALSE, glm::value_ptr(mat));
 }
@@ -0,0 +1,106 @@
+#include "ShaderCache.h"
+#include <iostream>
+
+ShaderCache::ShaderCache(const std::string& vertexPath, const std::string& fragmentPath, SetupFunction setup)
+    : vertexPath(vertexPath), fragmentPath(fragmentPath), compute(false), setup(std::move(setup)), frameIndex(0),
+      buildingKey(0), hasQueued(false), queuedKey(0) {
+}
+
+std::unique_ptr<ShaderCache> ShaderCache::CreateCompute(const std::string& computePath, const std::string& baseDefines,
+                                                        SetupFunction setup) {
+    std::unique_ptr<ShaderCache> cache(new ShaderCache("", computePath, std::move(setup)));
+    cache->compute = true;
+    cache->baseDefines = baseDefines;
+    return cache;
+}
+
+bool ShaderCache::Initialize() {
+    generic = std::make_unique<Shader>();
+    if (!BeginLoad(*generic, "") || !generic->FinishLoad()) {
+        return false;
+    }
+    setup(*generic);
+    
+    if (!Shader::SupportsParallelCompile()) {
+        std::cout << "Parallel shader compile not supported, shader variants disabled for " << fragmentPath << std::endl;
+    }
+    return true;
+}
+
+void ShaderCache::Request(uint64_t key, const std::string& defines) {
+    // 没有并行编译扩展时不编译变体：结果查询会阻塞渲染线程，通用程序不需要等待
+    if (!Shader::SupportsParallelCompile()) return;
+    if (variants.count(key) || failedKeys.count(key)) return;
+    if (building && buildingKey == key) return;
+    
+    if (building) {
+        hasQueued = true;
+        queuedKey = key;
+        queuedDefines = defines;
+    } else {
+        StartBuild(key, defines);
+    }
+}
+
+Shader& ShaderCache::Get(uint64_t key) {
+    auto it = variants.find(key);
+    if (it == variants.end()) {
+        return *generic;
+    }
+    it->second.lastUsedFrame = frameIndex;
+    return *it->second.shader;
+}
+
+void ShaderCache::Update() {
+    frameIndex++;
+    if (!building) return;
+    
+    // 编译完成前不查询结果（FinishLoad中的状态查询会等待编译）；只有支持并行编译扩展时才会有正在编译的变体
+    if (!building->IsLinkComplete()) return;
+    
+    if (building->FinishLoad()) {
+        setup(*building);
+        if ((int)variants.size() >= MAX_VARIANTS) {
+            EvictLeastRecentlyUsed();
+        }
+        variants[buildingKey] = Variant{ std::move(building), frameIndex };
+    } else {
+        std::cerr << "Failed to compile shader variant " << std::hex << buildingKey << std::dec
+                  << ", keeping generic program" << std::endl;
+        failedKeys.insert(buildingKey);
+    }
+    building.reset();
+    
+    if (hasQueued) {
+        hasQueued = false;
+        Request(queuedKey, queuedDefines);
+    }
+}
+
+void ShaderCache::StartBuild(uint64_t key, const std::string& defines) {
+    building = std::make_unique<Shader>();
+    buildingKey = key;
+    if (!BeginLoad(*building, defines)) {
+        failedKeys.insert(key);
+        building.reset();
+    }
+}
+
+bool ShaderCache::BeginLoad(Shader& shader, const std::string& defines) const {
+    if (compute) {
+        return shader.BeginLoadComputeFromFile(fragmentPath, baseDefines + defines);
+    }
+    return shader.BeginLoadFromFile(vertexPath, fragmentPath, baseDefines + defines);
+}
+
+void ShaderCache::EvictLeastRecentlyUsed() {
+    auto oldest = variants.end();
+    for (auto it = variants.begin(); it != variants.end(); ++it) {
+        if (oldest == variants.end() || it->second.lastUsedFrame < oldest->second.lastUsedFrame) {
+            oldest = it;
+        }
+    }
+    if (oldest != variants.end()) {
+        variants.erase(oldest);
+    }
+}
@@ -0,0 +1,125 @@
+#include "TemporalAccumulation.h"
+#include "UniformBlocks.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+TemporalAccumulation::TemporalAccumulation()
+    : historyTextures{0, 0}, framebuffers{0, 0}, historyIndex(0), targetWidth(0), targetHeight(0),
+      historySize(0), previousViewProjection(1.0f), historyValid(false), sampleCount(0), frameIndex(0) {
+}
+
+TemporalAccumulation::~TemporalAccumulation() {
+    Release();
+}
+
+bool TemporalAccumulation::Initialize() {
+    resolveShader = std::make_unique<Shader>();
+    if (!resolveShader->LoadFromFile("shaders/raymarching.vert", "shaders/temporal.frag")) {
+        std::cerr << "Failed to load temporal accumulation shader" << std::endl;
+        return false;
+    }
+    resolveShader->BindUniformBlock("CameraBlock", CAMERA_BLOCK_BINDING);
+    return true;
+}
+
+float TemporalAccumulation::GetJitterOffset() const {
+    // 黄金分割比的小数部分：任意连续N帧的偏移都近似均匀地覆盖[0, 1)
+    const double GOLDEN_RATIO_FRACTION = 0.6180339887498949;
+    double offset = frameIndex * GOLDEN_RATIO_FRACTION;
+    return (float)(offset - std::floor(offset));
+}
+
+GLuint TemporalAccumulation::Resolve(GLuint currentTexture, glm::ivec2 renderSize, int screenWidth, int screenHeight,
+                                     const glm::mat4& view, const glm::mat4& projection, bool sceneStable,
+                                     int maxSamples) {
+    if (screenWidth != targetWidth || screenHeight != targetHeight) {
+        CreateTargets(screenWidth, screenHeight);
+    }
+    
+    glm::mat4 viewProjection = projection * view;
+    bool still = historyValid && sceneStable && viewProjection == previousViewProjection;
+    maxSamples = std::max(maxSamples, 1);
+    if (!historyValid) {
+        sampleCount = 1;
+    } else {
+        int limit = still ? maxSamples : std::min(maxSamples, (int)std::lround(1.0f / MOVING_BLEND));
+        sampleCount = std::min(sampleCount + 1, limit);
+    }
+    
+    int readIndex = historyIndex;
+    int writeIndex = 1 - historyIndex;
+    
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffers[writeIndex]);
+    glViewport(0, 0, renderSize.x, renderSize.y);
+    
+    resolveShader->Use();
+    resolveShader->SetInt("currentFrame", 0);
+    resolveShader->SetInt("historyFrame", 1);
+    resolveShader->SetVec2("renderSize", glm::vec2(renderSize));
+    resolveShader->SetVec2("historyUvScale", glm::vec2(historySize) / glm::vec2((float)targetWidth, (float)targetHeight));
+    resolveShader->SetVec2("historyTexelSize", glm::vec2(1.0f / targetWidth, 1.0f / targetHeight));
+    resolveShader->SetBool("historyValid", historyValid);
+    resolveShader->SetBool("cameraStill", still);
+    resolveShader->SetFloat("maxSamples", (float)maxSamples);
+    resolveShader->SetFloat("movingBlend", MOVING_BLEND);
+    resolveShader->SetMat4("previousViewProjection", previousViewProjection);
+    
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, currentTexture);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D, historyTextures[readIndex]);
+    glDrawArrays(GL_TRIANGLES, 0, 6);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    
+    historyIndex = writeIndex;
+    historySize = renderSize;
+    previousViewProjection = viewProjection;
+    historyValid = true;
+    frameIndex++;
+    return historyTextures[writeIndex];
+}
+
+void TemporalAccumulation::CreateTargets(int width, int height) {
+    targetWidth = width;
+    targetHeight = height;
+    historyValid = false;
+    
+    if (historyTextures[0] == 0) {
+        glGenTextures(2, historyTextures);
+        glGenFramebuffers(2, framebuffers);
+    }
+    
+    for (int i = 0; i < 2; i++) {
+        // 重投影后的历史坐标不在纹素中心，需要双线性过滤
+        glBindTexture(GL_TEXTURE_2D, historyTextures[i]);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA16F, width, height, 0, GL_RGBA, GL_FLOAT, nullptr);
+        
+        glBindFramebuffer(GL_FRAMEBUFFER, framebuffers[i]);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, historyTextures[i], 0);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            std::cerr << "Temporal accumulation framebuffer is incomplete" << std::endl;
+        }
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void TemporalAccumulation::Release() {
+    if (framebuffers[0] != 0) {
+        glDeleteFramebuffers(2, framebuffers);
+        framebuffers[0] = framebuffers[1] = 0;
+    }
+    if (historyTextures[0] != 0) {
+        glDeleteTextures(2, historyTextures);
+        historyTextures[0] = historyTextures[1] = 0;
+    }
+}
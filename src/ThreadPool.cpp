@@ -0,0 +1,131 @@
+#include "ThreadPool.h"
+#include <chrono>
+
+namespace {
+    // 当前线程所属的工作队列索引（非工作线程为-1）
+    thread_local int currentWorkerIndex = -1;
+}
+
+ThreadPool::ThreadPool(int threadCount)
+    : pendingTasks(0), nextQueue(0), stopping(false) {
+    if (threadCount <= 0) {
+        threadCount = (int)std::thread::hardware_concurrency();
+        if (threadCount <= 0) threadCount = 4;
+    }
+    
+    for (int i = 0; i < threadCount; i++) {
+        queues.push_back(std::make_unique<WorkQueue>());
+    }
+    for (int i = 0; i < threadCount; i++) {
+        threads.emplace_back(&ThreadPool::WorkerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        stopping = true;
+    }
+    wakeCondition.notify_all();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+ThreadPool& ThreadPool::Shared() {
+    static ThreadPool pool;
+    return pool;
+}
+
+void ThreadPool::Submit(std::function<void()> task) {
+    // 工作线程提交的任务放入自己的队列以保持局部性，其余线程轮流分配
+    int index = currentWorkerIndex;
+    if (index < 0) {
+        index = (int)(nextQueue++ % queues.size());
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(queues[index]->mutex);
+        queues[index]->tasks.push_front(std::move(task));
+    }
+    pendingTasks++;
+    
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+    }
+    wakeCondition.notify_one();
+}
+
+void ThreadPool::ParallelFor(int begin, int end, const std::function<void(int)>& body) {
+    if (end <= begin) return;
+    
+    struct Batch {
+        std::atomic<int> remaining;
+        std::mutex mutex;
+        std::condition_variable done;
+    };
+    auto batch = std::make_shared<Batch>();
+    batch->remaining = end - begin;
+    
+    for (int i = begin; i < end; i++) {
+        Submit([batch, &body, i]() {
+            body(i);
+            if (--batch->remaining == 0) {
+                std::lock_guard<std::mutex> lock(batch->mutex);
+                batch->done.notify_all();
+            }
+        });
+    }
+    
+    // 调用线程参与执行，避免在工作线程内嵌套调用时死锁
+    int queueIndex = currentWorkerIndex >= 0 ? currentWorkerIndex : 0;
+    std::function<void()> task;
+    while (batch->remaining > 0) {
+        if (PopTask(queueIndex, task)) {
+            task();
+            task = nullptr;
+        } else {
+            std::unique_lock<std::mutex> lock(batch->mutex);
+            batch->done.wait_for(lock, std::chrono::milliseconds(1), [&]() { return batch->remaining == 0; });
+        }
+    }
+}
+
+bool ThreadPool::PopTask(int queueIndex, std::function<void()>& task) {
+    const int queueCount = (int)queues.size();
+    for (int i = 0; i < queueCount; i++) {
+        WorkQueue& queue = *queues[(queueIndex + i) % queueCount];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) continue;
+        
+        if (i == 0) {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        } else {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        }
+        pendingTasks--;
+        return true;
+    }
+    return false;
+}
+
+void ThreadPool::WorkerLoop(int index) {
+    currentWorkerIndex = index;
+    std::function<void()> task;
+    
+    while (true) {
+        if (PopTask(index, task)) {
+            task();
+            task = nullptr;
+            continue;
+        }
+        
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        wakeCondition.wait(lock, [this]() { return stopping || pendingTasks > 0; });
+        if (stopping && pendingTasks == 0) {
+            return;
+        }
+    }
+}
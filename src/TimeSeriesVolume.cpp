@@ -0,0 +1,411 @@
+#include "TimeSeriesVolume.h"
+#include "MappedFile.h"
+#include "FramePattern.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+TimeSeriesVolume::TimeSeriesVolume()
+    : firstIndex(0), stepCount(0), width(0), height(0), depth(0), gradientFilter(GradientFilter::CentralDifference),
+      clock(0.0), playing(false), rate(10.0f), loop(true), dropFrames(true), displayedPosition(-1),
+      skippedPosition(-1), displayedEntry(-1), droppedSteps(0), target(0), targetEnd(0), stopRequested(false),
+      nextPbo(0), uploadEntry(-1), uploadSlot(-1), uploadPosition(-1), uploadedSlices(0), slicesPerChunk(1) {
+    for (int i = 0; i < PBO_COUNT; i++) {
+        pbos[i] = 0;
+        fences[i] = nullptr;
+    }
+}
+
+TimeSeriesVolume::~TimeSeriesVolume() {
+    Close();
+}
+
+bool TimeSeriesVolume::Open(const std::string& filePattern, int first, int steps, int w, int h, int d,
+                            GradientFilter filter, uint64_t ramBudgetBytes) {
+    Close();
+    
+    std::string name;
+    if (steps <= 0 || w <= 0 || h <= 0 || d <= 0 || !FramePattern::Format(filePattern, first, name)) {
+        std::cerr << "Invalid time series: " << filePattern << std::endl;
+        return false;
+    }
+    
+    pattern = filePattern;
+    firstIndex = first;
+    width = w;
+    height = h;
+    depth = d;
+    gradientFilter = filter;
+    
+    // 槽位数由内存预算决定（打包体素 + 宏单元网格），与序列长度无关
+    const int B = VolumeData::MACROCELL_SIZE;
+    const uint64_t sliceBytes = (uint64_t)width * height * 4;
+    const uint64_t cellBytes = (uint64_t)((width + B - 1) / B) * ((height + B - 1) / B) * ((depth + B - 1) / B) * 2;
+    const uint64_t slotBytes = sliceBytes * depth + cellBytes;
+    int slotCount = (int)std::min<uint64_t>(ramBudgetBytes / slotBytes, MAX_RING_SLOTS);
+    if (slotCount < MIN_RING_SLOTS) {
+        std::cerr << "Time series RAM budget holds fewer than " << MIN_RING_SLOTS << " steps, using "
+                  << MIN_RING_SLOTS << std::endl;
+        slotCount = MIN_RING_SLOTS;
+    }
+    slotCount = std::max(std::min(slotCount, steps), 1);
+    slots.resize(slotCount);
+    for (Slot& slot : slots) {
+        slot.packed.resize((size_t)(sliceBytes * depth));
+    }
+    
+    // 纹理池：同尺寸的单层纹理只分配一次
+    for (PoolEntry& entry : pool) {
+        entry.volume = std::make_unique<VolumeData>();
+        entry.volume->SetGradientFilter(filter);
+        entry.position = -1;
+        if (!entry.volume->AllocateFrame(width, height, depth)) {
+            Close();
+            return false;
+        }
+    }
+    
+    slicesPerChunk = (int)std::min<uint64_t>(std::max<uint64_t>(1, CHUNK_BYTES / sliceBytes), (uint64_t)depth);
+    glGenBuffers(PBO_COUNT, pbos);
+    for (int i = 0; i < PBO_COUNT; i++) {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbos[i]);
+        glBufferData(GL_PIXEL_UNPACK_BUFFER, (GLsizeiptr)(sliceBytes * slicesPerChunk), nullptr, GL_STREAM_DRAW);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    nextPbo = 0;
+    
+    stepCount = steps;
+    clock = 0.0;
+    displayedPosition = -1;
+    skippedPosition = -1;
+    displayedEntry = -1;
+    droppedSteps = 0;
+    uploadEntry = -1;
+    target = 0;
+    targetEnd = GetWindowEnd(0);
+    stopRequested = false;
+    for (int i = 0; i < IO_THREADS; i++) {
+        workers.emplace_back(&TimeSeriesVolume::WorkerMain, this);
+    }
+    
+    std::cout << "Opened time series: " << pattern << " (" << stepCount << " steps, " << width << "x" << height
+              << "x" << depth << ", " << slotCount << " buffered steps, "
+              << (slotBytes * slotCount) / (1024 * 1024) << " MB)" << std::endl;
+    return true;
+}
+
+void TimeSeriesVolume::Close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopRequested = true;
+    }
+    condition.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+    
+    ReleaseGLResources();
+    for (PoolEntry& entry : pool) {
+        entry.volume.reset();
+        entry.position = -1;
+    }
+    slots.clear();
+    slots.shrink_to_fit();
+    stepCount = 0;
+    displayedEntry = -1;
+    uploadEntry = -1;
+    playing = false;
+}
+
+int64_t TimeSeriesVolume::GetWindowEnd(int64_t start) const {
+    int64_t end = start + (int64_t)slots.size();
+    return loop ? end : std::min<int64_t>(end, stepCount);
+}
+
+void TimeSeriesVolume::Seek(int step) {
+    if (!IsOpen()) return;
+    step = std::max(0, std::min(step, stepCount - 1));
+    clock = (double)step;
+    
+    // 当前帧保持显示，直到该步上传完成（比它更早的位置不再显示）
+    displayedPosition = step - 1;
+    skippedPosition = step - 1;
+}
+
+int TimeSeriesVolume::GetCurrentStep() const {
+    return displayedEntry >= 0 ? PositionToStep(pool[displayedEntry].position) : -1;
+}
+
+int TimeSeriesVolume::GetTargetStep() const {
+    return IsOpen() ? PositionToStep(GetTargetPosition()) : -1;
+}
+
+VolumeData* TimeSeriesVolume::GetCurrentFrame() const {
+    return displayedEntry >= 0 ? pool[displayedEntry].volume.get() : nullptr;
+}
+
+int TimeSeriesVolume::GetBufferedSteps() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    int count = 0;
+    for (int64_t p = target; p < targetEnd; p++) {
+        const Slot& slot = slots[p % slots.size()];
+        if (slot.position != p || (slot.state != SlotState::Ready && slot.state != SlotState::Uploading)) break;
+        count++;
+    }
+    return count;
+}
+
+bool TimeSeriesVolume::IsBusy() const {
+    if (!IsOpen()) return false;
+    return playing || uploadEntry >= 0 || std::max(displayedPosition, skippedPosition) < GetTargetPosition();
+}
+
+bool TimeSeriesVolume::Update(float deltaTime, int chunksPerFrame) {
+    if (!IsOpen()) return false;
+    
+    // 推进播放时钟：不丢帧时最多领先显示（或越过的失败步）一步；不循环时停在最后一步
+    if (playing) {
+        clock += (double)deltaTime * rate;
+        if (!dropFrames) {
+            clock = std::min(clock, (double)(std::max(displayedPosition, skippedPosition) + 1));
+        }
+        if (!loop && clock >= (double)(stepCount - 1)) {
+            clock = (double)(stepCount - 1);
+            playing = false;
+        }
+    }
+    
+    // 预取窗口随播放位置移动
+    int64_t position = GetTargetPosition();
+    int64_t windowEnd = GetWindowEnd(position);
+    bool moved = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (position != target || windowEnd != targetEnd) {
+            target = position;
+            targetEnd = windowEnd;
+            moved = true;
+        }
+    }
+    if (moved) {
+        condition.notify_all();
+    }
+    
+    // 上传中的位置已不会再显示（跳转后已过时或不在窗口内）时放弃
+    if (uploadEntry >= 0 && (uploadPosition <= displayedPosition || uploadPosition >= windowEnd)) {
+        CancelUpload();
+    }
+    if (uploadEntry < 0) {
+        StartUpload(windowEnd);
+    }
+    if (uploadEntry >= 0) {
+        ContinueUpload(chunksPerFrame);
+    }
+    return SelectDisplayed();
+}
+
+void TimeSeriesVolume::WorkerMain() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopRequested) {
+        // 按播放顺序找窗口内第一个尚未载入的位置；对应槽位正被载入或上传时跳过
+        Slot* claimed = nullptr;
+        int64_t position = -1;
+        for (int64_t p = target; p < targetEnd; p++) {
+            Slot& slot = slots[p % slots.size()];
+            if (slot.position == p && slot.state != SlotState::Empty) continue;
+            if (slot.state == SlotState::Loading || slot.state == SlotState::Uploading) continue;
+            claimed = &slot;
+            position = p;
+            break;
+        }
+        if (!claimed) {
+            condition.wait(lock);
+            continue;
+        }
+        
+        claimed->state = SlotState::Loading;
+        claimed->position = position;
+        lock.unlock();
+        bool loaded = LoadStep(PositionToStep(position), *claimed);
+        lock.lock();
+        claimed->state = loaded ? SlotState::Ready : SlotState::Failed;
+    }
+}
+
+bool TimeSeriesVolume::LoadStep(int step, Slot& slot) const {
+    std::string filename;
+    FramePattern::Format(pattern, firstIndex + step, filename);
+    
+    MappedFile file;
+    if (!file.Open(filename) || file.GetSize() < (uint64_t)width * height * depth) {
+        std::cerr << "Failed to read time step: " << filename << std::endl;
+        return false;
+    }
+    file.AdviseSequential();
+    
+    // 槽位缓冲在打开时已分配，这里只写入
+    VolumeGradient::ComputePacked(file.GetData(), width, height, depth, 0, depth, gradientFilter, slot.packed.data());
+    VolumeData::ComputeMacrocellMinMax(file.GetData(), width, height, depth, slot.macrocellMinMax);
+    return true;
+}
+
+void TimeSeriesVolume::StartUpload(int64_t windowEnd) {
+    std::lock_guard<std::mutex> lock(mutex);
+    
+    // 可复用的纹理：未显示，且内容不在播放位置之后的窗口内
+    int entry = -1;
+    for (int i = 0; i < TEXTURE_POOL_SIZE && entry < 0; i++) {
+        if (i != displayedEntry && (pool[i].position < target || pool[i].position >= windowEnd)) {
+            entry = i;
+        }
+    }
+    if (entry < 0) return;
+    
+    int64_t position = -1;
+    for (int64_t p = target; p < windowEnd; p++) {
+        // 已在纹理池中
+        bool resident = false;
+        for (const PoolEntry& poolEntry : pool) {
+            resident = resident || poolEntry.position == p;
+        }
+        if (resident) continue;
+        
+        // 按顺序上传：下一个位置尚未就绪时等待；读取失败的步越过
+        const Slot& slot = slots[p % slots.size()];
+        if (slot.position != p) break;
+        if (slot.state == SlotState::Failed) {
+            if (p == std::max(displayedPosition, skippedPosition) + 1) {
+                skippedPosition = p;
+            }
+            continue;
+        }
+        if (slot.state == SlotState::Ready) {
+            position = p;
+        }
+        break;
+    }
+    
+    // 允许丢帧且播放位置的步尚未就绪时（I/O慢于播放速率），改为上传已就绪的、位于显示与播放位置之间的最新一步，
+    // 否则读取完成时播放位置总已越过它，画面会一直停在旧的一步
+    if (position < 0 && dropFrames) {
+        for (const Slot& slot : slots) {
+            if (slot.state == SlotState::Ready && slot.position > displayedPosition && slot.position < target &&
+                slot.position > position) {
+                position = slot.position;
+            }
+        }
+    }
+    if (position < 0) return;
+    
+    Slot& slot = slots[position % slots.size()];
+    slot.state = SlotState::Uploading;
+    pool[entry].position = -1;
+    uploadEntry = entry;
+    uploadSlot = (int)(position % slots.size());
+    uploadPosition = position;
+    uploadedSlices = 0;
+}
+
+bool TimeSeriesVolume::ContinueUpload(int chunksPerFrame) {
+    const Slot& slot = slots[uploadSlot];
+    const size_t sliceBytes = (size_t)width * height * 4;
+    VolumeData& volume = *pool[uploadEntry].volume;
+    
+    for (int i = 0; i < chunksPerFrame && uploadedSlices < depth; i++) {
+        // 下一个PBO仍在被GPU读取时本帧不再上传，避免阻塞
+        GLsync& fence = fences[nextPbo];
+        if (fence) {
+            GLenum status = glClientWaitSync(fence, 0, 0);
+            if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+                break;
+            }
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+        
+        int zBegin = uploadedSlices;
+        int zEnd = std::min(zBegin + slicesPerChunk, depth);
+        const unsigned char* src = slot.packed.data() + sliceBytes * zBegin;
+        size_t bytes = sliceBytes * (zEnd - zBegin);
+        
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbos[nextPbo]);
+        void* mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, (GLsizeiptr)bytes,
+                                        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+        if (mapped) {
+            std::memcpy(mapped, src, bytes);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+            volume.UploadSlices(zBegin, zEnd, nullptr);
+        } else {
+            // 映射失败时退回直接上传
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            volume.UploadSlices(zBegin, zEnd, src);
+        }
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        
+        fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        nextPbo = (nextPbo + 1) % PBO_COUNT;
+        uploadedSlices = zEnd;
+    }
+    
+    if (uploadedSlices < depth) {
+        return false;
+    }
+    
+    // 全部切片已提交：该纹理项可供显示，槽位交还给环形缓冲（数据仍有效）
+    volume.SetMacrocellMinMax(slot.macrocellMinMax);
+    pool[uploadEntry].position = uploadPosition;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        slots[uploadSlot].state = SlotState::Ready;
+    }
+    condition.notify_all();
+    uploadEntry = -1;
+    return true;
+}
+
+void TimeSeriesVolume::CancelUpload() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        slots[uploadSlot].state = SlotState::Ready;
+    }
+    condition.notify_all();
+    uploadEntry = -1;
+}
+
+bool TimeSeriesVolume::SelectDisplayed() {
+    // 显示不超过播放位置的最新一步；两者之间没能及时就绪的步计为丢帧
+    int64_t position = GetTargetPosition();
+    int best = -1;
+    for (int i = 0; i < TEXTURE_POOL_SIZE; i++) {
+        int64_t p = pool[i].position;
+        if (p > displayedPosition && p <= position && (best < 0 || p > pool[best].position)) {
+            best = i;
+        }
+    }
+    if (best < 0) {
+        return false;
+    }
+    
+    if (displayedPosition >= 0) {
+        droppedSteps += (int)(pool[best].position - displayedPosition - 1);
+    }
+    displayedPosition = pool[best].position;
+    displayedEntry = best;
+    return true;
+}
+
+void TimeSeriesVolume::ReleaseGLResources() {
+    for (int i = 0; i < PBO_COUNT; i++) {
+        if (fences[i]) {
+            glDeleteSync(fences[i]);
+            fences[i] = nullptr;
+        }
+    }
+    if (pbos[0] != 0) {
+        glDeleteBuffers(PBO_COUNT, pbos);
+        for (int i = 0; i < PBO_COUNT; i++) {
+            pbos[i] = 0;
+        }
+    }
+}
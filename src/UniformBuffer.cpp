@@ -0,0 +1,102 @@
+#include "UniformBuffer.h"
+#include <cstring>
+#include <iostream>
+
+UniformBuffer::UniformBuffer()
+    : buffer(0), blockSize(0), regionStride(0), mapped(nullptr), region(-1) {
+    for (int i = 0; i < REGION_COUNT; i++) {
+        fences[i] = nullptr;
+    }
+}
+
+UniformBuffer::~UniformBuffer() {
+    Release();
+}
+
+bool UniformBuffer::Create(GLsizeiptr size) {
+    Release();
+    
+    GLint alignment = 256;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    alignment = alignment > 0 ? alignment : 256;
+    blockSize = size;
+    regionStride = (size + alignment - 1) / alignment * alignment;
+    GLsizeiptr totalSize = regionStride * REGION_COUNT;
+    
+    glGenBuffers(1, &buffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+    if (GLAD_GL_VERSION_4_4) {
+        const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_UNIFORM_BUFFER, totalSize, nullptr, flags);
+        mapped = static_cast<unsigned char*>(glMapBufferRange(GL_UNIFORM_BUFFER, 0, totalSize, flags));
+        if (!mapped) {
+            std::cerr << "Failed to map uniform buffer persistently" << std::endl;
+            glBindBuffer(GL_UNIFORM_BUFFER, 0);
+            Release();
+            return false;
+        }
+    } else {
+        glBufferData(GL_UNIFORM_BUFFER, totalSize, nullptr, GL_DYNAMIC_DRAW);
+    }
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    return true;
+}
+
+void UniformBuffer::Update(const void* data, GLuint binding) {
+    if (buffer == 0) return;
+    
+    // 上一个区域的读取命令均已提交，插入栅栏
+    if (region >= 0) {
+        if (fences[region]) {
+            glDeleteSync(fences[region]);
+        }
+        fences[region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+    region = (region + 1) % REGION_COUNT;
+    
+    // 该区域是REGION_COUNT帧之前写入的，GPU通常早已读完
+    if (fences[region]) {
+        GLenum status = glClientWaitSync(fences[region], 0, 0);
+        while (status == GL_TIMEOUT_EXPIRED) {
+            status = glClientWaitSync(fences[region], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+        }
+        glDeleteSync(fences[region]);
+        fences[region] = nullptr;
+    }
+    
+    GLintptr offset = regionStride * region;
+    if (mapped) {
+        std::memcpy(mapped + offset, data, blockSize);
+    } else {
+        // 区域已确认空闲，非同步映射不会让驱动等待
+        glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+        void* target = glMapBufferRange(GL_UNIFORM_BUFFER, offset, blockSize,
+                                        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+        if (target) {
+            std::memcpy(target, data, blockSize);
+            glUnmapBuffer(GL_UNIFORM_BUFFER);
+        }
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+    glBindBufferRange(GL_UNIFORM_BUFFER, binding, buffer, offset, blockSize);
+}
+
+void UniformBuffer::Release() {
+    for (int i = 0; i < REGION_COUNT; i++) {
+        if (fences[i]) {
+            glDeleteSync(fences[i]);
+            fences[i] = nullptr;
+        }
+    }
+    if (buffer != 0) {
+        if (mapped) {
+            glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+            glUnmapBuffer(GL_UNIFORM_BUFFER);
+            glBindBuffer(GL_UNIFORM_BUFFER, 0);
+            mapped = nullptr;
+        }
+        glDeleteBuffers(1, &buffer);
+        buffer = 0;
+    }
+    region = -1;
+}
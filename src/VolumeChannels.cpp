@@ -0,0 +1,118 @@
+#include "VolumeChannels.h"
+#include <algorithm>
+#include <iostream>
+#include <glm/gtc/matrix_transform.hpp>
+
+static_assert(sizeof(ChannelUniforms::params) / sizeof(glm::vec4) == VolumeChannels::MAX_CHANNELS,
+              "ChannelBlock arrays must hold MAX_CHANNELS entries");
+
+VolumeChannels::VolumeChannels() {
+}
+
+VolumeChannels::~VolumeChannels() {
+    Clear();
+}
+
+int VolumeChannels::Add(std::unique_ptr<VolumeData> volume, const std::vector<glm::vec4>& transferFunction,
+                        const ChannelParams& params) {
+    if (!volume || (int)channels.size() >= MAX_CHANNELS) {
+        std::cerr << "Cannot add volume channel (at most " << MAX_CHANNELS << " channels)" << std::endl;
+        return -1;
+    }
+    
+    Channel channel;
+    channel.volume = std::move(volume);
+    channel.params = params;
+    glGenTextures(1, &channel.transferFunctionTexture);
+    glBindTexture(GL_TEXTURE_1D, channel.transferFunctionTexture);
+    glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glBindTexture(GL_TEXTURE_1D, 0);
+    channels.push_back(std::move(channel));
+    
+    int index = (int)channels.size() - 1;
+    SetTransferFunction(index, transferFunction);
+    return index;
+}
+
+void VolumeChannels::Remove(int index) {
+    if (index < 0 || index >= (int)channels.size()) return;
+    ReleaseChannel(channels[index]);
+    channels.erase(channels.begin() + index);
+}
+
+void VolumeChannels::Clear() {
+    for (Channel& channel : channels) {
+        ReleaseChannel(channel);
+    }
+    channels.clear();
+}
+
+int VolumeChannels::GetActiveCount() const {
+    return (int)std::count_if(channels.begin(), channels.end(),
+                              [](const Channel& channel) { return channel.params.enabled; });
+}
+
+void VolumeChannels::SetParams(int index, const ChannelParams& params) {
+    if (index < 0 || index >= (int)channels.size()) return;
+    channels[index].params = params;
+}
+
+void VolumeChannels::SetTransferFunction(int index, const std::vector<glm::vec4>& colors) {
+    if (index < 0 || index >= (int)channels.size() || colors.empty()) return;
+    glBindTexture(GL_TEXTURE_1D, channels[index].transferFunctionTexture);
+    glTexImage1D(GL_TEXTURE_1D, 0, GL_RGBA, colors.size(), 0, GL_RGBA, GL_FLOAT, colors.data());
+    glBindTexture(GL_TEXTURE_1D, 0);
+}
+
+void VolumeChannels::Bind() const {
+    GLuint slot = 0;
+    for (const Channel& channel : channels) {
+        if (!channel.params.enabled) continue;
+        channel.volume->Bind(FIRST_VOLUME_UNIT + slot);
+        glActiveTexture(GL_TEXTURE0 + FIRST_TRANSFER_FUNCTION_UNIT + slot);
+        glBindTexture(GL_TEXTURE_1D, channel.transferFunctionTexture);
+        slot++;
+    }
+    glActiveTexture(GL_TEXTURE0);
+}
+
+void VolumeChannels::FillUniforms(ChannelUniforms& uniforms) const {
+    int slot = 0;
+    for (const Channel& channel : channels) {
+        if (!channel.params.enabled) continue;
+        const VolumeData& volume = *channel.volume;
+        const ChannelParams& params = channel.params;
+        
+        // 与主体数据相同：包围盒按物理尺寸确定比例，最长轴为1
+        glm::vec3 volumeSize(volume.GetWidth(), volume.GetHeight(), volume.GetDepth());
+        glm::vec3 physicalSize = volumeSize * volume.GetSpacing();
+        glm::vec3 boxExtent = physicalSize / std::max(std::max(physicalSize.x, physicalSize.y), physicalSize.z);
+        
+        // 通道局部空间 -> 世界空间：缩放、XYZ欧拉角旋转、平移
+        glm::mat4 model = glm::translate(glm::mat4(1.0f), params.translation);
+        model = glm::rotate(model, glm::radians(params.rotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
+        model = glm::rotate(model, glm::radians(params.rotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
+        model = glm::rotate(model, glm::radians(params.rotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
+        model = glm::scale(model, glm::vec3(std::max(params.scale, 1e-6f)));
+        
+        // 局部包围盒 [-extent/2, extent/2] -> 纹理坐标 [0,1]
+        glm::mat4 localToTexture = glm::translate(glm::mat4(1.0f), glm::vec3(0.5f));
+        localToTexture = glm::scale(localToTexture, glm::vec3(1.0f) / boxExtent);
+        
+        uniforms.worldToTexture[slot] = localToTexture * glm::inverse(model);
+        uniforms.params[slot] = glm::vec4(params.density, params.threshold, 0.0f, 0.0f);
+        uniforms.volumeSize[slot] = glm::vec4(volumeSize, 0.0f);
+        slot++;
+    }
+    uniforms.channelCount = slot;
+}
+
+void VolumeChannels::ReleaseChannel(Channel& channel) {
+    if (channel.transferFunctionTexture != 0) {
+        glDeleteTextures(1, &channel.transferFunctionTexture);
+        channel.transferFunctionTexture = 0;
+    }
+    channel.volume.reset();
+}
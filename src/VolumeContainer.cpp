@@ -0,0 +1,458 @@
+#include "VolumeContainer.h"
+#include "LZCodec.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+
+namespace {
+
+const char MAGIC[4] = { 'V', 'C', 'Z', '1' };
+// 版本2：增加CODEC_DELTA_SHUFFLE_LZ和文件头中的值域，版本1的文件仍可读取
+const uint32_t VERSION = 2;
+const size_t HEADER_SIZE = 64;
+const size_t INDEX_ENTRY_SIZE = 16;
+const uint32_t FLAG_BIG_ENDIAN = 1;
+const uint32_t FLAG_VALUE_RANGE = 2;
+
+// 文件头和索引中的整数一律按小端序存储，与平台无关
+void Put32(unsigned char* p, uint32_t v) {
+    for (int i = 0; i < 4; i++) p[i] = (unsigned char)(v >> (i * 8));
+}
+
+void Put64(unsigned char* p, uint64_t v) {
+    for (int i = 0; i < 8; i++) p[i] = (unsigned char)(v >> (i * 8));
+}
+
+uint32_t Get32(const unsigned char* p) {
+    uint32_t v = 0;
+    for (int i = 0; i < 4; i++) v |= (uint32_t)p[i] << (i * 8);
+    return v;
+}
+
+uint64_t Get64(const unsigned char* p) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++) v |= (uint64_t)p[i] << (i * 8);
+    return v;
+}
+
+void PutFloat(unsigned char* p, float f) {
+    uint32_t bits;
+    std::memcpy(&bits, &f, 4);
+    Put32(p, bits);
+}
+
+float GetFloat(const unsigned char* p) {
+    uint32_t bits = Get32(p);
+    float f;
+    std::memcpy(&f, &bits, 4);
+    return f;
+}
+
+// 按文件字节序把一个体素读成/写成无符号整数
+template <typename U, bool BigEndian>
+U LoadUnsigned(const unsigned char* p) {
+    U v = 0;
+    for (size_t i = 0; i < sizeof(U); i++) {
+        v = (U)(v | ((U)p[BigEndian ? sizeof(U) - 1 - i : i] << (i * 8)));
+    }
+    return v;
+}
+
+template <typename U, bool BigEndian>
+void StoreUnsigned(unsigned char* p, U v) {
+    for (size_t i = 0; i < sizeof(U); i++) {
+        p[BigEndian ? sizeof(U) - 1 - i : i] = (unsigned char)(v >> (i * 8));
+    }
+}
+
+// 第i个体素的差分值（第b个字节位于平面b）
+template <typename U>
+U GatherPlanes(const unsigned char* planes, size_t voxelCount, size_t i) {
+    U v = 0;
+    for (size_t b = 0; b < sizeof(U); b++) {
+        v = (U)(v | ((U)planes[b * voxelCount + i] << (b * 8)));
+    }
+    return v;
+}
+
+// 差分 + 字节拆分：每行内体素按无符号整数与前一体素回绕相减（行首与0相减），差的第b个字节写入平面b；
+// 平滑数据的差集中在0附近，高位字节平面几乎是常数，LZ能找到长匹配
+template <typename U, bool BigEndian>
+void DeltaShuffleTyped(const unsigned char* raw, size_t voxelCount, int rowLength, unsigned char* out) {
+    for (size_t rowStart = 0; rowStart < voxelCount; rowStart += rowLength) {
+        U previous = 0;
+        for (size_t i = rowStart; i < rowStart + rowLength; i++) {
+            U value = LoadUnsigned<U, BigEndian>(raw + i * sizeof(U));
+            U delta = (U)(value - previous);
+            previous = value;
+            for (size_t b = 0; b < sizeof(U); b++) {
+                out[b * voxelCount + i] = (unsigned char)(delta >> (b * 8));
+            }
+        }
+    }
+}
+
+// 从字节平面重建一行的[x0, x1)体素写入out（差分从行首开始累加）
+template <typename U, bool BigEndian>
+void UnshuffleDeltaRowTyped(const unsigned char* planes, size_t voxelCount, size_t rowStart, int x0, int x1,
+                            unsigned char* out) {
+    U value = 0;
+    for (int x = 0; x < x0; x++) {
+        value = (U)(value + GatherPlanes<U>(planes, voxelCount, rowStart + x));
+    }
+    for (int x = x0; x < x1; x++, out += sizeof(U)) {
+        value = (U)(value + GatherPlanes<U>(planes, voxelCount, rowStart + x));
+        StoreUnsigned<U, BigEndian>(out, value);
+    }
+}
+
+void DeltaShuffle(const unsigned char* raw, size_t voxelSize, size_t voxelCount, int rowLength, bool bigEndian,
+                  unsigned char* out) {
+    switch (voxelSize) {
+        case 1:
+            DeltaShuffleTyped<uint8_t, false>(raw, voxelCount, rowLength, out);
+            break;
+        case 2:
+            bigEndian ? DeltaShuffleTyped<uint16_t, true>(raw, voxelCount, rowLength, out)
+                      : DeltaShuffleTyped<uint16_t, false>(raw, voxelCount, rowLength, out);
+            break;
+        default:
+            bigEndian ? DeltaShuffleTyped<uint32_t, true>(raw, voxelCount, rowLength, out)
+                      : DeltaShuffleTyped<uint32_t, false>(raw, voxelCount, rowLength, out);
+            break;
+    }
+}
+
+void UnshuffleDeltaRow(const unsigned char* planes, size_t voxelSize, size_t voxelCount, size_t rowStart, int x0, int x1,
+                       bool bigEndian, unsigned char* out) {
+    switch (voxelSize) {
+        case 1:
+            UnshuffleDeltaRowTyped<uint8_t, false>(planes, voxelCount, rowStart, x0, x1, out);
+            break;
+        case 2:
+            bigEndian ? UnshuffleDeltaRowTyped<uint16_t, true>(planes, voxelCount, rowStart, x0, x1, out)
+                      : UnshuffleDeltaRowTyped<uint16_t, false>(planes, voxelCount, rowStart, x0, x1, out);
+            break;
+        default:
+            bigEndian ? UnshuffleDeltaRowTyped<uint32_t, true>(planes, voxelCount, rowStart, x0, x1, out)
+                      : UnshuffleDeltaRowTyped<uint32_t, false>(planes, voxelCount, rowStart, x0, x1, out);
+            break;
+    }
+}
+
+// 统计一块有限值的范围（按源字节序解释），没有有限值时lo > hi
+template <typename T>
+void ChunkValueRangeTyped(const unsigned char* raw, size_t voxelCount, bool swapBytes, float& lo, float& hi) {
+    for (size_t i = 0; i < voxelCount; i++, raw += sizeof(T)) {
+        unsigned char bytes[sizeof(T)];
+        for (size_t b = 0; b < sizeof(T); b++) {
+            bytes[b] = swapBytes ? raw[sizeof(T) - 1 - b] : raw[b];
+        }
+        T value;
+        std::memcpy(&value, bytes, sizeof(T));
+        float v = (float)value;
+        if (!std::isfinite(v)) continue;
+        lo = std::min(lo, v);
+        hi = std::max(hi, v);
+    }
+}
+
+void ChunkValueRange(const unsigned char* raw, VoxelType type, size_t voxelCount, bool swapBytes, float& lo, float& hi) {
+    switch (type) {
+        case VoxelType::UInt8:   ChunkValueRangeTyped<uint8_t>(raw, voxelCount, swapBytes, lo, hi); break;
+        case VoxelType::Int16:   ChunkValueRangeTyped<int16_t>(raw, voxelCount, swapBytes, lo, hi); break;
+        case VoxelType::UInt16:  ChunkValueRangeTyped<uint16_t>(raw, voxelCount, swapBytes, lo, hi); break;
+        case VoxelType::Float32: ChunkValueRangeTyped<float>(raw, voxelCount, swapBytes, lo, hi); break;
+    }
+}
+
+} // namespace
+
+bool VolumeContainer::IsContainerFile(const std::string& filename) {
+    size_t dot = filename.find_last_of('.');
+    if (dot == std::string::npos) return false;
+    std::string ext = filename.substr(dot + 1);
+    return ext == "vcz" || ext == "VCZ";
+}
+
+bool VolumeContainer::Open(const std::string& filename) {
+    Close();
+    
+    if (!file.Open(filename)) {
+        return false;
+    }
+    
+    const unsigned char* data = file.GetData();
+    if (file.GetSize() < HEADER_SIZE || std::memcmp(data, MAGIC, 4) != 0) {
+        std::cerr << "Not a volume container file: " << filename << std::endl;
+        Close();
+        return false;
+    }
+    uint32_t version = Get32(data + 4);
+    if (version < 1 || version > VERSION) {
+        std::cerr << "Unsupported volume container version " << Get32(data + 4) << ": " << filename << std::endl;
+        Close();
+        return false;
+    }
+    
+    info = VolumeFileInfo();
+    info.width = (int)Get32(data + 8);
+    info.height = (int)Get32(data + 12);
+    info.depth = (int)Get32(data + 16);
+    chunkSize = (int)Get32(data + 20);
+    uint32_t type = Get32(data + 24);
+    uint32_t flags = Get32(data + 28);
+    info.bigEndian = (flags & FLAG_BIG_ENDIAN) != 0;
+    info.spacing = glm::vec3(GetFloat(data + 32), GetFloat(data + 36), GetFloat(data + 40));
+    uint32_t chunkCount = Get32(data + 44);
+    hasValueRange = version >= 2 && (flags & FLAG_VALUE_RANGE) != 0;
+    valueRange = hasValueRange ? glm::vec2(GetFloat(data + 48), GetFloat(data + 52)) : glm::vec2(0.0f);
+    info.dataFile = filename;
+    
+    if (info.width <= 0 || info.height <= 0 || info.depth <= 0 || chunkSize <= 0 ||
+        type > (uint32_t)VoxelType::Float32) {
+        std::cerr << "Corrupt volume container header: " << filename << std::endl;
+        Close();
+        return false;
+    }
+    info.type = (VoxelType)type;
+    
+    chunkGrid = glm::ivec3((info.width + chunkSize - 1) / chunkSize,
+                           (info.height + chunkSize - 1) / chunkSize,
+                           (info.depth + chunkSize - 1) / chunkSize);
+    uint64_t expectedChunks = (uint64_t)chunkGrid.x * chunkGrid.y * chunkGrid.z;
+    if (chunkCount != expectedChunks || file.GetSize() < HEADER_SIZE + (uint64_t)chunkCount * INDEX_ENTRY_SIZE) {
+        std::cerr << "Corrupt volume container index: " << filename << std::endl;
+        Close();
+        return false;
+    }
+    
+    chunks.resize(chunkCount);
+    const unsigned char* entry = data + HEADER_SIZE;
+    for (uint32_t i = 0; i < chunkCount; i++, entry += INDEX_ENTRY_SIZE) {
+        chunks[i].offset = Get64(entry);
+        chunks[i].compressedSize = Get32(entry + 8);
+        chunks[i].codec = Get32(entry + 12);
+        if (chunks[i].offset > file.GetSize() || file.GetSize() - chunks[i].offset < chunks[i].compressedSize ||
+            chunks[i].codec > CODEC_DELTA_SHUFFLE_LZ) {
+            std::cerr << "Corrupt volume container chunk " << i << ": " << filename << std::endl;
+            Close();
+            return false;
+        }
+    }
+    return true;
+}
+
+void VolumeContainer::Close() {
+    file.Close();
+    chunks.clear();
+    chunkGrid = glm::ivec3(0);
+    hasValueRange = false;
+    valueRange = glm::vec2(0.0f);
+}
+
+bool VolumeContainer::ReadRegion(const glm::ivec3& origin, const glm::ivec3& size, unsigned char* dst,
+                                 ThreadPool& pool) const {
+    if (!file.IsOpen()) return false;
+    if (origin.x < 0 || origin.y < 0 || origin.z < 0 || size.x <= 0 || size.y <= 0 || size.z <= 0 ||
+        origin.x + size.x > info.width || origin.y + size.y > info.height || origin.z + size.z > info.depth) {
+        std::cerr << "Region is outside the volume" << std::endl;
+        return false;
+    }
+    
+    // 与区域相交的块
+    glm::ivec3 c0 = origin / chunkSize;
+    glm::ivec3 c1 = (origin + size - 1) / chunkSize;
+    std::vector<int> regionChunks;
+    for (int cz = c0.z; cz <= c1.z; cz++) {
+        for (int cy = c0.y; cy <= c1.y; cy++) {
+            for (int cx = c0.x; cx <= c1.x; cx++) {
+                regionChunks.push_back((cz * chunkGrid.y + cy) * chunkGrid.x + cx);
+            }
+        }
+    }
+    
+    // 块按索引顺序连续存放：一次性提示预读整个范围，解压与磁盘读取重叠进行
+    uint64_t rangeBegin = file.GetSize(), rangeEnd = 0;
+    for (int index : regionChunks) {
+        rangeBegin = std::min(rangeBegin, chunks[index].offset);
+        rangeEnd = std::max(rangeEnd, chunks[index].offset + chunks[index].compressedSize);
+    }
+    if (rangeEnd > rangeBegin) {
+        file.Prefetch(rangeBegin, rangeEnd - rangeBegin);
+    }
+    
+    const size_t voxelSize = VolumeHeader::GetVoxelSize(info.type);
+    std::atomic<bool> failed(false);
+    
+    // 每个任务解压一块并把与区域相交的行复制（差分编码的块直接重建）到目标位置，各块写入的区域互不重叠
+    pool.ParallelFor(0, (int)regionChunks.size(), [&](int i) {
+        int index = regionChunks[i];
+        glm::ivec3 chunk(index % chunkGrid.x, (index / chunkGrid.x) % chunkGrid.y, index / (chunkGrid.x * chunkGrid.y));
+        glm::ivec3 chunkMin = chunk * chunkSize;
+        glm::ivec3 extent = glm::min(chunkMin + chunkSize, glm::ivec3(info.width, info.height, info.depth)) - chunkMin;
+        size_t rawSize = (size_t)extent.x * extent.y * extent.z * voxelSize;
+        
+        const ChunkEntry& entry = chunks[index];
+        const unsigned char* compressed = file.GetData() + entry.offset;
+        std::vector<unsigned char> decoded;
+        const unsigned char* voxels = compressed;
+        if (entry.codec == CODEC_LZ || entry.codec == CODEC_DELTA_SHUFFLE_LZ) {
+            decoded.resize(rawSize);
+            if (!LZCodec::Decompress(compressed, entry.compressedSize, decoded.data(), rawSize)) {
+                failed = true;
+                return;
+            }
+            voxels = decoded.data();
+        } else if (entry.compressedSize != rawSize) {
+            failed = true;
+            return;
+        }
+        
+        glm::ivec3 lo = glm::max(chunkMin, origin);
+        glm::ivec3 hi = glm::min(chunkMin + extent, origin + size);
+        size_t rowBytes = (size_t)(hi.x - lo.x) * voxelSize;
+        size_t chunkVoxels = (size_t)extent.x * extent.y * extent.z;
+        for (int z = lo.z; z < hi.z; z++) {
+            for (int y = lo.y; y < hi.y; y++) {
+                size_t rowStart = ((size_t)(z - chunkMin.z) * extent.y + (y - chunkMin.y)) * extent.x;
+                unsigned char* out = dst +
+                    (((size_t)(z - origin.z) * size.y + (y - origin.y)) * size.x + (lo.x - origin.x)) * voxelSize;
+                if (entry.codec == CODEC_DELTA_SHUFFLE_LZ) {
+                    UnshuffleDeltaRow(voxels, voxelSize, chunkVoxels, rowStart, lo.x - chunkMin.x, hi.x - chunkMin.x,
+                                      info.bigEndian, out);
+                } else {
+                    std::memcpy(out, voxels + (rowStart + (lo.x - chunkMin.x)) * voxelSize, rowBytes);
+                }
+            }
+        }
+    });
+    
+    if (failed) {
+        std::cerr << "Corrupt chunk data in volume container: " << info.dataFile << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool VolumeContainer::Write(const std::string& filename, const unsigned char* data, int width, int height, int depth,
+                            VoxelType type, const glm::vec3& spacing, bool bigEndian, int chunkSize, ThreadPool& pool) {
+    if (width <= 0 || height <= 0 || depth <= 0 || chunkSize <= 0) {
+        std::cerr << "Invalid volume container dimensions" << std::endl;
+        return false;
+    }
+    
+    const size_t voxelSize = VolumeHeader::GetVoxelSize(type);
+    glm::ivec3 grid((width + chunkSize - 1) / chunkSize, (height + chunkSize - 1) / chunkSize,
+                    (depth + chunkSize - 1) / chunkSize);
+    int chunkCount = grid.x * grid.y * grid.z;
+    
+    // 各块并行收集、统计值域并压缩：直接LZ和差分+拆分字节后LZ取较小者，都不变小的块按原样存储
+    const bool swapBytes = bigEndian != VolumeHeader::IsHostBigEndian();
+    std::vector<std::vector<unsigned char>> payloads(chunkCount);
+    std::vector<uint32_t> codecs(chunkCount);
+    std::vector<float> rangeMin(chunkCount, std::numeric_limits<float>::max());
+    std::vector<float> rangeMax(chunkCount, std::numeric_limits<float>::lowest());
+    std::atomic<bool> failed(false);
+    pool.ParallelFor(0, chunkCount, [&](int index) {
+        glm::ivec3 chunkMin = glm::ivec3(index % grid.x, (index / grid.x) % grid.y, index / (grid.x * grid.y)) * chunkSize;
+        glm::ivec3 extent = glm::min(chunkMin + chunkSize, glm::ivec3(width, height, depth)) - chunkMin;
+        size_t rowBytes = (size_t)extent.x * voxelSize;
+        
+        std::vector<unsigned char> raw((size_t)extent.y * extent.z * rowBytes);
+        unsigned char* out = raw.data();
+        for (int z = 0; z < extent.z; z++) {
+            for (int y = 0; y < extent.y; y++, out += rowBytes) {
+                size_t offset = (((size_t)(chunkMin.z + z) * height + (chunkMin.y + y)) * width + chunkMin.x) * voxelSize;
+                std::memcpy(out, data + offset, rowBytes);
+            }
+        }
+        
+        size_t voxelCount = raw.size() / voxelSize;
+        ChunkValueRange(raw.data(), type, voxelCount, swapBytes, rangeMin[index], rangeMax[index]);
+        
+        std::vector<unsigned char> filtered(raw.size());
+        DeltaShuffle(raw.data(), voxelSize, voxelCount, extent.x, bigEndian, filtered.data());
+        
+        std::vector<unsigned char> compressed(LZCodec::CompressBound(raw.size()));
+        std::vector<unsigned char> compressedFiltered(compressed.size());
+        size_t compressedSize = LZCodec::Compress(raw.data(), raw.size(), compressed.data(), compressed.size());
+        size_t filteredSize = LZCodec::Compress(filtered.data(), filtered.size(), compressedFiltered.data(),
+                                                compressedFiltered.size());
+        if ((compressedSize == 0 || filteredSize == 0) && !raw.empty()) {
+            failed = true;
+            return;
+        }
+        if (filteredSize < std::min(compressedSize, raw.size())) {
+            compressedFiltered.resize(filteredSize);
+            payloads[index].swap(compressedFiltered);
+            codecs[index] = CODEC_DELTA_SHUFFLE_LZ;
+        } else if (compressedSize < raw.size()) {
+            compressed.resize(compressedSize);
+            payloads[index].swap(compressed);
+            codecs[index] = CODEC_LZ;
+        } else {
+            payloads[index].swap(raw);
+            codecs[index] = CODEC_STORED;
+        }
+    });
+    if (failed) {
+        std::cerr << "Failed to compress volume chunks" << std::endl;
+        return false;
+    }
+    
+    float valueMin = *std::min_element(rangeMin.begin(), rangeMin.end());
+    float valueMax = *std::max_element(rangeMax.begin(), rangeMax.end());
+    if (valueMin > valueMax) {
+        valueMin = valueMax = 0.0f;
+    }
+    
+    // 文件头 + 索引
+    std::vector<unsigned char> header(HEADER_SIZE + (size_t)chunkCount * INDEX_ENTRY_SIZE, 0);
+    std::memcpy(header.data(), MAGIC, 4);
+    Put32(&header[4], VERSION);
+    Put32(&header[8], (uint32_t)width);
+    Put32(&header[12], (uint32_t)height);
+    Put32(&header[16], (uint32_t)depth);
+    Put32(&header[20], (uint32_t)chunkSize);
+    Put32(&header[24], (uint32_t)type);
+    Put32(&header[28], (bigEndian ? FLAG_BIG_ENDIAN : 0) | FLAG_VALUE_RANGE);
+    PutFloat(&header[32], spacing.x);
+    PutFloat(&header[36], spacing.y);
+    PutFloat(&header[40], spacing.z);
+    Put32(&header[44], (uint32_t)chunkCount);
+    PutFloat(&header[48], valueMin);
+    PutFloat(&header[52], valueMax);
+    
+    uint64_t offset = header.size();
+    for (int i = 0; i < chunkCount; i++) {
+        unsigned char* entry = &header[HEADER_SIZE + (size_t)i * INDEX_ENTRY_SIZE];
+        Put64(entry, offset);
+        Put32(entry + 8, (uint32_t)payloads[i].size());
+        Put32(entry + 12, codecs[i]);
+        offset += payloads[i].size();
+    }
+    uint64_t totalRaw = (uint64_t)width * height * depth * voxelSize;
+    
+    std::ofstream out(filename, std::ios::binary);
+    if (!out.is_open()) {
+        std::cerr << "Failed to create volume container: " << filename << std::endl;
+        return false;
+    }
+    out.write(reinterpret_cast<const char*>(header.data()), (std::streamsize)header.size());
+    for (int i = 0; i < chunkCount; i++) {
+        out.write(reinterpret_cast<const char*>(payloads[i].data()), (std::streamsize)payloads[i].size());
+    }
+    if (!out) {
+        std::cerr << "Failed to write volume container: " << filename << std::endl;
+        return false;
+    }
+    
+    std::cout << "Wrote volume container: " << filename << " (" << chunkCount << " chunks, "
+              << offset << " / " << totalRaw << " bytes)" << std::endl;
+    return true;
+}
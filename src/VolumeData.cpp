@@ -1,14 +1,166 @@
 #include "VolumeData.h"
+#include "VolumeContainer.h"
+#include "VolumeGeometry.h"
 #include <iostream>
 #include <cmath>
-#include <fstream>
+#include <algorithm>
+#include <cstring>
+#include <limits>
 
-VolumeData::VolumeData() : textureID(0), width(0), height(0), depth(0) {}
+// 输出体素i在源轴上覆盖的范围 [begin, end)：通常为2个源体素，
+// 源尺寸为奇数时最后一个输出体素覆盖3个，保证每个源体素都被计入
+static inline void LodSourceRange(int i, int srcSize, int dstSize, int& begin, int& end) {
+    begin = std::min(i * 2, srcSize - 1);
+    end = (i == dstSize - 1) ? srcSize : std::min(i * 2 + 2, srcSize);
+}
+
+// 盒式滤波下采样[kBegin, kEnd)范围的输出切片，按z切片并行；src指向第srcZ个源切片
+static void DownsampleSlices(const unsigned char* src, glm::ivec3 srcSize,
+                             unsigned char* dst, glm::ivec3 dstSize, int kBegin, int kEnd, int srcZ = 0) {
+    ThreadPool::Shared().ParallelFor(kBegin, kEnd, [&](int k) {
+        int z0, z1;
+        LodSourceRange(k, srcSize.z, dstSize.z, z0, z1);
+        unsigned char* out = dst + (size_t)k * dstSize.x * dstSize.y;
+        
+        for (int j = 0; j < dstSize.y; j++) {
+            int y0, y1;
+            LodSourceRange(j, srcSize.y, dstSize.y, y0, y1);
+            for (int i = 0; i < dstSize.x; i++) {
+                int x0, x1;
+                LodSourceRange(i, srcSize.x, dstSize.x, x0, x1);
+                
+                unsigned int sum = 0;
+                for (int z = z0; z < z1; z++) {
+                    for (int y = y0; y < y1; y++) {
+                        const unsigned char* row = src + ((size_t)(z - srcZ) * srcSize.y + y) * srcSize.x;
+                        for (int x = x0; x < x1; x++) {
+                            sum += row[x];
+                        }
+                    }
+                }
+                unsigned int count = (unsigned int)((z1 - z0) * (y1 - y0) * (x1 - x0));
+                out[(size_t)j * dstSize.x + i] = (unsigned char)((sum + count / 2) / count);
+            }
+        }
+    });
+}
+
+// 原生类型的盒式滤波下采样（与DownsampleSlices的覆盖范围相同，整数类型四舍五入），src指向第srcZ个源切片
+template <typename T>
+static void DownsampleSlicesTyped(const unsigned char* src, glm::ivec3 srcSize,
+                                  unsigned char* dst, glm::ivec3 dstSize, int kBegin, int kEnd, int srcZ) {
+    ThreadPool::Shared().ParallelFor(kBegin, kEnd, [&](int k) {
+        int z0, z1;
+        LodSourceRange(k, srcSize.z, dstSize.z, z0, z1);
+        T* out = reinterpret_cast<T*>(dst) + (size_t)k * dstSize.x * dstSize.y;
+        
+        for (int j = 0; j < dstSize.y; j++) {
+            int y0, y1;
+            LodSourceRange(j, srcSize.y, dstSize.y, y0, y1);
+            for (int i = 0; i < dstSize.x; i++) {
+                int x0, x1;
+                LodSourceRange(i, srcSize.x, dstSize.x, x0, x1);
+                
+                double sum = 0.0;
+                for (int z = z0; z < z1; z++) {
+                    for (int y = y0; y < y1; y++) {
+                        const T* row = reinterpret_cast<const T*>(src) + ((size_t)(z - srcZ) * srcSize.y + y) * srcSize.x;
+                        for (int x = x0; x < x1; x++) {
+                            sum += (double)row[x];
+                        }
+                    }
+                }
+                double mean = sum / (double)((z1 - z0) * (y1 - y0) * (x1 - x0));
+                out[(size_t)j * dstSize.x + i] = std::numeric_limits<T>::is_integer ? (T)std::floor(mean + 0.5) : (T)mean;
+            }
+        }
+    });
+}
+
+static void DownsampleNative(VoxelType type, const unsigned char* src, glm::ivec3 srcSize,
+                             unsigned char* dst, glm::ivec3 dstSize, int kBegin, int kEnd, int srcZ = 0) {
+    switch (type) {
+        case VoxelType::UInt8:   DownsampleSlices(src, srcSize, dst, dstSize, kBegin, kEnd, srcZ); break;
+        case VoxelType::Int16:   DownsampleSlicesTyped<int16_t>(src, srcSize, dst, dstSize, kBegin, kEnd, srcZ); break;
+        case VoxelType::UInt16:  DownsampleSlicesTyped<uint16_t>(src, srcSize, dst, dstSize, kBegin, kEnd, srcZ); break;
+        case VoxelType::Float32: DownsampleSlicesTyped<float>(src, srcSize, dst, dstSize, kBegin, kEnd, srcZ); break;
+    }
+}
+
+// 读取一个体素并转为float，swapBytes为真时按相反字节序解释
+template <typename T>
+static inline float ReadVoxel(const unsigned char* p, bool swapBytes) {
+    unsigned char bytes[sizeof(T)];
+    for (size_t i = 0; i < sizeof(T); i++) {
+        bytes[i] = swapBytes ? p[sizeof(T) - 1 - i] : p[i];
+    }
+    T value;
+    std::memcpy(&value, bytes, sizeof(T));
+    return (float)value;
+}
+
+template <typename T>
+static void ComputeValueRangeTyped(const unsigned char* raw, bool swapBytes, int w, int h, int d,
+                                   float& minValue, float& maxValue) {
+    // 每个切片单独统计再归约，避免线程间共享
+    const size_t sliceVoxels = (size_t)w * h;
+    std::vector<float> sliceMin(d, std::numeric_limits<float>::max());
+    std::vector<float> sliceMax(d, std::numeric_limits<float>::lowest());
+    ThreadPool::Shared().ParallelFor(0, d, [&](int z) {
+        const unsigned char* p = raw + (size_t)z * sliceVoxels * sizeof(T);
+        float lo = sliceMin[z], hi = sliceMax[z];
+        for (size_t i = 0; i < sliceVoxels; i++, p += sizeof(T)) {
+            float v = ReadVoxel<T>(p, swapBytes);
+            if (!std::isfinite(v)) continue;
+            lo = std::min(lo, v);
+            hi = std::max(hi, v);
+        }
+        sliceMin[z] = lo;
+        sliceMax[z] = hi;
+    });
+    minValue = *std::min_element(sliceMin.begin(), sliceMin.end());
+    maxValue = *std::max_element(sliceMax.begin(), sliceMax.end());
+}
+
+// 统计有限值的范围；没有有限值时minValue > maxValue
+static void ComputeValueRange(const unsigned char* raw, VoxelType type, bool swapBytes, int w, int h, int d,
+                              float& minValue, float& maxValue) {
+    switch (type) {
+        case VoxelType::UInt8:   ComputeValueRangeTyped<uint8_t>(raw, swapBytes, w, h, d, minValue, maxValue); break;
+        case VoxelType::Int16:   ComputeValueRangeTyped<int16_t>(raw, swapBytes, w, h, d, minValue, maxValue); break;
+        case VoxelType::UInt16:  ComputeValueRangeTyped<uint16_t>(raw, swapBytes, w, h, d, minValue, maxValue); break;
+        case VoxelType::Float32: ComputeValueRangeTyped<float>(raw, swapBytes, w, h, d, minValue, maxValue); break;
+    }
+}
+
+// 复制size字节的体素，swapBytes为真时逐个体素翻转字节序
+static void CopyVoxels(const unsigned char* src, size_t size, size_t voxelSize, bool swapBytes, unsigned char* dst) {
+    if (!swapBytes || voxelSize == 1) {
+        std::memcpy(dst, src, size);
+        return;
+    }
+    for (size_t i = 0; i < size; i += voxelSize) {
+        for (size_t b = 0; b < voxelSize; b++) {
+            dst[i + b] = src[i + voxelSize - 1 - b];
+        }
+    }
+}
+
+VolumeData::VolumeData()
+    : textureID(0), width(0), height(0), depth(0), gradientFilter(GradientFilter::CentralDifference),
+      spacing(1.0f), voxelType(VoxelType::UInt8), valueMin(0.0f), valueMax(255.0f), densityTextureID(0),
+      macrocellTextureID(0), macrocellGridSize(0), lodLevelCount(1) {}
 
 VolumeData::~VolumeData() {
     if (textureID != 0) {
         glDeleteTextures(1, &textureID);
     }
+    if (macrocellTextureID != 0) {
+        glDeleteTextures(1, &macrocellTextureID);
+    }
+    if (densityTextureID != 0) {
+        glDeleteTextures(1, &densityTextureID);
+    }
 }
 
 bool VolumeData::LoadFromFile(const std::string& filename, int w, int h, int d) {
@@ -16,98 +168,709 @@ bool VolumeData::LoadFromFile(const std::string& filename, int w, int h, int d)
     height = h;
     depth = d;
     
-    std::ifstream file(filename, std::ios::binary);
-    if (!file.is_open()) {
+    // 内存映射文件，按Z切片分块上传，避免整体读入内存
+    MappedFile file;
+    if (!file.Open(filename)) {
         std::cerr << "Failed to open volume data file: " << filename << std::endl;
         return false;
     }
     
-    size_t dataSize = width * height * depth;
-    std::vector<unsigned char> data(dataSize);
-    file.read(reinterpret_cast<char*>(data.data()), dataSize);
-    file.close();
+    uint64_t dataSize = (uint64_t)width * (uint64_t)height * (uint64_t)depth;
+    if (file.GetSize() < dataSize) {
+        std::cerr << "Failed to read complete volume data: expected " << dataSize
+                  << " bytes, file has " << file.GetSize() << std::endl;
+        return false;
+    }
+    file.AdviseSequential();
+    
+    return CreateTexture3D(file.GetData(), &file);
+}
+
+bool VolumeData::LoadFromFile(const std::string& filename) {
+    if (VolumeContainer::IsContainerFile(filename)) {
+        return LoadFromContainer(filename);
+    }
+    
+    VolumeFileInfo info;
+    if (!VolumeHeader::Parse(filename, info)) {
+        return false;
+    }
+    
+    MappedFile file;
+    if (!file.Open(info.dataFile)) {
+        std::cerr << "Failed to open volume data file: " << info.dataFile << std::endl;
+        return false;
+    }
+    
+    uint64_t dataSize = info.GetVoxelCount() * VolumeHeader::GetVoxelSize(info.type);
+    uint64_t offset = info.offsetFromEnd ? file.GetSize() - std::min(file.GetSize(), dataSize) : info.dataOffset;
+    if (offset > file.GetSize() || file.GetSize() - offset < dataSize) {
+        std::cerr << "Failed to read complete volume data: expected " << dataSize
+                  << " bytes at offset " << offset << ", file has " << file.GetSize() << std::endl;
+        return false;
+    }
+    file.AdviseSequential();
+    
+    width = info.width;
+    height = info.height;
+    depth = info.depth;
+    spacing = info.spacing;
+    voxelType = info.type;
+    
+    std::cout << "Loading volume header: " << filename << " (" << width << "x" << height << "x" << depth
+              << ", spacing " << spacing.x << " " << spacing.y << " " << spacing.z << ")" << std::endl;
+    
+    if (voxelType == VoxelType::UInt8) {
+        valueMin = 0.0f;
+        valueMax = 255.0f;
+        return CreateTexture3D(file.GetData() + offset, &file, offset);
+    }
+    
+    // 直接读取映射内的切片块；请求的范围递增，之前的映射页不再需要
+    const unsigned char* raw = file.GetData() + offset;
+    const uint64_t sliceBytes = (uint64_t)width * height * VolumeHeader::GetVoxelSize(voxelType);
+    bool swapBytes = info.bigEndian != VolumeHeader::IsHostBigEndian();
+    return CreateFromSlabs([&](int zBegin, int) -> const unsigned char* {
+        file.Release(0, offset + zBegin * sliceBytes);
+        return raw + zBegin * sliceBytes;
+    }, swapBytes);
+}
+
+bool VolumeData::LoadFromContainer(const std::string& filename, const glm::ivec3& regionOrigin,
+                                   const glm::ivec3& regionSize) {
+    VolumeContainer container;
+    if (!container.Open(filename)) {
+        std::cerr << "Failed to open volume container: " << filename << std::endl;
+        return false;
+    }
+    
+    glm::ivec3 size = regionSize;
+    if (size.x <= 0 || size.y <= 0 || size.z <= 0) {
+        size = glm::ivec3(container.GetWidth(), container.GetHeight(), container.GetDepth()) - regionOrigin;
+    }
+    if (regionOrigin.x < 0 || regionOrigin.y < 0 || regionOrigin.z < 0 || size.x <= 0 || size.y <= 0 || size.z <= 0 ||
+        regionOrigin.x + size.x > container.GetWidth() || regionOrigin.y + size.y > container.GetHeight() ||
+        regionOrigin.z + size.z > container.GetDepth()) {
+        std::cerr << "Region is outside the volume" << std::endl;
+        return false;
+    }
+    
+    width = size.x;
+    height = size.y;
+    depth = size.z;
+    spacing = container.GetSpacing();
+    voxelType = container.GetVoxelType();
+    
+    std::cout << "Loading volume container: " << filename << " (" << width << "x" << height << "x" << depth
+              << " at " << regionOrigin.x << "," << regionOrigin.y << "," << regionOrigin.z << ")" << std::endl;
     
-    if (file.gcount() != dataSize) {
-        std::cerr << "Failed to read complete volume data" << std::endl;
+    // 按整行块解压（各块在线程池上并行解压，只读取与区域相交的块）：
+    // 缓冲保留[cacheBegin, cacheEnd)切片，请求超出时丢弃之前的切片并解压到下一个块行边界，每个块每遍只解压一次
+    const int chunkSize = container.GetChunkSize();
+    const uint64_t sliceBytes = (uint64_t)width * height * VolumeHeader::GetVoxelSize(voxelType);
+    std::vector<unsigned char> cache;
+    int cacheBegin = 0, cacheEnd = 0;
+    auto readSlab = [&](int zBegin, int zEnd) -> const unsigned char* {
+        if (zBegin < cacheBegin || zBegin > cacheEnd) {
+            cacheBegin = cacheEnd = zBegin;
+        }
+        if (zEnd > cacheEnd) {
+            int rowEnd = ((regionOrigin.z + zEnd + chunkSize - 1) / chunkSize) * chunkSize - regionOrigin.z;
+            rowEnd = std::min(rowEnd, depth);
+            
+            std::vector<unsigned char> next((size_t)((rowEnd - zBegin) * sliceBytes));
+            if (cacheEnd > zBegin) {
+                std::memcpy(next.data(), cache.data() + (size_t)((zBegin - cacheBegin) * sliceBytes),
+                            (size_t)((cacheEnd - zBegin) * sliceBytes));
+            }
+            if (!container.ReadRegion(regionOrigin + glm::ivec3(0, 0, cacheEnd), glm::ivec3(width, height, rowEnd - cacheEnd),
+                                      next.data() + (size_t)((cacheEnd - zBegin) * sliceBytes))) {
+                return nullptr;
+            }
+            cache.swap(next);
+            cacheBegin = zBegin;
+            cacheEnd = rowEnd;
+        }
+        return cache.data() + (size_t)((zBegin - cacheBegin) * sliceBytes);
+    };
+    
+    // 加载整个体积时直接使用文件头记录的值域，省去统计值域的一遍（否则每块要解压两次）
+    bool wholeVolume = size == glm::ivec3(container.GetWidth(), container.GetHeight(), container.GetDepth());
+    bool valueRangeKnown = wholeVolume && container.HasValueRange() && voxelType != VoxelType::UInt8;
+    if (valueRangeKnown) {
+        valueMin = container.GetValueRange().x;
+        valueMax = container.GetValueRange().y;
+    }
+    
+    bool swapBytes = container.IsBigEndian() != VolumeHeader::IsHostBigEndian();
+    return CreateFromSlabs(readSlab, swapBytes, valueRangeKnown);
+}
+
+bool VolumeData::CreateFromSlabs(const SlabReader& readSlab, bool swapBytes, bool valueRangeKnown) {
+    const uint64_t sliceVoxels = (uint64_t)width * height;
+    int slabDepth = std::min((int)std::max<uint64_t>(1, UPLOAD_SLAB_BYTES / (sliceVoxels * 4)), depth);
+    
+    // 块边界取偶数切片：原生密度的第1层LOD每个输出切片只读取本块内的源切片
+    if (slabDepth > 1 && slabDepth < depth) {
+        slabDepth &= ~1;
+    }
+    
+    // 第一遍：逐块统计值域（8位数据固定为[0, 255]，已知值域时跳过）
+    if (voxelType == VoxelType::UInt8) {
+        valueMin = 0.0f;
+        valueMax = 255.0f;
+    } else if (!valueRangeKnown) {
+        valueMin = std::numeric_limits<float>::max();
+        valueMax = std::numeric_limits<float>::lowest();
+        for (int z0 = 0; z0 < depth; z0 += slabDepth) {
+            int z1 = std::min(z0 + slabDepth, depth);
+            const unsigned char* raw = readSlab(z0, z1);
+            if (!raw) return false;
+            
+            float slabMin, slabMax;
+            ComputeValueRange(raw, voxelType, swapBytes, width, height, z1 - z0, slabMin, slabMax);
+            valueMin = std::min(valueMin, slabMin);
+            valueMax = std::max(valueMax, slabMax);
+        }
+        if (valueMin > valueMax) {
+            valueMin = valueMax = 0.0f;
+        }
+    }
+    if (voxelType != VoxelType::UInt8) {
+        std::cout << "Value range: [" << valueMin << ", " << valueMax << "]" << std::endl;
+    }
+    
+    if (!BeginUpload(width, height, depth) || !CreateDensityTexture()) {
         return false;
     }
     
-    return CreateTexture3D(data);
+    // 第二遍：每块转为主机字节序追加到窗口并上传原生精度密度；梯度和宏单元直接由原生值计算，
+    // 它们需要块前后各一个切片，因此上一块在本块读入之后才处理，窗口最多保留两块加一个切片
+    const uint64_t sliceBytes = sliceVoxels * VolumeHeader::GetVoxelSize(voxelType);
+    std::vector<unsigned char> window((size_t)(sliceBytes * (2 * slabDepth + 1)));
+    std::vector<unsigned char> packed((size_t)(sliceVoxels * 4 * slabDepth));
+    int windowBegin = 0, windowEnd = 0;
+    
+    auto processSlab = [&](int z0, int z1) {
+        VolumeGradient::ComputePackedNative(window.data(), voxelType, width, height, windowEnd - windowBegin,
+                                            z0 - windowBegin, z1 - windowBegin, gradientFilter, valueMin, valueMax,
+                                            packed.data());
+        UploadSlices(z0, z1, packed.data());
+        AccumulateMacrocells(window.data(), z0, z1, windowBegin);
+        AccumulateLod(window.data(), z0, z1, windowBegin);
+        
+        // 下一块只需要z1-1及之后的切片
+        int keep = std::max(z1 - 1, windowBegin);
+        std::memmove(window.data(), window.data() + (size_t)((keep - windowBegin) * sliceBytes),
+                     (size_t)((windowEnd - keep) * sliceBytes));
+        windowBegin = keep;
+    };
+    
+    int pendingBegin = 0, pendingEnd = 0;
+    for (int z0 = 0; z0 < depth; z0 += slabDepth) {
+        int z1 = std::min(z0 + slabDepth, depth);
+        const unsigned char* raw = readSlab(z0, z1);
+        if (!raw) return false;
+        
+        unsigned char* slab = window.data() + (size_t)((z0 - windowBegin) * sliceBytes);
+        CopyVoxels(raw, (size_t)(sliceBytes * (z1 - z0)), VolumeHeader::GetVoxelSize(voxelType), swapBytes, slab);
+        UploadDensitySlices(slab, z0, z1);
+        windowEnd = z1;
+        
+        if (pendingEnd > pendingBegin) {
+            processSlab(pendingBegin, pendingEnd);
+        }
+        pendingBegin = z0;
+        pendingEnd = z1;
+    }
+    processSlab(pendingBegin, pendingEnd);
+    
+    // 8位数据的LOD由累积的第1层密度生成；16位/浮点由原生密度金字塔生成
+    return FinishUpload(voxelType == VoxelType::UInt8) && CreateDensityLodLevels();
 }
 
-bool VolumeData::GenerateProceduralData(int size, int h, int d) {
+bool VolumeData::GenerateProceduralData(int size, int h, int d, const ProceduralParams& params) {
     width = size;
     height = (h > 0) ? h : size;
     depth = (d > 0) ? d : size;
     
-    size_t dataSize = width * height * depth;
-    std::vector<unsigned char> data(dataSize);
-    
-    // 生成程序化的3D Perlin噪声风格数据
-    // 这里使用简单的球形渐变作为示例
-    float centerX = width * 0.5f;
-    float centerY = height * 0.5f;
-    float centerZ = depth * 0.5f;
-    float maxRadius = std::min(std::min(width, height), depth) * 0.4f;
-    
-    for (int z = 0; z < depth; z++) {
-        for (int y = 0; y < height; y++) {
-            for (int x = 0; x < width; x++) {
-                float dx = x - centerX;
-                float dy = y - centerY;
-                float dz = z - centerZ;
-                float distance = std::sqrt(dx*dx + dy*dy + dz*dz);
-                
-                // 创建多层球形云雾效果
-                float value = 0.0f;
-                
-                // 主球体
-                if (distance < maxRadius) {
-                    value = 1.0f - (distance / maxRadius);
-                    value = std::pow(value, 2.0f);
-                }
-                
-                // 添加一些变化（简单的正弦波扰动）
-                float noise = std::sin(x * 0.1f) * std::cos(y * 0.1f) * std::sin(z * 0.1f);
-                value += noise * 0.2f;
-                value = std::max(0.0f, std::min(1.0f, value));
-                
-                int index = x + y * width + z * width * height;
-                data[index] = static_cast<unsigned char>(value * 255);
-            }
+    // 按Z切片并行生成（见ProceduralVolume.h）
+    std::vector<unsigned char> data = ProceduralVolume::Generate(params, width, height, depth);
+    
+    std::cout << "Generated procedural volume data (" << ProceduralVolume::GetShapeName(params.shape) << ", seed "
+              << params.seed << "): " << width << "x" << height << "x" << depth << std::endl;
+    return CreateTexture3D(data.data());
+}
+
+bool VolumeData::CreateTexture3D(const unsigned char* data, const MappedFile* mapping, uint64_t mappingOffset) {
+    voxelType = VoxelType::UInt8;
+    valueMin = 0.0f;
+    valueMax = 255.0f;
+    if (!BeginUpload(width, height, depth)) {
+        return false;
+    }
+    
+    // 每块包含若干完整Z切片：在CPU上并行预计算梯度并与密度打包为RGBA8，
+    // shader一次采样即可得到密度和法线。峰值内存约为一块的大小
+    const uint64_t sliceVoxels = (uint64_t)width * height;
+    const int slabDepth = (int)std::max<uint64_t>(1, UPLOAD_SLAB_BYTES / (sliceVoxels * 4));
+    std::vector<unsigned char> packed((size_t)(sliceVoxels * 4 * std::min(slabDepth, depth)));
+    
+    for (int z0 = 0; z0 < depth; z0 += slabDepth) {
+        int z1 = std::min(z0 + slabDepth, depth);
+        
+        VolumeGradient::ComputePacked(data, width, height, depth, z0, z1, gradientFilter, packed.data());
+        UploadSlices(z0, z1, packed.data());
+        AccumulateMacrocells(data, z0, z1);
+        AccumulateLod(data, z0, z1);
+        
+        // 下一块计算梯度只需要z1-1及之后的切片，之前的映射页可以释放
+        if (mapping) {
+            mapping->Release(0, mappingOffset + (uint64_t)std::max(z1 - 1, 0) * sliceVoxels);
         }
     }
     
-    std::cout << "Generated procedural volume data: " << width << "x" << height << "x" << depth << std::endl;
-    return CreateTexture3D(data);
+    return FinishUpload();
 }
 
-bool VolumeData::CreateTexture3D(const std::vector<unsigned char>& data) {
+bool VolumeData::BeginUpload(int w, int h, int d, int maxLodLevels) {
+    width = w;
+    height = h;
+    depth = d;
+    
     if (textureID != 0) {
         glDeleteTextures(1, &textureID);
+        textureID = 0;
+    }
+    if (densityTextureID != 0) {
+        glDeleteTextures(1, &densityTextureID);
+        densityTextureID = 0;
+    }
+    
+    GLint maxSize = 0;
+    glGetIntegerv(GL_MAX_3D_TEXTURE_SIZE, &maxSize);
+    if (width > maxSize || height > maxSize || depth > maxSize) {
+        std::cerr << "Volume " << width << "x" << height << "x" << depth
+                  << " exceeds GL_MAX_3D_TEXTURE_SIZE (" << maxSize << ")" << std::endl;
+        return false;
+    }
+    
+    // 层级数：逐层减半直到最长轴为1或达到上限
+    int maxDim = std::max(std::max(width, height), depth);
+    lodLevelCount = 1;
+    while (lodLevelCount < std::min(maxLodLevels, (int)MAX_LOD_LEVELS) && (maxDim >> lodLevelCount) > 0) {
+        lodLevelCount++;
     }
     
     glGenTextures(1, &textureID);
     glBindTexture(GL_TEXTURE_3D, textureID);
     
-    // 设置纹理参数
+    // 设置纹理参数（shader通过textureLod显式选择层级）
     glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
     glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
     glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAX_LEVEL, lodLevelCount - 1);
     
-    // 上传数据到3D纹理
-    glTexImage3D(GL_TEXTURE_3D, 0, GL_RED, width, height, depth, 
-                 0, GL_RED, GL_UNSIGNED_BYTE, data.data());
-    
+    // 只分配存储，数据按切片块上传
+    for (int level = 0; level < lodLevelCount; level++) {
+        glm::ivec3 size = GetLodLevelSize(level);
+        glTexImage3D(GL_TEXTURE_3D, level, GL_RGBA8, size.x, size.y, size.z,
+                     0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    }
     glBindTexture(GL_TEXTURE_3D, 0);
     
+    ResetMacrocellGrid();
+    
+    // 8位LOD密度只用于8位数据，16位/浮点的LOD由原生密度生成（见CreateDensityLodLevels）
+    lodDensity.clear();
+    if (lodLevelCount > 1 && voxelType == VoxelType::UInt8) {
+        glm::ivec3 size = GetLodLevelSize(1);
+        lodDensity.resize((size_t)size.x * size.y * size.z);
+    }
+    return true;
+}
+
+void VolumeData::UploadSlices(int zBegin, int zEnd, const void* packed, int level) {
+    glm::ivec3 size = GetLodLevelSize(level);
+    glBindTexture(GL_TEXTURE_3D, textureID);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexSubImage3D(GL_TEXTURE_3D, level, 0, 0, zBegin, size.x, size.y, zEnd - zBegin,
+                    GL_RGBA, GL_UNSIGNED_BYTE, packed);
+    glBindTexture(GL_TEXTURE_3D, 0);
+}
+
+bool VolumeData::AllocateFrame(int w, int h, int d) {
+    if (textureID != 0 && lodLevelCount == 1 && w == width && h == height && d == depth) {
+        return true;
+    }
+    return BeginUpload(w, h, d, 1) && CreateMacrocellTexture();
+}
+
+void VolumeData::ComputeMacrocellMinMax(const unsigned char* data, int width, int height, int depth,
+                                        std::vector<float>& minMax) {
+    const int B = MACROCELL_SIZE;
+    glm::ivec3 grid((width + B - 1) / B, (height + B - 1) / B, (depth + B - 1) / B);
+    size_t cellCount = (size_t)grid.x * grid.y * grid.z;
+    minMax.resize(cellCount * 2);
+    for (size_t cell = 0; cell < cellCount; cell++) {
+        minMax[cell * 2 + 0] = std::numeric_limits<float>::max();
+        minMax[cell * 2 + 1] = std::numeric_limits<float>::lowest();
+    }
+    AccumulateMacrocellRange(data, glm::ivec3(width, height, depth), grid, minMax.data(), 0, depth, 0,
+                             0.0f, 1.0f / 255.0f);
+}
+
+void VolumeData::SetMacrocellMinMax(const std::vector<float>& minMax) {
+    if (minMax.size() != macrocellMinMax.size()) {
+        std::cerr << "Macrocell grid size mismatch" << std::endl;
+        return;
+    }
+    macrocellMinMax = minMax;
+}
+
+bool VolumeData::FinishUpload(bool createLodLevels) {
     std::cout << "Created 3D texture: " << width << "x" << height << "x" << depth << std::endl;
+    if (createLodLevels && !CreateLodLevels()) {
+        return false;
+    }
+    return CreateMacrocellTexture();
+}
+
+// 原生精度密度纹理的格式（8位数据没有原生精度纹理时返回false）
+static bool GetDensityFormat(VoxelType voxelType, GLenum& internalFormat, GLenum& type) {
+    switch (voxelType) {
+        case VoxelType::Int16:   internalFormat = GL_R16_SNORM; type = GL_SHORT;          return true;
+        case VoxelType::UInt16:  internalFormat = GL_R16;       type = GL_UNSIGNED_SHORT; return true;
+        case VoxelType::Float32: internalFormat = GL_R32F;      type = GL_FLOAT;          return true;
+        default: return false;
+    }
+}
+
+bool VolumeData::CreateDensityTexture() {
+    GLenum internalFormat, type;
+    if (!GetDensityFormat(voxelType, internalFormat, type)) {
+        return true;
+    }
+    
+    glGenTextures(1, &densityTextureID);
+    glBindTexture(GL_TEXTURE_3D, densityTextureID);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_BASE_LEVEL, 0);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAX_LEVEL, lodLevelCount - 1);
+    
+    // 与打包纹理相同的mip层级，shader在每个LOD层级都采样原生精度密度
+    for (int level = 0; level < lodLevelCount; level++) {
+        glm::ivec3 size = GetLodLevelSize(level);
+        glTexImage3D(GL_TEXTURE_3D, level, internalFormat, size.x, size.y, size.z, 0, GL_RED, type, nullptr);
+    }
+    glBindTexture(GL_TEXTURE_3D, 0);
+    
+    lodNativeDensity.clear();
+    if (lodLevelCount > 1) {
+        glm::ivec3 size = GetLodLevelSize(1);
+        lodNativeDensity.resize((size_t)size.x * size.y * size.z * VolumeHeader::GetVoxelSize(voxelType));
+    }
+    
+    std::cout << "Created native density texture" << std::endl;
+    return true;
+}
+
+void VolumeData::UploadDensitySlices(const unsigned char* raw, int zBegin, int zEnd) {
+    GLenum internalFormat, type;
+    if (densityTextureID == 0 || !GetDensityFormat(voxelType, internalFormat, type)) {
+        return;
+    }
+    
+    glBindTexture(GL_TEXTURE_3D, densityTextureID);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage3D(GL_TEXTURE_3D, 0, 0, 0, zBegin, width, height, zEnd - zBegin, GL_RED, type, raw);
+    glBindTexture(GL_TEXTURE_3D, 0);
+    
+    // 第1层：源起点落在本块内的输出切片（zBegin为偶数，zEnd为偶数或体积末尾，见CreateFromSlabs）
+    if (lodNativeDensity.empty()) return;
+    glm::ivec3 dstSize = GetLodLevelSize(1);
+    int kBegin = zBegin / 2;
+    int kEnd = zEnd == depth ? dstSize.z : std::min(zEnd / 2, dstSize.z);
+    if (kBegin < kEnd) {
+        DownsampleNative(voxelType, raw, glm::ivec3(width, height, depth), lodNativeDensity.data(), dstSize,
+                         kBegin, kEnd, zBegin);
+    }
+}
+
+bool VolumeData::CreateDensityLodLevels() {
+    GLenum internalFormat, type;
+    if (densityTextureID == 0 || lodNativeDensity.empty() || !GetDensityFormat(voxelType, internalFormat, type)) {
+        return true;
+    }
+    
+    // 与8位LOD相同，每层由上一层盒式平均得到；打包纹理的同一层级也由该层原生值计算梯度和8位密度
+    const size_t voxelSize = VolumeHeader::GetVoxelSize(voxelType);
+    std::vector<unsigned char> levelDensity = std::move(lodNativeDensity);
+    lodNativeDensity.clear();
+    
+    std::vector<unsigned char> packed;
+    for (int level = 1; level < lodLevelCount; level++) {
+        glm::ivec3 size = GetLodLevelSize(level);
+        if (level > 1) {
+            std::vector<unsigned char> nextDensity((size_t)size.x * size.y * size.z * voxelSize);
+            DownsampleNative(voxelType, levelDensity.data(), GetLodLevelSize(level - 1), nextDensity.data(), size,
+                             0, size.z);
+            levelDensity.swap(nextDensity);
+        }
+        glBindTexture(GL_TEXTURE_3D, densityTextureID);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexSubImage3D(GL_TEXTURE_3D, level, 0, 0, 0, size.x, size.y, size.z, GL_RED, type, levelDensity.data());
+        glBindTexture(GL_TEXTURE_3D, 0);
+        
+        const uint64_t sliceBytes = (uint64_t)size.x * size.y * 4;
+        const int slabDepth = (int)std::min<uint64_t>(std::max<uint64_t>(1, UPLOAD_SLAB_BYTES / sliceBytes), size.z);
+        packed.resize((size_t)(sliceBytes * slabDepth));
+        for (int z0 = 0; z0 < size.z; z0 += slabDepth) {
+            int z1 = std::min(z0 + slabDepth, size.z);
+            VolumeGradient::ComputePackedNative(levelDensity.data(), voxelType, size.x, size.y, size.z, z0, z1,
+                                                gradientFilter, valueMin, valueMax, packed.data());
+            UploadSlices(z0, z1, packed.data(), level);
+        }
+    }
+    
+    std::cout << "Built LOD pyramid: " << lodLevelCount << " levels" << std::endl;
     return true;
 }
 
+glm::vec2 VolumeData::GetNativeDensityMapping() const {
+    // 归一化纹理采样值 -> 原始值的比例：R16为/65535，R16_SNORM为/32767，R32F为原值
+    float typeScale = 1.0f;
+    if (voxelType == VoxelType::UInt16) typeScale = 65535.0f;
+    if (voxelType == VoxelType::Int16) typeScale = 32767.0f;
+    
+    float range = valueMax > valueMin ? valueMax - valueMin : 1.0f;
+    return glm::vec2(typeScale / range, -valueMin / range);
+}
+
+glm::ivec3 VolumeData::GetLodLevelSize(int level) const {
+    return glm::ivec3(std::max(width >> level, 1), std::max(height >> level, 1), std::max(depth >> level, 1));
+}
+
+void VolumeData::AccumulateLod(const unsigned char* data, int zBegin, int zEnd, int dataZ) {
+    if (lodLevelCount < 2 || lodDensity.empty()) return;
+    
+    // 输出切片k的源范围从2k开始，源起点落在[zBegin, zEnd)内的输出切片由本块负责
+    glm::ivec3 dstSize = GetLodLevelSize(1);
+    int kBegin = (zBegin + 1) / 2;
+    int kEnd = std::min((zEnd + 1) / 2, dstSize.z);
+    if (kBegin >= kEnd) return;
+    
+    DownsampleSlices(data, glm::ivec3(width, height, depth), lodDensity.data(), dstSize, kBegin, kEnd, dataZ);
+}
+
+std::vector<unsigned char> VolumeData::TakeLodDensity() {
+    std::vector<unsigned char> density = std::move(lodDensity);
+    lodDensity.clear();
+    lodDensity.shrink_to_fit();
+    return density;
+}
+
+void VolumeData::DownsampleLodLevel(int level, const std::vector<unsigned char>& src,
+                                    std::vector<unsigned char>& dst) const {
+    glm::ivec3 size = GetLodLevelSize(level);
+    dst.resize((size_t)size.x * size.y * size.z);
+    DownsampleSlices(src.data(), GetLodLevelSize(level - 1), dst.data(), size, 0, size.z);
+}
+
+bool VolumeData::CreateLodLevels() {
+    if (lodLevelCount < 2) return true;
+    
+    // 每层由上一层的密度盒式平均得到，梯度在该层分辨率上重新计算，
+    // 而不是对打包梯度求平均（后者会在边界处抵消，法线变短变乱）
+    std::vector<unsigned char> levelDensity = TakeLodDensity();
+    std::vector<unsigned char> packed;
+    for (int level = 1; level < lodLevelCount; level++) {
+        if (level > 1) {
+            std::vector<unsigned char> nextDensity;
+            DownsampleLodLevel(level, levelDensity, nextDensity);
+            levelDensity.swap(nextDensity);
+        }
+        
+        glm::ivec3 size = GetLodLevelSize(level);
+        const uint64_t sliceBytes = (uint64_t)size.x * size.y * 4;
+        const int slabDepth = (int)std::min<uint64_t>(std::max<uint64_t>(1, UPLOAD_SLAB_BYTES / sliceBytes), size.z);
+        packed.resize((size_t)(sliceBytes * slabDepth));
+        for (int z0 = 0; z0 < size.z; z0 += slabDepth) {
+            int z1 = std::min(z0 + slabDepth, size.z);
+            VolumeGradient::ComputePacked(levelDensity.data(), size.x, size.y, size.z, z0, z1, gradientFilter,
+                                          packed.data());
+            UploadSlices(z0, z1, packed.data(), level);
+        }
+    }
+    
+    std::cout << "Built LOD pyramid: " << lodLevelCount << " levels" << std::endl;
+    return true;
+}
+
+void VolumeData::ResetMacrocellGrid() {
+    const int B = MACROCELL_SIZE;
+    macrocellGridSize = glm::ivec3((width + B - 1) / B, (height + B - 1) / B, (depth + B - 1) / B);
+    size_t cellCount = (size_t)macrocellGridSize.x * macrocellGridSize.y * macrocellGridSize.z;
+    
+    // 交错存储 (min, max)，初始为空区间
+    macrocellMinMax.resize(cellCount * 2);
+    for (size_t cell = 0; cell < cellCount; cell++) {
+        macrocellMinMax[cell * 2 + 0] = std::numeric_limits<float>::max();
+        macrocellMinMax[cell * 2 + 1] = std::numeric_limits<float>::lowest();
+    }
+}
+
+void VolumeData::AccumulateMacrocells(const unsigned char* data, int zBegin, int zEnd, int dataZ) {
+    const glm::ivec3 size(width, height, depth);
+    const float scale = valueMax > valueMin ? 1.0f / (valueMax - valueMin) : 0.0f;
+    float* minMax = macrocellMinMax.data();
+    switch (voxelType) {
+        case VoxelType::UInt8:
+            AccumulateMacrocellRange(data, size, macrocellGridSize, minMax, zBegin, zEnd, dataZ, valueMin, scale);
+            break;
+        case VoxelType::Int16:
+            AccumulateMacrocellRange(reinterpret_cast<const int16_t*>(data), size, macrocellGridSize, minMax,
+                                     zBegin, zEnd, dataZ, valueMin, scale);
+            break;
+        case VoxelType::UInt16:
+            AccumulateMacrocellRange(reinterpret_cast<const uint16_t*>(data), size, macrocellGridSize, minMax,
+                                     zBegin, zEnd, dataZ, valueMin, scale);
+            break;
+        case VoxelType::Float32:
+            AccumulateMacrocellRange(reinterpret_cast<const float*>(data), size, macrocellGridSize, minMax,
+                                     zBegin, zEnd, dataZ, valueMin, scale);
+            break;
+    }
+}
+
+template <typename T>
+void VolumeData::AccumulateMacrocellRange(const T* data, const glm::ivec3& size, const glm::ivec3& grid,
+                                          float* minMax, int zBegin, int zEnd, int dataZ, float valueMin, float scale) {
+    const int B = MACROCELL_SIZE;
+    const int width = size.x, height = size.y, depth = size.z;
+    
+    // 三线性插值会读取单元边界外一个体素，因此每个单元的范围向两侧各扩展一个体素
+    for (int cz = 0; cz < grid.z; cz++) {
+        int z0 = std::max(std::max(cz * B - 1, 0), zBegin);
+        int z1 = std::min(std::min((cz + 1) * B, depth - 1), zEnd - 1);
+        if (z0 > z1) continue;
+        
+        for (int cy = 0; cy < grid.y; cy++) {
+            int y0 = std::max(cy * B - 1, 0), y1 = std::min((cy + 1) * B, height - 1);
+            for (int cx = 0; cx < grid.x; cx++) {
+                int x0 = std::max(cx * B - 1, 0), x1 = std::min((cx + 1) * B, width - 1);
+                
+                // 先统计原始值范围（跳过非有限值），再归一化到[0, 1]与已有范围合并
+                T minValue = std::numeric_limits<T>::max();
+                T maxValue = std::numeric_limits<T>::lowest();
+                for (int z = z0; z <= z1; z++) {
+                    for (int y = y0; y <= y1; y++) {
+                        const T* row = &data[((size_t)(z - dataZ) * height + y) * width];
+                        for (int x = x0; x <= x1; x++) {
+                            T v = row[x];
+                            if (!std::numeric_limits<T>::is_integer && !std::isfinite((float)v)) continue;
+                            minValue = std::min(minValue, v);
+                            maxValue = std::max(maxValue, v);
+                        }
+                    }
+                }
+                if (minValue > maxValue) continue;
+                
+                size_t cell = ((size_t)cz * grid.y + cy) * grid.x + cx;
+                minMax[cell * 2 + 0] = std::min(minMax[cell * 2 + 0], ((float)minValue - valueMin) * scale);
+                minMax[cell * 2 + 1] = std::max(minMax[cell * 2 + 1], ((float)maxValue - valueMin) * scale);
+            }
+        }
+    }
+}
+
+bool VolumeData::CreateMacrocellTexture() {
+    size_t cellCount = macrocellMinMax.size() / 2;
+    
+    // 占用纹理使用最近邻采样，内容由ClassifyMacrocells填充（默认全部非空）
+    if (macrocellTextureID == 0) {
+        glGenTextures(1, &macrocellTextureID);
+    }
+    macrocellOccupancy.assign(cellCount, 255);
+    glBindTexture(GL_TEXTURE_3D, macrocellTextureID);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage3D(GL_TEXTURE_3D, 0, GL_R8, macrocellGridSize.x, macrocellGridSize.y, macrocellGridSize.z,
+                 0, GL_RED, GL_UNSIGNED_BYTE, macrocellOccupancy.data());
+    glBindTexture(GL_TEXTURE_3D, 0);
+    
+    std::cout << "Built macrocell grid: " << macrocellGridSize.x << "x" << macrocellGridSize.y
+              << "x" << macrocellGridSize.z << std::endl;
+    return true;
+}
+
+void VolumeData::ClassifyMacrocells(float threshold, float density, float windowWidth, float windowCenter,
+                                    const std::vector<glm::vec4>& transferFunction) {
+    if (macrocellTextureID == 0 || transferFunction.empty()) return;
+    
+    // 传输函数不透明度非零项的前缀计数，用于O(1)判断一段值域内是否全透明
+    const int tfSize = (int)transferFunction.size();
+    std::vector<int> opaquePrefix(tfSize + 1, 0);
+    for (int i = 0; i < tfSize; i++) {
+        opaquePrefix[i + 1] = opaquePrefix[i] + (transferFunction[i].a > 0.0f ? 1 : 0);
+    }
+    
+    // 窗宽/窗位映射与shader一致且单调，区间端点直接映射即可
+    const glm::vec2 windowMapping = VolumeGeometry::GetWindowMapping(windowWidth, windowCenter);
+    auto applyWindow = [&](float value) {
+        return std::max(0.0f, std::min(1.0f, value * windowMapping.x + windowMapping.y));
+    };
+    
+    size_t cellCount = macrocellMinMax.size() / 2;
+    macrocellOccupancy.resize(cellCount);
+    for (size_t cell = 0; cell < cellCount; cell++) {
+        float lo = applyWindow(macrocellMinMax[cell * 2 + 0]) * density;
+        float hi = applyWindow(macrocellMinMax[cell * 2 + 1]) * density;
+        
+        // 与shader一致：只有 densityValue > threshold 的采样才会被合成
+        bool occupied = hi > threshold;
+        if (occupied) {
+            // 线性过滤的1D纹理会读取相邻两个texel
+            lo = std::max(lo, threshold);
+            int i0 = (int)std::floor(lo * tfSize - 0.5f);
+            int i1 = (int)std::floor(hi * tfSize - 0.5f) + 1;
+            i0 = std::max(0, std::min(i0, tfSize - 1));
+            i1 = std::max(0, std::min(i1, tfSize - 1));
+            occupied = opaquePrefix[i1 + 1] - opaquePrefix[i0] > 0;
+        }
+        
+        macrocellOccupancy[cell] = occupied ? 255 : 0;
+    }
+    
+    glBindTexture(GL_TEXTURE_3D, macrocellTextureID);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage3D(GL_TEXTURE_3D, 0, 0, 0, 0, macrocellGridSize.x, macrocellGridSize.y, macrocellGridSize.z,
+                    GL_RED, GL_UNSIGNED_BYTE, macrocellOccupancy.data());
+    glBindTexture(GL_TEXTURE_3D, 0);
+}
+
 void VolumeData::Bind(GLuint textureUnit) const {
     glActiveTexture(GL_TEXTURE0 + textureUnit);
     glBindTexture(GL_TEXTURE_3D, textureID);
 }
+
+void VolumeData::BindMacrocells(GLuint textureUnit) const {
+    glActiveTexture(GL_TEXTURE0 + textureUnit);
+    glBindTexture(GL_TEXTURE_3D, macrocellTextureID);
+}
+
+void VolumeData::BindDensity(GLuint textureUnit) const {
+    glActiveTexture(GL_TEXTURE0 + textureUnit);
+    glBindTexture(GL_TEXTURE_3D, densityTextureID);
+}
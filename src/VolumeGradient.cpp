@@ -0,0 +1,133 @@
+#include "VolumeGradient.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+namespace {
+    // 钳制到边界的体素读取（与GL_CLAMP_TO_EDGE一致），浮点数据的非有限值按fill读取
+    template <typename T>
+    struct VolumeView {
+        const T* data;
+        int width, height, depth;
+        float fill;
+        
+        float operator()(int x, int y, int z) const {
+            x = std::max(0, std::min(x, width - 1));
+            y = std::max(0, std::min(y, height - 1));
+            z = std::max(0, std::min(z, depth - 1));
+            float v = (float)data[((size_t)z * height + y) * width + x];
+            return std::numeric_limits<T>::is_integer || std::isfinite(v) ? v : fill;
+        }
+    };
+    
+    // 中心差分：v[+1] - v[-1]，计算一行中[x0, x0+count)的体素
+    template <typename T>
+    void CentralDifferenceRow(const VolumeView<T>& voxel, int x0, int count, int y, int z,
+                              float* gx, float* gy, float* gz) {
+        for (int i = 0; i < count; i++) {
+            int x = x0 + i;
+            gx[i] = voxel(x + 1, y, z) - voxel(x - 1, y, z);
+            gy[i] = voxel(x, y + 1, z) - voxel(x, y - 1, z);
+            gz[i] = voxel(x, y, z + 1) - voxel(x, y, z - 1);
+        }
+    }
+    
+    // Sobel：沿求导轴做差分，另外两轴做归一化的[1,2,1]/4平滑，保持与中心差分相同的取值范围
+    template <typename T>
+    void SobelRow(const VolumeView<T>& voxel, int x0, int count, int y, int z, float* gx, float* gy, float* gz) {
+        static const float smooth[3] = { 0.25f, 0.5f, 0.25f };
+        for (int n = 0; n < count; n++) {
+            int x = x0 + n;
+            float sx = 0.0f, sy = 0.0f, sz = 0.0f;
+            for (int j = -1; j <= 1; j++) {
+                for (int i = -1; i <= 1; i++) {
+                    float w = smooth[i + 1] * smooth[j + 1];
+                    sx += w * (voxel(x + 1, y + i, z + j) - voxel(x - 1, y + i, z + j));
+                    sy += w * (voxel(x + i, y + 1, z + j) - voxel(x + i, y - 1, z + j));
+                    sz += w * (voxel(x + i, y + j, z + 1) - voxel(x + i, y + j, z - 1));
+                }
+            }
+            gx[n] = sx;
+            gy[n] = sy;
+            gz[n] = sz;
+        }
+    }
+    
+    // 打包一个区域：梯度方向由原始值计算（归一化后与数值单位无关），
+    // a = (v - valueMin) * densityScale 四舍五入并钳制到[0, 255]（8位数据为valueMin = 0、densityScale = 1）
+    template <typename T>
+    void PackRegion(const T* data, int width, int height, int depth, int x0, int y0, int z0,
+                    int sizeX, int sizeY, int sizeZ, GradientFilter filter, float valueMin, float densityScale,
+                    unsigned char* packed) {
+        const VolumeView<T> voxel = { data, width, height, depth, valueMin };
+        std::vector<float> gx(sizeX), gy(sizeX), gz(sizeX);
+        unsigned char* out = packed;
+        
+        for (int z = z0; z < z0 + sizeZ; z++) {
+            for (int y = y0; y < y0 + sizeY; y++) {
+                if (filter == GradientFilter::Sobel) {
+                    SobelRow(voxel, x0, sizeX, y, z, gx.data(), gy.data(), gz.data());
+                } else {
+                    CentralDifferenceRow(voxel, x0, sizeX, y, z, gx.data(), gy.data(), gz.data());
+                }
+                
+                for (int i = 0; i < sizeX; i++) {
+                    VolumeGradient::EncodeDirection(gx[i], gy[i], gz[i], out);
+                    float density = (voxel(x0 + i, y, z) - valueMin) * densityScale + 0.5f;
+                    out[3] = (unsigned char)std::max(0.0f, std::min(255.0f, density));
+                    out += 4;
+                }
+            }
+        }
+    }
+    
+    template <typename T>
+    void PackSlices(const unsigned char* data, int width, int height, int depth, int zBegin, int zEnd,
+                    GradientFilter filter, float valueMin, float densityScale, unsigned char* packed, ThreadPool& pool) {
+        pool.ParallelFor(zBegin, zEnd, [&](int z) {
+            unsigned char* out = packed + (size_t)(z - zBegin) * width * height * 4;
+            PackRegion(reinterpret_cast<const T*>(data), width, height, depth, 0, 0, z, width, height, 1, filter,
+                       valueMin, densityScale, out);
+        });
+    }
+}
+
+void VolumeGradient::ComputePacked(const unsigned char* data, int width, int height, int depth,
+                                   int zBegin, int zEnd, GradientFilter filter, unsigned char* packed,
+                                   ThreadPool& pool) {
+    PackSlices<uint8_t>(data, width, height, depth, zBegin, zEnd, filter, 0.0f, 1.0f, packed, pool);
+}
+
+void VolumeGradient::ComputePackedNative(const unsigned char* data, VoxelType type, int width, int height, int depth,
+                                         int zBegin, int zEnd, GradientFilter filter, float valueMin, float valueMax,
+                                         unsigned char* packed, ThreadPool& pool) {
+    const float densityScale = valueMax > valueMin ? 255.0f / (valueMax - valueMin) : 0.0f;
+    switch (type) {
+        case VoxelType::UInt8:
+            PackSlices<uint8_t>(data, width, height, depth, zBegin, zEnd, filter, valueMin, densityScale, packed, pool);
+            break;
+        case VoxelType::Int16:
+            PackSlices<int16_t>(data, width, height, depth, zBegin, zEnd, filter, valueMin, densityScale, packed, pool);
+            break;
+        case VoxelType::UInt16:
+            PackSlices<uint16_t>(data, width, height, depth, zBegin, zEnd, filter, valueMin, densityScale, packed, pool);
+            break;
+        case VoxelType::Float32:
+            PackSlices<float>(data, width, height, depth, zBegin, zEnd, filter, valueMin, densityScale, packed, pool);
+            break;
+    }
+}
+
+void VolumeGradient::ComputePackedRegion(const unsigned char* data, int width, int height, int depth,
+                                         int x0, int y0, int z0, int sizeX, int sizeY, int sizeZ,
+                                         GradientFilter filter, unsigned char* packed) {
+    PackRegion(data, width, height, depth, x0, y0, z0, sizeX, sizeY, sizeZ, filter, 0.0f, 1.0f, packed);
+}
+
+std::vector<unsigned char> VolumeGradient::ComputePacked(const unsigned char* data, int width, int height, int depth,
+                                                         GradientFilter filter, ThreadPool& pool) {
+    std::vector<unsigned char> packed((size_t)width * height * depth * 4);
+    ComputePacked(data, width, height, depth, 0, depth, filter, packed.data(), pool);
+    return packed;
+}
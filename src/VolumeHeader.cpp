@@ -0,0 +1,335 @@
+#include "VolumeHeader.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+std::string ToLower(std::string s) {
+    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+    return s;
+}
+
+std::string Trim(const std::string& s) {
+    size_t begin = s.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos) return "";
+    size_t end = s.find_last_not_of(" \t\r\n");
+    return s.substr(begin, end - begin + 1);
+}
+
+std::string GetExtension(const std::string& filename) {
+    size_t dot = filename.find_last_of('.');
+    size_t slash = filename.find_last_of("/\\");
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) return "";
+    return ToLower(filename.substr(dot + 1));
+}
+
+// 数据文件路径相对于头文件所在目录
+std::string ResolveDataPath(const std::string& headerFile, const std::string& dataFile) {
+    bool absolute = !dataFile.empty() &&
+        (dataFile[0] == '/' || dataFile[0] == '\\' || (dataFile.size() > 1 && dataFile[1] == ':'));
+    if (absolute) return dataFile;
+    size_t slash = headerFile.find_last_of("/\\");
+    if (slash == std::string::npos) return dataFile;
+    return headerFile.substr(0, slash + 1) + dataFile;
+}
+
+// 读取一行并去掉行尾的\r（兼容Windows换行）
+bool ReadHeaderLine(std::ifstream& file, std::string& line) {
+    if (!std::getline(file, line)) return false;
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+    return true;
+}
+
+bool ParseInts(const std::string& value, int* out, int count) {
+    std::istringstream stream(value);
+    for (int i = 0; i < count; i++) {
+        if (!(stream >> out[i])) return false;
+    }
+    return true;
+}
+
+bool ParseFloats(const std::string& value, float* out, int count) {
+    std::istringstream stream(value);
+    for (int i = 0; i < count; i++) {
+        if (!(stream >> out[i])) return false;
+    }
+    return true;
+}
+
+bool ParseNrrdType(const std::string& name, VoxelType& type) {
+    std::string t = ToLower(name);
+    if (t == "uchar" || t == "unsigned char" || t == "uint8" || t == "uint8_t") {
+        type = VoxelType::UInt8;
+    } else if (t == "short" || t == "short int" || t == "signed short" || t == "signed short int" ||
+               t == "int16" || t == "int16_t") {
+        type = VoxelType::Int16;
+    } else if (t == "ushort" || t == "unsigned short" || t == "unsigned short int" ||
+               t == "uint16" || t == "uint16_t") {
+        type = VoxelType::UInt16;
+    } else if (t == "float") {
+        type = VoxelType::Float32;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool ParseMetaType(const std::string& name, VoxelType& type) {
+    if (name == "MET_UCHAR") {
+        type = VoxelType::UInt8;
+    } else if (name == "MET_SHORT") {
+        type = VoxelType::Int16;
+    } else if (name == "MET_USHORT") {
+        type = VoxelType::UInt16;
+    } else if (name == "MET_FLOAT") {
+        type = VoxelType::Float32;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool ValidateInfo(const std::string& filename, const VolumeFileInfo& info) {
+    if (info.width <= 0 || info.height <= 0 || info.depth <= 0) {
+        std::cerr << "Volume header has invalid sizes: " << filename << std::endl;
+        return false;
+    }
+    if (info.dataFile.empty()) {
+        std::cerr << "Volume header does not specify a data file: " << filename << std::endl;
+        return false;
+    }
+    if (!(info.spacing.x > 0.0f && info.spacing.y > 0.0f && info.spacing.z > 0.0f)) {
+        std::cerr << "Volume header has invalid spacing: " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+bool VolumeHeader::IsHeaderFile(const std::string& filename) {
+    std::string ext = GetExtension(filename);
+    return ext == "nrrd" || ext == "nhdr" || ext == "mhd" || ext == "mha";
+}
+
+bool VolumeHeader::Parse(const std::string& filename, VolumeFileInfo& info) {
+    std::string ext = GetExtension(filename);
+    if (ext == "nrrd" || ext == "nhdr") {
+        return ParseNrrd(filename, info);
+    }
+    if (ext == "mhd" || ext == "mha") {
+        return ParseMetaImage(filename, info);
+    }
+    std::cerr << "Unknown volume header format: " << filename << std::endl;
+    return false;
+}
+
+bool VolumeHeader::ParseNrrd(const std::string& filename, VolumeFileInfo& info) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open NRRD header: " << filename << std::endl;
+        return false;
+    }
+    
+    std::string line;
+    if (!ReadHeaderLine(file, line) || line.compare(0, 4, "NRRD") != 0) {
+        std::cerr << "Not a NRRD file: " << filename << std::endl;
+        return false;
+    }
+    
+    info = VolumeFileInfo();
+    int dimension = 0;
+    int64_t byteSkip = 0;
+    bool detached = false;
+    
+    // 字段格式为 "name: value"，空行（或文件结尾）表示头结束，附带数据紧随其后
+    while (ReadHeaderLine(file, line) && !line.empty()) {
+        if (line[0] == '#') continue;
+        // "key:=value" 为键值对注释，忽略
+        size_t colon = line.find(": ");
+        size_t keyValue = line.find(":=");
+        if (colon == std::string::npos || (keyValue != std::string::npos && keyValue < colon)) continue;
+        
+        std::string key = ToLower(Trim(line.substr(0, colon)));
+        std::string value = Trim(line.substr(colon + 2));
+        
+        if (key == "type") {
+            if (!ParseNrrdType(value, info.type)) {
+                std::cerr << "Unsupported NRRD type '" << value << "': " << filename << std::endl;
+                return false;
+            }
+        } else if (key == "dimension") {
+            dimension = std::atoi(value.c_str());
+        } else if (key == "sizes") {
+            int sizes[3];
+            if (!ParseInts(value, sizes, 3)) return false;
+            info.width = sizes[0];
+            info.height = sizes[1];
+            info.depth = sizes[2];
+        } else if (key == "spacings") {
+            float spacings[3];
+            if (ParseFloats(value, spacings, 3)) {
+                info.spacing = glm::vec3(spacings[0], spacings[1], spacings[2]);
+            }
+        } else if (key == "space directions") {
+            // "(x,y,z) (x,y,z) (x,y,z)"：间距为各方向向量的长度
+            std::string numbers = value;
+            std::replace_if(numbers.begin(), numbers.end(),
+                            [](char c) { return c == '(' || c == ')' || c == ','; }, ' ');
+            float v[9];
+            if (ParseFloats(numbers, v, 9)) {
+                info.spacing = glm::vec3(std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]),
+                                         std::sqrt(v[3] * v[3] + v[4] * v[4] + v[5] * v[5]),
+                                         std::sqrt(v[6] * v[6] + v[7] * v[7] + v[8] * v[8]));
+            }
+        } else if (key == "endian") {
+            info.bigEndian = ToLower(value) == "big";
+        } else if (key == "encoding") {
+            if (ToLower(value) != "raw") {
+                std::cerr << "Unsupported NRRD encoding '" << value << "' (only raw): " << filename << std::endl;
+                return false;
+            }
+        } else if (key == "byte skip") {
+            byteSkip = std::atoll(value.c_str());
+        } else if (key == "line skip") {
+            if (std::atoi(value.c_str()) != 0) {
+                std::cerr << "NRRD line skip is not supported: " << filename << std::endl;
+                return false;
+            }
+        } else if (key == "data file" || key == "datafile") {
+            if (value.compare(0, 4, "LIST") == 0 || value.find('%') != std::string::npos) {
+                std::cerr << "Multi-file NRRD data is not supported: " << filename << std::endl;
+                return false;
+            }
+            info.dataFile = ResolveDataPath(filename, value);
+            detached = true;
+        }
+    }
+    
+    if (dimension != 3) {
+        std::cerr << "Only 3D NRRD volumes are supported (dimension " << dimension << "): " << filename << std::endl;
+        return false;
+    }
+    
+    if (!detached) {
+        info.dataFile = filename;
+        file.clear();
+        info.dataOffset = (uint64_t)file.tellg();
+    }
+    if (byteSkip == -1) {
+        info.offsetFromEnd = true;
+    } else if (byteSkip > 0) {
+        info.dataOffset += (uint64_t)byteSkip;
+    }
+    
+    return ValidateInfo(filename, info);
+}
+
+bool VolumeHeader::ParseMetaImage(const std::string& filename, VolumeFileInfo& info) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open MetaImage header: " << filename << std::endl;
+        return false;
+    }
+    
+    info = VolumeFileInfo();
+    int dims = 0;
+    int64_t headerSize = 0;
+    bool hasElementSpacing = false;
+    bool foundDataFile = false;
+    
+    // 字段格式为 "Key = Value"，ElementDataFile必须是最后一个字段
+    std::string line;
+    while (ReadHeaderLine(file, line)) {
+        size_t equals = line.find('=');
+        if (equals == std::string::npos) continue;
+        
+        std::string key = Trim(line.substr(0, equals));
+        std::string value = Trim(line.substr(equals + 1));
+        
+        if (key == "NDims") {
+            dims = std::atoi(value.c_str());
+        } else if (key == "DimSize") {
+            int sizes[3];
+            if (!ParseInts(value, sizes, 3)) return false;
+            info.width = sizes[0];
+            info.height = sizes[1];
+            info.depth = sizes[2];
+        } else if (key == "ElementSpacing" || (key == "ElementSize" && !hasElementSpacing)) {
+            float spacings[3];
+            if (ParseFloats(value, spacings, 3)) {
+                info.spacing = glm::vec3(spacings[0], spacings[1], spacings[2]);
+                hasElementSpacing = hasElementSpacing || key == "ElementSpacing";
+            }
+        } else if (key == "ElementType") {
+            if (!ParseMetaType(value, info.type)) {
+                std::cerr << "Unsupported MetaImage element type '" << value << "': " << filename << std::endl;
+                return false;
+            }
+        } else if (key == "ElementByteOrderMSB" || key == "BinaryDataByteOrderMSB") {
+            info.bigEndian = ToLower(value) == "true";
+        } else if (key == "CompressedData") {
+            if (ToLower(value) == "true") {
+                std::cerr << "Compressed MetaImage data is not supported: " << filename << std::endl;
+                return false;
+            }
+        } else if (key == "ElementNumberOfChannels") {
+            if (std::atoi(value.c_str()) != 1) {
+                std::cerr << "Only single-channel MetaImage volumes are supported: " << filename << std::endl;
+                return false;
+            }
+        } else if (key == "HeaderSize") {
+            headerSize = std::atoll(value.c_str());
+        } else if (key == "ElementDataFile") {
+            if (value == "LOCAL") {
+                info.dataFile = filename;
+                file.clear();
+                info.dataOffset = (uint64_t)file.tellg();
+            } else if (value.compare(0, 4, "LIST") == 0 || value.find('%') != std::string::npos) {
+                std::cerr << "Multi-file MetaImage data is not supported: " << filename << std::endl;
+                return false;
+            } else {
+                info.dataFile = ResolveDataPath(filename, value);
+            }
+            foundDataFile = true;
+            break;
+        }
+    }
+    
+    if (dims != 3) {
+        std::cerr << "Only 3D MetaImage volumes are supported (NDims " << dims << "): " << filename << std::endl;
+        return false;
+    }
+    if (!foundDataFile) {
+        std::cerr << "MetaImage header is missing ElementDataFile: " << filename << std::endl;
+        return false;
+    }
+    
+    if (headerSize == -1) {
+        info.offsetFromEnd = true;
+    } else if (headerSize > 0) {
+        info.dataOffset += (uint64_t)headerSize;
+    }
+    
+    return ValidateInfo(filename, info);
+}
+
+size_t VolumeHeader::GetVoxelSize(VoxelType type) {
+    switch (type) {
+        case VoxelType::UInt8:   return 1;
+        case VoxelType::Int16:   return 2;
+        case VoxelType::UInt16:  return 2;
+        case VoxelType::Float32: return 4;
+    }
+    return 1;
+}
+
+bool VolumeHeader::IsHostBigEndian() {
+    const uint16_t probe = 1;
+    return *reinterpret_cast<const unsigned char*>(&probe) == 0;
+}
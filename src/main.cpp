@@ -1,9 +1,12 @@
 #include "Renderer.h"
+#include "CameraPath.h"
+#include "SequenceRenderer.h"
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
 #include <imgui.h>
 #include <imgui_impl_glfw.h>
 #include <imgui_impl_opengl3.h>
+#include <algorithm>
 #include <iostream>
 
 // 全局变量
@@ -13,6 +16,18 @@ bool g_firstMouse = true;
 float g_lastX = 400.0f;
 float g_lastY = 300.0f;
 bool g_mousePressed = false;
+int g_frameRateCap = 0;          // 帧率上限（0 = 不限制）
+bool g_recordingPath = false;    // 正在录制摄像机路径（每个渲染帧记录一次，供基准测试回放）
+CameraPath g_cameraPath;
+
+// 离线序列渲染：界面中请求，在下一次主循环迭代（界面绘制结束后）执行
+bool g_sequenceRequested = false;
+bool g_sequenceUseRecordedPath = false;   // 使用camera_path.txt，否则为环绕路径
+int g_sequenceOrbitFrames = 120;
+SequenceSettings g_sequenceSettings;
+
+// 从等待中唤醒后至少再渲染的帧数：ImGui响应一次输入可能需要两帧才能显示结果
+const int FRAMES_AFTER_EVENT = 2;
 
 // GLFW回调函数
 void framebuffer_size_callback(GLFWwindow* window, int width, int height) {
@@ -86,11 +101,15 @@ bool InitGLFW() {
         return false;
     }
     
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    // 优先创建4.3核心上下文（计算shader光线步进路径），不支持时退回3.3
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-    
-    g_window = glfwCreateWindow(1280, 720, "Volume Renderer - Ray Marching", nullptr, nullptr);
+    const int versions[][2] = { { 4, 3 }, { 3, 3 } };
+    for (const auto& version : versions) {
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, version[0]);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, version[1]);
+        g_window = glfwCreateWindow(1280, 720, "Volume Renderer - Ray Marching", nullptr, nullptr);
+        if (g_window) break;
+    }
     if (!g_window) {
         std::cerr << "Failed to create GLFW window" << std::endl;
         glfwTerminate();
@@ -126,6 +145,16 @@ void InitImGui() {
     ImGui_ImplOpenGL3_Init("#version 330");
 }
 
+// 附加通道的单色传输函数：颜色不变，不透明度随密度线性增加
+std::vector<glm::vec4> ChannelTransferFunction(const glm::vec3& color) {
+    const int tfSize = 256;
+    std::vector<glm::vec4> colors(tfSize);
+    for (int i = 0; i < tfSize; i++) {
+        colors[i] = glm::vec4(color, (float)i / (tfSize - 1));
+    }
+    return colors;
+}
+
 void RenderImGui(RenderParams& params) {
     ImGui_ImplOpenGL3_NewFrame();
     ImGui_ImplGlfw_NewFrame();
@@ -138,6 +167,38 @@ void RenderImGui(RenderParams& params) {
     RenderStats stats = g_renderer->GetRenderStats();
     ImGui::Text("FPS: %.1f", stats.fps);
     ImGui::Text("Frame Time: %.2f ms", stats.frameTimeMs);
+    ImGui::Text("GPU Time: %.2f ms", stats.gpuTimeMs);
+    ImGui::Text("Resolution Scale: %.2f", stats.resolutionScale);
+    ImGui::Text("Accumulated Frames: %d", stats.accumulatedFrames);
+    ImGui::Text("Idle: %s", stats.cachedFrame ? "yes (cached frame)" : "no");
+    ImGui::Text("Shader: %s %s (%d variants)", stats.computeRayMarching ? "compute" : "fragment",
+                stats.specializedShader ? "specialized" : "generic", stats.shaderVariants);
+    if (stats.proxyTriangles > 0) {
+        ImGui::Text("Proxy Triangles: %d", stats.proxyTriangles);
+    }
+    ImGui::Text("Frame Time p50/p95/p99: %.2f / %.2f / %.2f ms", stats.frameTime.p50, stats.frameTime.p95, stats.frameTime.p99);
+    if (ImGui::TreeNode("GPU Passes (p50 / p95 / p99 ms)")) {
+        for (int i = 0; i < FrameProfiler::PASS_COUNT; i++) {
+            const TimingPercentiles& pass = stats.passTime[i];
+            ImGui::Text("%-10s %.2f / %.2f / %.2f", FrameProfiler::GetPassName((GpuPass)i), pass.p50, pass.p95, pass.p99);
+        }
+        ImGui::TreePop();
+    }
+    ImGui::Text("Samples/Ray: %.1f avg, %d max (%.1f steps)", stats.samplesPerRay, stats.maxSamplesPerRay, stats.stepsPerRay);
+    if (ImGui::Button("Dump Timings CSV")) {
+        g_renderer->WriteTimingCsv("frame_timings.csv");
+    }
+    ImGui::SameLine();
+    if (ImGui::Button(g_recordingPath ? "Stop Recording" : "Record Camera Path")) {
+        if (g_recordingPath && g_cameraPath.Save("camera_path.txt")) {
+            std::cout << "Saved " << g_cameraPath.GetKeyframeCount() << " camera keyframes to camera_path.txt" << std::endl;
+        }
+        g_recordingPath = !g_recordingPath;
+        g_cameraPath.Clear();
+    }
+    if (stats.residentBricks > 0) {
+        ImGui::Text("Resident Bricks: %d", stats.residentBricks);
+    }
     
     ImGui::Separator();
     ImGui::Text("Ray Marching Parameters");
@@ -156,6 +217,172 @@ void RenderImGui(RenderParams& params) {
     ImGui::Separator();
     ImGui::Text("Optimizations");
     ImGui::Checkbox("Enable Jittering", &params.enableJittering);
+    ImGui::Checkbox("Empty Space Skipping", &params.enableEmptySpaceSkipping);
+    ImGui::Checkbox("Proxy Geometry", &params.enableProxyGeometry);
+    ImGui::Checkbox("Pre-Integrated TF", &params.enablePreIntegration);
+    ImGui::Checkbox("Enable LOD", &params.enableLod);
+    ImGui::SliderFloat("LOD Bias", &params.lodBias, -1.0f, 3.0f);
+    ImGui::SliderFloat("Motion LOD Bias", &params.motionLodBias, 0.0f, 3.0f);
+    ImGui::Checkbox("Dynamic Resolution", &params.enableDynamicResolution);
+    ImGui::SliderFloat("Target GPU Time (ms)", &params.targetFrameTimeMs, 4.0f, 50.0f);
+    ImGui::SliderFloat("Min Resolution Scale", &params.minResolutionScale, 0.1f, 1.0f);
+    ImGui::Checkbox("Temporal Accumulation", &params.enableTemporalAccumulation);
+    ImGui::SliderInt("Max Accumulated Frames", &params.temporalMaxSamples, 1, 256);
+    ImGui::SliderInt("Frame Rate Cap (0 = off)", &g_frameRateCap, 0, 240);
+    if (g_renderer->SupportsComputeRayMarching()) {
+        ImGui::Checkbox("Compute Ray Marching", &params.enableComputeRayMarching);
+    } else {
+        ImGui::TextDisabled("Compute Ray Marching (requires OpenGL 4.3)");
+    }
+    
+    ImGui::Separator();
+    ImGui::Text("Window / Level");
+    ImGui::SliderFloat("Window Width", &params.windowWidth, 0.01f, 2.0f);
+    ImGui::SliderFloat("Window Center", &params.windowCenter, -0.5f, 1.5f);
+    if (const VolumeData* volume = g_renderer->GetVolumeData()) {
+        // 归一化窗宽/窗位换算回数据值
+        float range = volume->GetValueMax() - volume->GetValueMin();
+        ImGui::Text("W %.1f / L %.1f (data range %.1f .. %.1f)",
+                    params.windowWidth * range, volume->GetValueMin() + params.windowCenter * range,
+                    volume->GetValueMin(), volume->GetValueMax());
+    }
+    
+    ImGui::Separator();
+    ImGui::Text("Volume Data");
+    static char volumePath[256] = "data/volume.raw";
+    static int volumeSize[3] = { 256, 256, 256 };
+    ImGui::InputText("File", volumePath, sizeof(volumePath));
+    ImGui::InputInt3("Dimensions", volumeSize);
+    if (ImGui::Button("Load (Header)")) {
+        // NRRD/MetaImage：尺寸和类型取自文件头
+        g_renderer->LoadVolumeData(volumePath);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Load (Async)")) {
+        g_renderer->LoadVolumeDataAsync(volumePath, volumeSize[0], volumeSize[1], volumeSize[2]);
+    }
+    ImGui::SameLine();
+    if (ImGui::Button("Load (Bricked)")) {
+        g_renderer->LoadVolumeDataBricked(volumePath, volumeSize[0], volumeSize[1], volumeSize[2]);
+    }
+    if (g_renderer->IsLoadingVolume()) {
+        ImGui::ProgressBar(g_renderer->GetLoadProgress());
+    }
+    
+    ImGui::Separator();
+    ImGui::Text("Time Series");
+    static char seriesPattern[256] = "data/step_%04d.raw";
+    static int seriesRange[2] = { 0, 100 };       // 首个文件序号、步数（尺寸同上方Dimensions）
+    static int seriesBudgetMb = 1024;
+    ImGui::InputText("Pattern", seriesPattern, sizeof(seriesPattern));
+    ImGui::InputInt2("First / Steps", seriesRange);
+    ImGui::InputInt("RAM Budget (MB)", &seriesBudgetMb);
+    if (ImGui::Button("Open Series")) {
+        g_renderer->LoadTimeSeries(seriesPattern, seriesRange[0], seriesRange[1], volumeSize[0], volumeSize[1],
+                                   volumeSize[2], (uint64_t)std::max(seriesBudgetMb, 1) * 1024 * 1024);
+    }
+    if (TimeSeriesVolume* series = g_renderer->GetTimeSeries()) {
+        ImGui::SameLine();
+        if (ImGui::Button(series->IsPlaying() ? "Pause" : "Play")) {
+            series->SetPlaying(!series->IsPlaying());
+        }
+        float rate = series->GetRate();
+        if (ImGui::SliderFloat("Steps/s", &rate, 1.0f, 60.0f)) {
+            series->SetRate(rate);
+        }
+        bool loop = series->GetLoop();
+        if (ImGui::Checkbox("Loop", &loop)) {
+            series->SetLoop(loop);
+        }
+        ImGui::SameLine();
+        bool dropFrames = series->GetDropFrames();
+        if (ImGui::Checkbox("Drop Frames", &dropFrames)) {
+            series->SetDropFrames(dropFrames);
+        }
+        int step = series->GetTargetStep();
+        if (ImGui::SliderInt("Step", &step, 0, series->GetStepCount() - 1)) {
+            series->Seek(step);
+        }
+        ImGui::Text("Showing %d, buffered %d / %d, dropped %d", series->GetCurrentStep(),
+                    series->GetBufferedSteps(), series->GetRingSlotCount(), series->GetDroppedSteps());
+    }
+    
+    ImGui::Separator();
+    ImGui::Text("Procedural Volume");
+    static ProceduralParams procedural;
+    static int proceduralSize = 128;
+    static int proceduralSeed = 1;
+    static const char* shapeNames[] = { "Clouds", "Spheres", "Turbulence" };
+    int shapeIndex = (int)procedural.shape;
+    if (ImGui::Combo("Shape", &shapeIndex, shapeNames, IM_ARRAYSIZE(shapeNames))) {
+        procedural.shape = (ProceduralShape)shapeIndex;
+    }
+    ImGui::InputInt("Size", &proceduralSize);
+    ImGui::InputInt("Seed", &proceduralSeed);
+    ImGui::SliderFloat("Frequency", &procedural.frequency, 1.0f, 16.0f);
+    ImGui::SliderInt("Octaves", &procedural.octaves, 1, 8);
+    if (ImGui::Button("Generate")) {
+        procedural.seed = (uint32_t)proceduralSeed;
+        g_renderer->GenerateTestVolume(std::max(proceduralSize, 8), procedural);
+    }
+    
+    ImGui::Separator();
+    ImGui::Text("Channels (%d / %d)", g_renderer->GetChannelCount(), VolumeChannels::MAX_CHANNELS);
+    static glm::vec3 channelColors[VolumeChannels::MAX_CHANNELS] = {
+        glm::vec3(1.0f, 0.3f, 0.2f), glm::vec3(0.2f, 1.0f, 0.3f), glm::vec3(0.3f, 0.5f, 1.0f)
+    };
+    if (g_renderer->GetChannelCount() < VolumeChannels::MAX_CHANNELS) {
+        // 新通道使用上方的文件路径或程序化参数
+        int next = g_renderer->GetChannelCount();
+        if (ImGui::Button("Add Channel (Header)")) {
+            g_renderer->AddChannel(volumePath, ChannelTransferFunction(channelColors[next]));
+        }
+        ImGui::SameLine();
+        if (ImGui::Button("Add Procedural Channel")) {
+            procedural.seed = (uint32_t)proceduralSeed + next + 1;
+            g_renderer->AddProceduralChannel(std::max(proceduralSize, 8), procedural,
+                                             ChannelTransferFunction(channelColors[next]));
+        }
+    }
+    for (int i = 0; i < g_renderer->GetChannelCount(); i++) {
+        ImGui::PushID(i);
+        ChannelParams channel = g_renderer->GetChannelParams(i);
+        bool changed = false;
+        ImGui::Text("Channel %d", i);
+        changed |= ImGui::Checkbox("Enabled", &channel.enabled);
+        changed |= ImGui::SliderFloat3("Translation", &channel.translation.x, -1.0f, 1.0f);
+        changed |= ImGui::SliderFloat3("Rotation", &channel.rotation.x, -180.0f, 180.0f);
+        changed |= ImGui::SliderFloat("Scale", &channel.scale, 0.1f, 2.0f);
+        changed |= ImGui::SliderFloat("Channel Density", &channel.density, 0.1f, 5.0f);
+        changed |= ImGui::SliderFloat("Channel Threshold", &channel.threshold, 0.0f, 1.0f);
+        if (changed) {
+            g_renderer->SetChannelParams(i, channel);
+        }
+        if (ImGui::ColorEdit3("Color", &channelColors[i].x)) {
+            g_renderer->SetChannelTransferFunction(i, ChannelTransferFunction(channelColors[i]));
+        }
+        if (ImGui::Button("Remove")) {
+            g_renderer->RemoveChannel(i);
+            // 颜色随之后的通道前移
+            std::rotate(channelColors + i, channelColors + i + 1, channelColors + VolumeChannels::MAX_CHANNELS);
+        }
+        ImGui::PopID();
+    }
+    
+    ImGui::Separator();
+    ImGui::Text("Offline Sequence");
+    static char outputPattern[256] = "frame_%05d.png";
+    ImGui::InputText("Output Pattern", outputPattern, sizeof(outputPattern));
+    ImGui::InputInt2("Resolution", &g_sequenceSettings.width);
+    ImGui::SliderInt("Samples per Frame", &g_sequenceSettings.samplesPerFrame, 1, 64);
+    ImGui::Checkbox("Use Recorded Path (camera_path.txt)", &g_sequenceUseRecordedPath);
+    if (!g_sequenceUseRecordedPath) {
+        ImGui::InputInt("Orbit Frames", &g_sequenceOrbitFrames);
+    }
+    if (ImGui::Button("Render Sequence")) {
+        g_sequenceSettings.outputPattern = outputPattern;
+        g_sequenceRequested = true;
+    }
     
     ImGui::Separator();
     ImGui::Text("Camera Controls");
@@ -167,7 +394,9 @@ void RenderImGui(RenderParams& params) {
     ImGui::End();
     
     ImGui::Render();
+    g_renderer->BeginOverlayTiming();
     ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+    g_renderer->EndOverlayTiming();
 }
 
 int main() {
@@ -210,6 +439,7 @@ int main() {
     
     // 主循环
     float lastFrameTime = 0.0f;
+    int framesAfterEvent = FRAMES_AFTER_EVENT;
     while (!glfwWindowShouldClose(g_window)) {
         // 计算deltaTime
         float currentTime = (float)glfwGetTime();
@@ -218,6 +448,9 @@ int main() {
         
         // 处理输入
         processInput(g_window, deltaTime);
+        if (g_recordingPath) {
+            g_cameraPath.AddKeyframe(g_renderer->GetCameraController().GetCamera());
+        }
         
         // 更新渲染参数
         g_renderer->SetRenderParams(params);
@@ -228,9 +461,44 @@ int main() {
         // 渲染UI
         RenderImGui(params);
         
-        // 交换缓冲区和轮询事件
+        // 交换缓冲区
         glfwSwapBuffers(g_window);
-        glfwPollEvents();
+        
+        // 离线渲染序列（阻塞到全部帧写出）
+        if (g_sequenceRequested) {
+            g_sequenceRequested = false;
+            CameraPath path = CameraPath::CreateOrbit(std::max(g_sequenceOrbitFrames, 1));
+            if (!g_sequenceUseRecordedPath || path.Load("camera_path.txt")) {
+                SequenceRenderer sequence(*g_renderer);
+                sequence.Render(path, params, g_sequenceSettings, [](int done, int total) {
+                    if (done % 10 == 0 || done == total) {
+                        std::cout << "Sequence: " << done << "/" << total << std::endl;
+                    }
+                });
+            }
+            lastFrameTime = (float)glfwGetTime();
+            framesAfterEvent = FRAMES_AFTER_EVENT;
+        }
+        
+        // 画面静止时阻塞等待输入事件，不再空转GPU；否则按帧率上限限速
+        if (g_renderer->IsIdle() && framesAfterEvent == 0) {
+            glfwWaitEvents();
+            framesAfterEvent = FRAMES_AFTER_EVENT;
+            // 等待时间不计入摄像机移动
+            lastFrameTime = (float)glfwGetTime();
+        } else {
+            framesAfterEvent = std::max(framesAfterEvent - 1, 0);
+            if (g_frameRateCap > 0) {
+                // 等待期间的事件照常处理，直到本帧时间用完
+                double frameEnd = currentTime + 1.0 / g_frameRateCap;
+                double remaining = frameEnd - glfwGetTime();
+                while (remaining > 0.0) {
+                    glfwWaitEventsTimeout(remaining);
+                    remaining = frameEnd - glfwGetTime();
+                }
+            }
+            glfwPollEvents();
+        }
     }
     
     // 清理